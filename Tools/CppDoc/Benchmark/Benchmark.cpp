@@ -0,0 +1,362 @@
+#include "Benchmark.h"
+
+/***********************************************************************
+Helpers
+***********************************************************************/
+
+const wchar_t* GetPhaseName(BenchmarkPhase phase)
+{
+	switch (phase)
+	{
+#define CPPDOC_PHASE(NAME, TEXT) case BenchmarkPhase::NAME: return TEXT;
+		CPPDOC_BENCHMARK_PHASES(CPPDOC_PHASE)
+#undef CPPDOC_PHASE
+	default:
+		return L"";
+	}
+}
+
+// Collect all symbols except the root, a parent is collected before its children
+static void CollectSymbols(Symbol* symbol, List<Symbol*>& symbols)
+{
+	for (vint i = 0; i < symbol->children.Count(); i++)
+	{
+		auto& children = symbol->children.GetByIndex(i);
+		for (vint j = 0; j < children.Count(); j++)
+		{
+			symbols.Add(children[j].Obj());
+			CollectSymbols(children[j].Obj(), symbols);
+		}
+	}
+}
+
+template<typename TCallback>
+static void Measure(PhaseResult& result, TCallback&& callback)
+{
+	auto start = GetMicroseconds();
+	callback();
+	auto elapsed = GetMicroseconds() - start;
+	if (result.minMicroseconds == -1 || result.minMicroseconds > elapsed)
+	{
+		result.minMicroseconds = elapsed;
+	}
+	result.totalMicroseconds += elapsed;
+}
+
+// Returns false if the type or expression cannot be evaluated
+template<typename TCallback>
+static bool TryEvaluate(TCallback&& callback)
+{
+	try
+	{
+		callback();
+		return true;
+	}
+	catch (const NotConvertableException&)
+	{
+	}
+	catch (const IllegalExprException&)
+	{
+	}
+	return false;
+}
+
+/***********************************************************************
+Phases
+***********************************************************************/
+
+static void RunPhases(Ptr<RegexLexer> lexer, const WString& input, vint partitions, InputResult& result)
+{
+	auto& lexResult = result.phases[(vint)BenchmarkPhase::Lex];
+	auto& parseResult = result.phases[(vint)BenchmarkPhase::Parse];
+	auto& resolveResult = result.phases[(vint)BenchmarkPhase::Resolve];
+	auto& typeResult = result.phases[(vint)BenchmarkPhase::Type];
+	auto& exprResult = result.phases[(vint)BenchmarkPhase::Expr];
+	auto& convertResult = result.phases[(vint)BenchmarkPhase::Convert];
+	ResetStatistics();
+	ResetAllocations();
+
+	// tokens are kept by the first cursor, so that parse does not lex again
+	CppTokenReader reader(lexer, input);
+	Ptr<CppTokenCursor> firstToken;
+	Measure(lexResult, [&]()
+	{
+		firstToken = reader.GetFirstToken();
+		lexResult.items = 0;
+		for (auto cursor = firstToken; cursor; cursor = cursor->Next())
+		{
+			lexResult.items++;
+		}
+	});
+
+	// the parser keeps symbols and types of partitions, it is deleted after pa
+	auto parser = MakePtr<ParallelParser>(partitions);
+	ParsingArguments pa(new Symbol, ITsysAlloc::Create(), nullptr);
+	Ptr<CppTokenCursor> errorPosition;
+	result.error = L"";
+	Measure(parseResult, [&]()
+	{
+		auto cursor = firstToken;
+		try
+		{
+			if (partitions > 1)
+			{
+				parser->Parse(pa, cursor);
+			}
+			else
+			{
+				ParseProgram(pa, cursor);
+			}
+		}
+		catch (const StopParsingException& e)
+		{
+			errorPosition = e.position;
+			result.error = e.position
+				? L"Syntax error at " + itow(e.position->token.rowStart + 1) + L":" + itow(e.position->token.columnStart + 1)
+				: WString(L"Syntax error at the end of the input");
+		}
+	});
+
+	result.parsedPartitions = parser->parsedPartitions;
+	result.mergedPartitions = parser->mergedPartitions;
+	result.parsedCharacters = errorPosition ? errorPosition->token.start : input.Length();
+	parseResult.items = 0;
+	for (auto cursor = firstToken; cursor && cursor != errorPosition; cursor = cursor->Next())
+	{
+		parseResult.items++;
+	}
+
+	List<Symbol*> symbols;
+	CollectSymbols(pa.root.Obj(), symbols);
+
+	Measure(resolveResult, [&]()
+	{
+		resolveResult.items = 0;
+		resolveResult.failures = 0;
+		for (vint i = 0; i < symbols.Count(); i++)
+		{
+			auto symbol = symbols[i];
+			if (symbol->decls.Count() == 0) continue;
+
+			auto name = symbol->decls[0]->name;
+			if (!name) continue;
+
+			ParsingArguments spa(pa, symbol->parent);
+			resolveResult.items++;
+			if (!TryEvaluate([&]() { ResolveSymbol(spa, name, SearchPolicy::SymbolAccessableInScope); }))
+			{
+				resolveResult.failures++;
+			}
+		}
+	});
+
+	bool typeCache = TypeToTsysCacheEnabled;
+	bool exprCache = ExprToTsysCacheEnabled;
+	TypeToTsysCacheEnabled = false;
+	ExprToTsysCacheEnabled = false;
+
+	List<ITsys*> variableTypes;
+	Measure(typeResult, [&]()
+	{
+		typeResult.items = 0;
+		typeResult.failures = 0;
+		variableTypes.Clear();
+		for (vint i = 0; i < symbols.Count(); i++)
+		{
+			auto symbol = symbols[i];
+			for (vint j = 0; j < symbol->decls.Count(); j++)
+			{
+				auto decl = symbol->decls[j];
+				Ptr<Type> type;
+				auto varDecl = decl.Cast<ForwardVariableDeclaration>();
+				if (varDecl)
+				{
+					type = varDecl->type;
+				}
+				else if (auto funcDecl = decl.Cast<ForwardFunctionDeclaration>())
+				{
+					type = funcDecl->type;
+				}
+				else if (auto aliasDecl = decl.Cast<TypeAliasDeclaration>())
+				{
+					type = aliasDecl->type;
+				}
+				if (!type) continue;
+
+				ParsingArguments spa(pa, symbol->parent);
+				TypeTsysList tsys;
+				typeResult.items++;
+				if (!TryEvaluate([&]() { TypeToTsys(spa, type, tsys); }))
+				{
+					typeResult.failures++;
+				}
+				if (varDecl)
+				{
+					CopyFrom(variableTypes, tsys, true);
+				}
+			}
+		}
+	});
+
+	List<ExprTsysItem> sources;
+	Measure(exprResult, [&]()
+	{
+		exprResult.items = 0;
+		exprResult.failures = 0;
+		sources.Clear();
+		for (vint i = 0; i < symbols.Count(); i++)
+		{
+			auto symbol = symbols[i];
+			for (vint j = 0; j < symbol->decls.Count(); j++)
+			{
+				auto decl = symbol->decls[j];
+				List<Ptr<Expr>> exprs;
+				if (auto varDecl = decl.Cast<VariableDeclaration>())
+				{
+					if (varDecl->initializer)
+					{
+						CopyFrom(exprs, varDecl->initializer->arguments);
+					}
+				}
+				else if (auto enumItemDecl = decl.Cast<EnumItemDeclaration>())
+				{
+					if (enumItemDecl->value)
+					{
+						exprs.Add(enumItemDecl->value);
+					}
+				}
+
+				ParsingArguments spa(pa, symbol->parent);
+				for (vint k = 0; k < exprs.Count(); k++)
+				{
+					ExprTsysList tsys;
+					exprResult.items++;
+					if (!TryEvaluate([&]() { ExprToTsys(spa, exprs[k], tsys); }))
+					{
+						exprResult.failures++;
+					}
+					CopyFrom(sources, tsys, true);
+				}
+			}
+		}
+	});
+
+	// every source is converted to the next few variable types, so that the number of conversions grows linearly
+	const vint ConvertTargetCount = 8;
+	for (vint i = 0; i < variableTypes.Count(); i++)
+	{
+		sources.Add({ nullptr, ExprTsysType::LValue, variableTypes[i] });
+	}
+	Measure(convertResult, [&]()
+	{
+		convertResult.items = 0;
+		convertResult.failures = 0;
+		if (variableTypes.Count() == 0) return;
+
+		vint targetCount = variableTypes.Count() < ConvertTargetCount ? variableTypes.Count() : ConvertTargetCount;
+		for (vint i = 0; i < sources.Count(); i++)
+		{
+			for (vint j = 0; j < targetCount; j++)
+			{
+				auto target = variableTypes[(i + j) % variableTypes.Count()];
+				convertResult.items++;
+				if (!TryEvaluate([&]() { TestConvert(pa, target, sources[i]); }))
+				{
+					convertResult.failures++;
+				}
+			}
+		}
+	});
+
+	TypeToTsysCacheEnabled = typeCache;
+	ExprToTsysCacheEnabled = exprCache;
+}
+
+/***********************************************************************
+RunBenchmark
+***********************************************************************/
+
+void RunBenchmark(Ptr<RegexLexer> lexer, const WString& path, const WString& input, vint repeat, bool statistics, bool allocations, vint partitions, InputResult& result)
+{
+	result.path = path;
+	result.characters = input.Length();
+	for (vint i = 0; i < repeat; i++)
+	{
+		RunPhases(lexer, input, partitions, result);
+	}
+	if (statistics)
+	{
+		result.statistics = GetStatisticsJson(L"\t\t\t");
+	}
+	if (allocations)
+	{
+		result.allocations = GetAllocationsJson(L"\t\t\t");
+	}
+	result.peakMemory = GetPeakMemoryUsage();
+}
+
+/***********************************************************************
+WriteBenchmarkJson
+***********************************************************************/
+
+// The number of items per second, measured by the fastest repeat
+static vint64_t GetThroughput(vint64_t items, vint64_t microseconds)
+{
+	return microseconds <= 0 ? 0 : items * 1000000 / microseconds;
+}
+
+void WriteBenchmarkJson(vint repeat, List<Ptr<InputResult>>& results, TextWriter& writer)
+{
+	writer.WriteLine(L"{");
+	writer.WriteLine(L"\t\"repeat\": " + itow(repeat) + L",");
+	writer.WriteLine(L"\t\"peakMemory\": " + i64tow(GetPeakMemoryUsage()) + L",");
+	writer.WriteLine(L"\t\"inputs\": [");
+	for (vint i = 0; i < results.Count(); i++)
+	{
+		auto result = results[i];
+		writer.WriteLine(L"\t\t{");
+		writer.WriteLine(L"\t\t\t\"path\": " + ToJsonString(result->path) + L",");
+		writer.WriteLine(L"\t\t\t\"shape\": " + (result->shape == L"" ? WString(L"null") : ToJsonString(result->shape)) + L",");
+		writer.WriteLine(L"\t\t\t\"size\": " + itow(result->size) + L",");
+		writer.WriteLine(L"\t\t\t\"characters\": " + itow(result->characters) + L",");
+		writer.WriteLine(L"\t\t\t\"parsedCharacters\": " + itow(result->parsedCharacters) + L",");
+		writer.WriteLine(L"\t\t\t\"error\": " + (result->error == L"" ? WString(L"null") : ToJsonString(result->error)) + L",");
+		writer.WriteLine(L"\t\t\t\"parsedPartitions\": " + itow(result->parsedPartitions) + L",");
+		writer.WriteLine(L"\t\t\t\"mergedPartitions\": " + itow(result->mergedPartitions) + L",");
+		writer.WriteLine(L"\t\t\t\"peakMemory\": " + i64tow(result->peakMemory) + L",");
+		if (result->statistics != L"")
+		{
+			writer.WriteLine(L"\t\t\t\"statistics\": " + result->statistics + L",");
+		}
+		if (result->allocations != L"")
+		{
+			writer.WriteLine(L"\t\t\t\"allocations\": " + result->allocations + L",");
+		}
+		writer.WriteLine(L"\t\t\t\"phases\": {");
+		for (vint j = 0; j < (vint)BenchmarkPhase::Count; j++)
+		{
+			auto phase = (BenchmarkPhase)j;
+			auto& phaseResult = result->phases[j];
+			WString line = L"\t\t\t\t" + ToJsonString(GetPhaseName(phase)) + L": {";
+			line += L" \"items\": " + itow(phaseResult.items);
+			line += L", \"failures\": " + itow(phaseResult.failures);
+			line += L", \"minMicroseconds\": " + i64tow(phaseResult.minMicroseconds);
+			line += L", \"averageMicroseconds\": " + i64tow(phaseResult.totalMicroseconds / repeat);
+			line += L", \"itemsPerSecond\": " + i64tow(GetThroughput(phaseResult.items, phaseResult.minMicroseconds));
+			if (phase == BenchmarkPhase::Lex)
+			{
+				line += L", \"charactersPerSecond\": " + i64tow(GetThroughput(result->characters, phaseResult.minMicroseconds));
+			}
+			else if (phase == BenchmarkPhase::Parse)
+			{
+				line += L", \"charactersPerSecond\": " + i64tow(GetThroughput(result->parsedCharacters, phaseResult.minMicroseconds));
+			}
+			line += j == (vint)BenchmarkPhase::Count - 1 ? L" }" : L" },";
+			writer.WriteLine(line);
+		}
+		writer.WriteLine(L"\t\t\t}");
+		writer.WriteLine(i == results.Count() - 1 ? L"\t\t}" : L"\t\t},");
+	}
+	writer.WriteLine(L"\t]");
+	writer.WriteLine(L"}");
+}
\ No newline at end of file
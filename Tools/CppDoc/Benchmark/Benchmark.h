@@ -0,0 +1,66 @@
+#ifndef VCZH_DOCUMENT_CPPDOC_BENCHMARK_BENCHMARK
+#define VCZH_DOCUMENT_CPPDOC_BENCHMARK_BENCHMARK
+
+#include <IncludeAll.h>
+
+using namespace vl::stream;
+
+/***********************************************************************
+Phases
+	lex			read all tokens
+	parse		ParseProgram on tokens from lex, names are resolved and types are evaluated when necessary
+				ParallelParser is used instead when partitions is greater than 1
+	resolve		ResolveSymbol on the name of every declaration, from the scope containing it
+	type		TypeToTsys on types of every variable, function and type alias
+	expr		ExprToTsys on initializers of every variable and enum item
+	convert		TestConvert from every expression and variable to the next variable types
+	Caches of TypeToTsys and ExprToTsys are disabled in type, expr and convert, so that each repeat evaluates everything again
+	If parse fails, later phases run on symbols created before the syntax error
+	Statistics and allocations are reset before each repeat, so collected counters are from the last repeat
+***********************************************************************/
+
+#define CPPDOC_BENCHMARK_PHASES(F)\
+	F(Lex, L"lex")\
+	F(Parse, L"parse")\
+	F(Resolve, L"resolve")\
+	F(Type, L"type")\
+	F(Expr, L"expr")\
+	F(Convert, L"convert")\
+
+enum class BenchmarkPhase
+{
+#define CPPDOC_PHASE(NAME, TEXT) NAME,
+	CPPDOC_BENCHMARK_PHASES(CPPDOC_PHASE)
+#undef CPPDOC_PHASE
+	Count,
+};
+
+struct PhaseResult
+{
+	vint							items = 0;				// tokens, lookups, types, expressions or conversions processed in one repeat
+	vint							failures = 0;			// items that throw NotConvertableException or IllegalExprException
+	vint64_t						minMicroseconds = -1;
+	vint64_t						totalMicroseconds = 0;
+};
+
+struct InputResult
+{
+	WString							path;
+	WString							shape;					// the generator shape, empty if the input is a file
+	vint							size = 0;				// the generator size
+	vint							characters = 0;
+	vint							parsedCharacters = 0;	// characters before the syntax error
+	WString							error;					// the syntax error, empty if the input is parsed
+	vint							parsedPartitions = 0;	// partitions parsed concurrently by ParallelParser in the last repeat
+	vint							mergedPartitions = 0;	// partitions merged without being parsed again in the last repeat
+	PhaseResult						phases[(vint)BenchmarkPhase::Count];
+	WString							statistics;				// counters of the last repeat in JSON, empty if not collected
+	WString							allocations;			// allocations of the last repeat in JSON, empty if not collected
+	vint64_t						peakMemory = 0;			// peak resident memory of the process after this input
+};
+
+extern const wchar_t*				GetPhaseName(BenchmarkPhase phase);
+extern void							RunBenchmark(Ptr<RegexLexer> lexer, const WString& path, const WString& input, vint repeat, bool statistics, bool allocations, vint partitions, InputResult& result);
+extern void							WriteBenchmarkJson(vint repeat, List<Ptr<InputResult>>& results, TextWriter& writer);
+
+#endif
\ No newline at end of file
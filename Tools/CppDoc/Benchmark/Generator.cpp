@@ -0,0 +1,119 @@
+#include "Generator.h"
+
+/***********************************************************************
+Shapes
+***********************************************************************/
+
+static void GenerateMembers(vint size, StreamWriter& writer)
+{
+	writer.WriteLine(L"namespace members");
+	writer.WriteLine(L"{");
+	for (vint i = 0; i < size; i++)
+	{
+		writer.WriteLine(L"\tint v" + itow(i) + L" = " + itow(i) + L";");
+		writer.WriteLine(L"\tint f" + itow(i) + L"(int);");
+	}
+	writer.WriteLine(L"}");
+	writer.WriteLine(L"int use = members::v" + itow(size - 1) + L" + members::f" + itow(size - 1) + L"(0);");
+}
+
+static void GenerateHierarchy(vint size, StreamWriter& writer)
+{
+	writer.WriteLine(L"struct C0 { int m0; };");
+	for (vint i = 1; i < size; i++)
+	{
+		writer.WriteLine(L"struct C" + itow(i) + L" : C" + itow(i - 1) + L" { int m" + itow(i) + L"; };");
+	}
+	writer.WriteLine(L"C" + itow(size - 1) + L" c;");
+	writer.WriteLine(L"int use = c.m0;");
+}
+
+static void GenerateOverloads(vint size, StreamWriter& writer)
+{
+	for (vint i = 0; i < size; i++)
+	{
+		writer.WriteLine(L"struct S" + itow(i) + L" {};");
+	}
+	for (vint i = 0; i < size; i++)
+	{
+		writer.WriteLine(L"int f(S" + itow(i) + L");");
+	}
+	for (vint i = 0; i < size; i++)
+	{
+		writer.WriteLine(L"S" + itow(i) + L" s" + itow(i) + L";");
+		writer.WriteLine(L"int r" + itow(i) + L" = f(s" + itow(i) + L");");
+	}
+}
+
+static void GenerateParentheses(vint size, StreamWriter& writer)
+{
+	writer.WriteLine(L"int a(int);");
+	writer.WriteLine(L"int b;");
+	writer.WriteString(L"int use = ");
+	for (vint i = 0; i < size; i++)
+	{
+		writer.WriteString(L"(a)(");
+	}
+	writer.WriteString(L"b");
+	for (vint i = 0; i < size; i++)
+	{
+		writer.WriteChar(L')');
+	}
+	writer.WriteLine(L";");
+}
+
+static void GenerateBlock(vint size, StreamWriter& writer)
+{
+	writer.WriteLine(L"int block()");
+	writer.WriteLine(L"{");
+	writer.WriteLine(L"\tint v0 = 0;");
+	for (vint i = 1; i < size; i++)
+	{
+		writer.WriteLine(L"\tint v" + itow(i) + L" = v" + itow(i - 1) + L" + 1;");
+	}
+	writer.WriteLine(L"\treturn v" + itow(size - 1) + L";");
+	writer.WriteLine(L"}");
+}
+
+static const GeneratorShape generatorShapes[] =
+{
+	{ L"members",		&GenerateMembers },
+	{ L"hierarchy",		&GenerateHierarchy },
+	{ L"overloads",		&GenerateOverloads },
+	{ L"parentheses",	&GenerateParentheses },
+	{ L"block",			&GenerateBlock },
+};
+
+/***********************************************************************
+Generator
+***********************************************************************/
+
+vint GetGeneratorShapeCount()
+{
+	return sizeof(generatorShapes) / sizeof(*generatorShapes);
+}
+
+const GeneratorShape& GetGeneratorShape(vint index)
+{
+	return generatorShapes[index];
+}
+
+const GeneratorShape* FindGeneratorShape(const WString& name)
+{
+	for (vint i = 0; i < GetGeneratorShapeCount(); i++)
+	{
+		if (name == generatorShapes[i].name)
+		{
+			return &generatorShapes[i];
+		}
+	}
+	return nullptr;
+}
+
+WString GenerateInput(const GeneratorShape& shape, vint size)
+{
+	return GenerateToStream([&](StreamWriter& writer)
+	{
+		shape.generate(size, writer);
+	});
+}
\ No newline at end of file
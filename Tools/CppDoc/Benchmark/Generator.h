@@ -0,0 +1,29 @@
+#ifndef VCZH_DOCUMENT_CPPDOC_BENCHMARK_GENERATOR
+#define VCZH_DOCUMENT_CPPDOC_BENCHMARK_GENERATOR
+
+#include <Utility.h>
+
+using namespace vl::stream;
+
+/***********************************************************************
+Generator
+	Synthetic inputs that grow in one dimension, size is the number of repeated units
+	members		a namespace with size variables and functions
+	hierarchy	a chain of size classes, the last one accesses a member of the first one
+	overloads	a function with size overloads, called with every parameter type
+	parentheses	an expression of size nested (a)(b), every level could be a cast or a call
+	block		a function with size statements in one block, each one uses the previous variable
+***********************************************************************/
+
+struct GeneratorShape
+{
+	const wchar_t*					name;
+	void							(*generate)(vint size, StreamWriter& writer);
+};
+
+extern vint							GetGeneratorShapeCount();
+extern const GeneratorShape&		GetGeneratorShape(vint index);
+extern const GeneratorShape*		FindGeneratorShape(const WString& name);	// nullptr if the shape does not exist
+extern WString						GenerateInput(const GeneratorShape& shape, vint size);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,300 @@
+#include "Benchmark.h"
+#include "Generator.h"
+
+using namespace vl::console;
+
+/***********************************************************************
+Commands
+	Benchmark	[--stats] [--allocations] [-r <repeat>] [-p <partitions>] [-o <json-file>] [-t <trace-file>] [-g <shape> <size>[,<size>...]] ... [<input> ...]
+				input is a preprocessed file, or @<list-file> with one preprocessed file in each line
+				-g adds a generated input for each size, shapes are listed in Generator.h
+				--stats adds counters of parser internals to each input, Core must be built with CPPDOC_STATISTICS
+				--allocations adds counts, bytes and peak bytes of allocations by AST class, Core must be built with CPPDOC_ALLOCATIONS
+				-p parses each input with ParallelParser in the number of partitions, ParseProgram is used if it is 1
+				ParallelParser parses dependent partitions again, so it is expected to be slower than ParseProgram on most inputs
+				-t writes a Chrome trace of all repeats of all inputs, Core must be built with CPPDOC_TRACE
+				results are printed in JSON if json-file is not specified
+	Benchmark	generate <shape> <size> <output-file>
+				write a generated input to a file
+***********************************************************************/
+
+void PrintUsage()
+{
+	Console::WriteLine(L"Benchmark [--stats] [--allocations] [-r <repeat>] [-p <partitions>] [-o <json-file>] [-t <trace-file>] [-g <shape> <size>[,<size>...]] ... [<preprocessed-file | @list-file> ...]");
+	Console::WriteLine(L"Benchmark generate <shape> <size> <output-file>");
+
+	WString shapes;
+	for (vint i = 0; i < GetGeneratorShapeCount(); i++)
+	{
+		shapes += (i == 0 ? L"shapes: " : L", ") + WString(GetGeneratorShape(i).name);
+	}
+	Console::WriteLine(shapes);
+}
+
+struct GeneratedInput
+{
+	const GeneratorShape*			shape = nullptr;
+	vint							size = 0;
+};
+
+// Collect comma separated sizes of a shape
+bool CollectGeneratedInputs(const WString& shapeName, const WString& sizes, List<GeneratedInput>& inputs)
+{
+	auto shape = FindGeneratorShape(shapeName);
+	if (!shape)
+	{
+		Console::WriteLine(L"Unknown shape " + shapeName);
+		return false;
+	}
+
+	vint start = 0;
+	while (start <= sizes.Length())
+	{
+		vint end = start;
+		while (end < sizes.Length() && sizes[end] != L',') end++;
+
+		GeneratedInput input;
+		input.shape = shape;
+		input.size = wtoi(sizes.Sub(start, end - start));
+		if (input.size < 1)
+		{
+			Console::WriteLine(L"Invalid size in " + sizes);
+			return false;
+		}
+		inputs.Add(input);
+		start = end + 1;
+	}
+	return true;
+}
+
+int GenerateFile(const WString& shapeName, const WString& size, const WString& outputPath)
+{
+	List<GeneratedInput> inputs;
+	if (!CollectGeneratedInputs(shapeName, size, inputs) || inputs.Count() != 1)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	if (!File(outputPath).WriteAllText(GenerateInput(*inputs[0].shape, inputs[0].size), false, BomEncoder::Utf8))
+	{
+		Console::WriteLine(L"Failed to write " + outputPath);
+		return 1;
+	}
+	return 0;
+}
+
+bool CollectInputs(const WString& input, List<WString>& paths)
+{
+	if (input.Length() > 0 && input[0] == L'@')
+	{
+		auto listPath = input.Sub(1, input.Length() - 1);
+		List<WString> lines;
+		if (!File(listPath).ReadAllLinesByBom(lines))
+		{
+			Console::WriteLine(L"Failed to read " + listPath);
+			return false;
+		}
+		for (vint i = 0; i < lines.Count(); i++)
+		{
+			if (lines[i].Length() > 0)
+			{
+				paths.Add(lines[i]);
+			}
+		}
+	}
+	else
+	{
+		paths.Add(input);
+	}
+	return true;
+}
+
+int RunCommand(List<WString>& args)
+{
+	if (args.Count() > 0 && args[0] == L"generate")
+	{
+		if (args.Count() != 4)
+		{
+			PrintUsage();
+			return 1;
+		}
+		return GenerateFile(args[1], args[2], args[3]);
+	}
+
+	vint repeat = 3;
+	vint partitions = 1;
+	WString outputPath;
+	WString tracePath;
+	bool statistics = false;
+	bool allocations = false;
+	List<GeneratedInput> generatedInputs;
+	vint reading = 0;
+	while (reading < args.Count())
+	{
+		auto& option = args[reading];
+		if (option == L"--stats")
+		{
+			statistics = true;
+			reading++;
+			continue;
+		}
+		else if (option == L"--allocations")
+		{
+			allocations = true;
+			reading++;
+			continue;
+		}
+		else if (option != L"-g" && option != L"-r" && option != L"-p" && option != L"-o" && option != L"-t")
+		{
+			break;
+		}
+
+		// every other option takes values
+		vint valueCount = option == L"-g" ? 2 : 1;
+		if (reading + valueCount >= args.Count())
+		{
+			PrintUsage();
+			return 1;
+		}
+
+		if (option == L"-g")
+		{
+			if (!CollectGeneratedInputs(args[reading + 1], args[reading + 2], generatedInputs))
+			{
+				PrintUsage();
+				return 1;
+			}
+		}
+		else if (option == L"-r")
+		{
+			repeat = wtoi(args[reading + 1]);
+		}
+		else if (option == L"-p")
+		{
+			partitions = wtoi(args[reading + 1]);
+		}
+		else if (option == L"-o")
+		{
+			outputPath = args[reading + 1];
+		}
+		else if (option == L"-t")
+		{
+			tracePath = args[reading + 1];
+		}
+		reading += valueCount + 1;
+	}
+	if ((reading == args.Count() && generatedInputs.Count() == 0) || repeat < 1 || partitions < 1)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	if (statistics && !IsStatisticsEnabled())
+	{
+		Console::WriteLine(L"Statistics are not collected, define CPPDOC_STATISTICS to build Core and Benchmark");
+		return 1;
+	}
+
+	if (allocations && !IsAllocationAccountingEnabled())
+	{
+		Console::WriteLine(L"Allocations are not accounted, define CPPDOC_ALLOCATIONS to build Core and Benchmark");
+		return 1;
+	}
+
+	if (tracePath != L"" && !IsTraceEnabled())
+	{
+		Console::WriteLine(L"Trace events are not recorded, define CPPDOC_TRACE to build Core and Benchmark");
+		return 1;
+	}
+
+	List<WString> paths;
+	for (; reading < args.Count(); reading++)
+	{
+		if (!CollectInputs(args[reading], paths))
+		{
+			return 1;
+		}
+	}
+
+	auto lexer = CreateCppLexer();
+	List<Ptr<InputResult>> results;
+	if (tracePath != L"")
+	{
+		StartTrace();
+	}
+	for (vint i = 0; i < paths.Count(); i++)
+	{
+		if (!FilePath(paths[i]).IsFile())
+		{
+			Console::WriteLine(L"Failed to read " + paths[i]);
+			return 1;
+		}
+
+		wchar_t* buffer = ReadBigFile(paths[i]);
+		auto result = MakePtr<InputResult>();
+		RunBenchmark(lexer, paths[i], WString(buffer, false), repeat, statistics, allocations, partitions, *result.Obj());
+		delete[] buffer;
+		results.Add(result);
+	}
+
+	for (vint i = 0; i < generatedInputs.Count(); i++)
+	{
+		auto& input = generatedInputs[i];
+		auto result = MakePtr<InputResult>();
+		result->shape = input.shape->name;
+		result->size = input.size;
+		RunBenchmark(lexer, result->shape + L":" + itow(input.size), GenerateInput(*input.shape, input.size), repeat, statistics, allocations, partitions, *result.Obj());
+		results.Add(result);
+	}
+
+	if (tracePath != L"")
+	{
+		StopTrace();
+		auto trace = GenerateToStream([&](StreamWriter& writer)
+		{
+			WriteTraceJson(writer);
+		});
+		if (!File(tracePath).WriteAllText(trace, false, BomEncoder::Utf8))
+		{
+			Console::WriteLine(L"Failed to write " + tracePath);
+			return 1;
+		}
+	}
+
+	auto json = GenerateToStream([&](StreamWriter& writer)
+	{
+		WriteBenchmarkJson(repeat, results, writer);
+	});
+	if (outputPath == L"")
+	{
+		Console::Write(json);
+	}
+	else if (!File(outputPath).WriteAllText(json, false, BomEncoder::Utf8))
+	{
+		Console::WriteLine(L"Failed to write " + outputPath);
+		return 1;
+	}
+	return 0;
+}
+
+#if defined VCZH_MSVC
+int wmain(int argc, wchar_t* argv[])
+#elif defined VCZH_GCC
+int main(int argc, char* argv[])
+#endif
+{
+	List<WString> args;
+	for (vint i = 1; i < argc; i++)
+	{
+#if defined VCZH_MSVC
+		args.Add(argv[i]);
+#elif defined VCZH_GCC
+		args.Add(atow(argv[i]));
+#endif
+	}
+
+	int result = RunCommand(args);
+	FinalizeGlobalStorage();
+	return result;
+}
\ No newline at end of file
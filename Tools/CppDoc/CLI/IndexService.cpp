@@ -0,0 +1,611 @@
+#include "IndexService.h"
+
+/***********************************************************************
+Helpers
+***********************************************************************/
+
+static WString FormatSyntaxError(const StopParsingException& e, const WString& path)
+{
+	if (e.position)
+	{
+		auto& token = e.position->token;
+		return L"Syntax error at " + path + L":" + itow(token.rowStart + 1) + L":" + itow(token.columnStart + 1);
+	}
+	else
+	{
+		return L"Syntax error at the end of " + path;
+	}
+}
+
+// Budget names in -b, Microseconds is specified in milliseconds
+static const wchar_t* GetBudgetName(ParsingBudget budget)
+{
+	switch (budget)
+	{
+	case ParsingBudget::Rewinds:			return L"rewinds";
+	case ParsingBudget::OverloadCandidates:	return L"candidates";
+	case ParsingBudget::Tsys:				return L"tsys";
+	case ParsingBudget::Microseconds:		return L"ms";
+	default:								return L"";
+	}
+}
+
+// Parse comma separated NAME=VALUE
+static bool ParseBudgets(const WString& text, IndexOptions& options)
+{
+	vint start = 0;
+	while (start < text.Length())
+	{
+		vint end = start;
+		while (end < text.Length() && text[end] != L',') end++;
+		auto item = text.Sub(start, end - start);
+		start = end + 1;
+
+		vint eq = 0;
+		while (eq < item.Length() && item[eq] != L'=') eq++;
+		if (eq == item.Length()) return false;
+
+		auto name = item.Sub(0, eq);
+		auto value = wtoi64(item.Sub(eq + 1, item.Length() - eq - 1));
+		if (value < 0) return false;
+
+		bool found = false;
+		for (vint i = 0; i < (vint)ParsingBudget::Count; i++)
+		{
+			auto budget = (ParsingBudget)i;
+			if (name == GetBudgetName(budget))
+			{
+				options.budgets[i] = budget == ParsingBudget::Microseconds ? value * 1000 : value;
+				found = true;
+			}
+		}
+		if (!found) return false;
+	}
+	return true;
+}
+
+static WString FormatDiagnostic(const ParsingDiagnostic& diagnostic, const WString& path)
+{
+	auto location = diagnostic.row == -1 ? path : path + L":" + itow(diagnostic.row + 1) + L":" + itow(diagnostic.column + 1);
+	if (diagnostic.kind == ParsingDiagnosticKind::SyntaxError)
+	{
+		auto error = diagnostic.errorRow == -1 ? WString(L"the end of the file") : itow(diagnostic.errorRow + 1) + L":" + itow(diagnostic.errorColumn + 1);
+		return L"Declaration skipped at " + location + L", syntax error at " + error;
+	}
+	else if (diagnostic.kind == ParsingDiagnosticKind::FunctionTypesTruncated)
+	{
+		return L"Function types truncated at " + location + L", " + i64tow(diagnostic.used) + L" not created";
+	}
+	else
+	{
+		auto used = diagnostic.budget == ParsingBudget::Microseconds ? diagnostic.used / 1000 : diagnostic.used;
+		return L"Declaration skipped at " + location + L", budget exceeded: " + GetBudgetName(diagnostic.budget) + L"=" + i64tow(used);
+	}
+}
+
+struct IndexResult
+{
+	Ptr<MemoryStream>				output;			// the buffer of file if it is not loaded from the cache
+	Ptr<IndexFile>					file;			// nullptr if failed
+	WString							error;
+	List<WString>					diagnostics;	// declarations skipped because of budgets or syntax errors, with function types truncated, or an unexpected exception
+	bool							cached = false;
+};
+
+// Restores the prefix snapshot and releases the content of a translation unit, even if an exception is thrown
+class TranslationUnitGuard
+{
+public:
+	wchar_t*						buffer = nullptr;
+	PrefixSnapshot*					snapshot = nullptr;		// set after the snapshot is forked
+
+	~TranslationUnitGuard()
+	{
+		if (snapshot) snapshot->Restore();
+		delete[] buffer;
+	}
+};
+
+static void IndexTranslationUnitInternal(Ptr<RegexLexer> lexer, Ptr<PrefixSnapshot> snapshot, IndexFileCache* cache, const IndexOptions& options, const WString& path, IndexResult& result)
+{
+	TranslationUnitGuard guard;
+	guard.buffer = ReadBigFile(path);
+	WString key;
+	if (cache)
+	{
+		key = IndexFileCache::GetKey(path, guard.buffer, (vint)wcslen(guard.buffer));
+		if ((result.file = cache->Open(key, path)))
+		{
+			result.cached = true;
+			return;
+		}
+	}
+
+	CppTokenReader reader(lexer, WString(guard.buffer, false));
+	auto cursor = reader.GetFirstToken();
+
+	// every translation unit has its own symbols and types, unless it continues from the prefix
+	ParsingArguments pa;
+	if (snapshot && snapshot->Fork(cursor, pa))
+	{
+		guard.snapshot = snapshot.Obj();
+	}
+	else
+	{
+		pa = ParsingArguments(new Symbol, ITsysAlloc::Create(), nullptr);
+		pa.index = MakePtr<IndexTable>();
+	}
+	if (options.NeedsRecovery())
+	{
+		pa.recovery = MakePtr<ParsingRecovery>();
+		for (vint i = 0; i < (vint)ParsingBudget::Count; i++)
+		{
+			pa.recovery->limits[i] = options.budgets[i];
+		}
+		pa.recovery->skipSyntaxErrors = options.skipSyntaxErrors;
+		pa.recovery->functionTypeExpansionLimit = options.functionTypeExpansionLimit;
+	}
+
+	try
+	{
+		ParseProgram(pa, cursor);
+		result.output = MakePtr<MemoryStream>();
+		WriteIndexFile(*result.output.Obj(), pa.root.Obj(), *pa.index.Obj(), path);
+		result.file = IndexFile::Load(result.output->GetInternalBuffer(), (vint)result.output->Size());
+	}
+	catch (const StopParsingException& e)
+	{
+		result.error = FormatSyntaxError(e, path);
+	}
+
+	if (pa.recovery)
+	{
+		for (vint i = 0; i < pa.recovery->diagnostics.Count(); i++)
+		{
+			result.diagnostics.Add(FormatDiagnostic(pa.recovery->diagnostics[i], path));
+		}
+	}
+
+	// the cache is only an optimization, failing to write it does not fail the translation unit
+	// an index with any diagnostic is not cached, because the key does not include budgets, -e or -k
+	if (cache && result.file && result.diagnostics.Count() == 0)
+	{
+		cache->Save(key, result.output->GetInternalBuffer(), (vint)result.output->Size());
+	}
+}
+
+// Parse one translation unit or load its index from the cache
+// Any other exception fails only this translation unit and is reported as its diagnostic
+static void IndexTranslationUnit(Ptr<RegexLexer> lexer, Ptr<PrefixSnapshot> snapshot, IndexFileCache* cache, const IndexOptions& options, const WString& path, IndexResult& result)
+{
+	WString reason;
+	try
+	{
+		IndexTranslationUnitInternal(lexer, snapshot, cache, options, path, result);
+		return;
+	}
+	catch (const Error& e)
+	{
+		reason = e.Description();
+	}
+	catch (const Exception& e)
+	{
+		reason = e.Message();
+	}
+	catch (const NotConvertableException&)
+	{
+		reason = L"unexpected NotConvertableException";
+	}
+	catch (const IllegalExprException&)
+	{
+		reason = L"unexpected IllegalExprException";
+	}
+	catch (...)
+	{
+		reason = L"unexpected exception";
+	}
+
+	result.file = nullptr;
+	result.output = nullptr;
+	result.cached = false;
+	result.diagnostics.Add(L"Exception thrown when indexing " + path + L": " + (reason == L"" ? WString(L"unexpected error") : reason));
+}
+
+/***********************************************************************
+IndexOptions
+***********************************************************************/
+
+IndexOptions::IndexOptions()
+{
+	for (vint i = 0; i < (vint)ParsingBudget::Count; i++)
+	{
+		budgets[i] = -1;
+	}
+}
+
+bool IndexOptions::HasBudgets()const
+{
+	for (vint i = 0; i < (vint)ParsingBudget::Count; i++)
+	{
+		if (budgets[i] != -1) return true;
+	}
+	return false;
+}
+
+bool IndexOptions::NeedsRecovery()const
+{
+	return skipSyntaxErrors || functionTypeExpansionLimit != -1 || HasBudgets();
+}
+
+/***********************************************************************
+IndexService
+***********************************************************************/
+
+WString IndexService::GetFullPath(const WString& path)
+{
+	bool absolute = (path.Length() > 0 && (path[0] == L'\\' || path[0] == L'/')) || (path.Length() > 1 && path[1] == L':');
+	if (absolute || workingDirectory == L"")
+	{
+		return FilePath(path).GetFullPath();
+	}
+	else
+	{
+		return (FilePath(workingDirectory) / path).GetFullPath();
+	}
+}
+
+bool IndexService::CollectInputs(const WString& input, List<WString>& paths, TextWriter& writer)
+{
+	if (input.Length() > 0 && input[0] == L'@')
+	{
+		auto listPath = GetFullPath(input.Sub(1, input.Length() - 1));
+		List<WString> lines;
+		if (!File(listPath).ReadAllLinesByBom(lines))
+		{
+			writer.WriteLine(L"Failed to read " + listPath);
+			return false;
+		}
+		for (vint i = 0; i < lines.Count(); i++)
+		{
+			if (lines[i].Length() > 0)
+			{
+				paths.Add(GetFullPath(lines[i]));
+			}
+		}
+	}
+	else
+	{
+		paths.Add(GetFullPath(input));
+	}
+	return true;
+}
+
+void IndexService::PrepareWorker(vint worker, const WString& prefixPath, const WString& prefix)
+{
+	auto state = workers[worker];
+	if (!state->lexer)
+	{
+		state->lexer = CreateCppLexer();
+	}
+
+	// snapshots are modified when parsing, so every worker has its own
+	state->snapshotError = L"";
+	if (prefix == L"")
+	{
+		state->snapshot = nullptr;
+	}
+	else if (!state->snapshot || state->snapshot->GetPrefix() != prefix)
+	{
+		state->snapshot = nullptr;
+		try
+		{
+			state->snapshot = new PrefixSnapshot(state->lexer, prefix);
+		}
+		catch (const StopParsingException& e)
+		{
+			state->snapshotError = FormatSyntaxError(e, prefixPath);
+		}
+	}
+}
+
+Ptr<IndexFile> IndexService::OpenIndex(const WString& indexPath, TextWriter& writer)
+{
+	auto fullPath = GetFullPath(indexPath);
+	vint index = indexFiles.Keys().IndexOf(fullPath);
+	if (index != -1)
+	{
+		return indexFiles.Values()[index];
+	}
+
+	auto file = IndexFile::Open(fullPath);
+	if (file)
+	{
+		indexFiles.Add(fullPath, file);
+	}
+	else
+	{
+		writer.WriteLine(L"Failed to open index file: " + indexPath);
+	}
+	return file;
+}
+
+void IndexService::PrintDeclaration(Ptr<IndexFile> file, vint index, TextWriter& writer)
+{
+	auto& decl = file->GetDeclaration(index);
+	auto name = file->GetString(file->GetSymbol(decl.symbol).name);
+	if (decl.start == -1)
+	{
+		writer.WriteLine(WString(file->GetFile(decl.file)) + L":?:? " + name);
+	}
+	else
+	{
+		writer.WriteLine(WString(file->GetFile(decl.file)) + L":" + itow(decl.row + 1) + L":" + itow(decl.column + 1) + L" " + name);
+	}
+}
+
+/***********************************************************************
+IndexService (index)
+***********************************************************************/
+
+int IndexService::BuildIndex(const IndexOptions& options, const WString& outputPath, List<WString>& paths, TextWriter& writer)
+{
+	WString prefix;
+	if (options.prefixPath != L"")
+	{
+		if (!FilePath(options.prefixPath).IsFile())
+		{
+			writer.WriteLine(L"Failed to read " + options.prefixPath);
+			return 1;
+		}
+		wchar_t* buffer = ReadBigFile(options.prefixPath);
+		prefix = buffer;
+		delete[] buffer;
+	}
+
+	Ptr<IndexFileCache> cache;
+	if (options.cachePath != L"")
+	{
+		cache = new IndexFileCache(options.cachePath);
+	}
+
+	WorkStealingScheduler scheduler(options.threads);
+	while (workers.Count() < scheduler.GetWorkerCount())
+	{
+		workers.Add(new Worker);
+	}
+	Array<bool> prepared(scheduler.GetWorkerCount());
+	for (vint i = 0; i < prepared.Count(); i++)
+	{
+		prepared[i] = false;
+	}
+	Array<IndexResult> results(paths.Count());
+
+	// translation units are distributed evenly at the beginning, idle workers steal from busy ones
+	for (vint i = 0; i < paths.Count(); i++)
+	{
+		scheduler.Queue(i, [&, i](vint worker)
+		{
+			if (!prepared[worker])
+			{
+				prepared[worker] = true;
+				PrepareWorker(worker, options.prefixPath, prefix);
+			}
+			IndexTranslationUnit(workers[worker]->lexer, workers[worker]->snapshot, cache.Obj(), options, paths[i], results[i]);
+		});
+	}
+	scheduler.Run();
+
+	int result = 0;
+	for (vint i = 0; i < prepared.Count(); i++)
+	{
+		if (prepared[i] && workers[i]->snapshotError != L"")
+		{
+			writer.WriteLine(workers[i]->snapshotError);
+			result = 1;
+			break;
+		}
+	}
+
+	// merge in the order of inputs, so that the result does not depend on scheduling
+	IndexFileBuilder builder;
+	vint cachedCount = 0;
+	for (vint i = 0; i < paths.Count(); i++)
+	{
+		auto& indexResult = results[i];
+		for (vint j = 0; j < indexResult.diagnostics.Count(); j++)
+		{
+			writer.WriteLine(indexResult.diagnostics[j]);
+		}
+		if (indexResult.file)
+		{
+			builder.AddIndexFile(*indexResult.file.Obj());
+			if (indexResult.cached) cachedCount++;
+		}
+		else
+		{
+			writer.WriteLine(indexResult.error == L"" ? L"Failed to index " + paths[i] : indexResult.error);
+			result = 1;
+		}
+		indexResult.file = nullptr;
+		indexResult.output = nullptr;
+	}
+
+	// an opened index file is mapped into memory, other processes may also map it
+	// so the index is written to a temporary file and then replaces the old one, instead of truncating it
+	auto fullOutputPath = GetFullPath(outputPath);
+	indexFiles.Remove(fullOutputPath);
+
+	FilePath tempPath = fullOutputPath + L"." + itow(GetProcessIdentifier()) + L".tmp";
+	{
+		FileStream stream(tempPath.GetFullPath(), FileStream::WriteOnly);
+		if (!stream.IsAvailable())
+		{
+			writer.WriteLine(L"Failed to write " + outputPath);
+			return 1;
+		}
+		builder.Write(stream);
+	}
+	if (!MoveFileOver(tempPath, fullOutputPath))
+	{
+		File(tempPath).Delete();
+		writer.WriteLine(L"Failed to write " + outputPath);
+		return 1;
+	}
+	writer.WriteLine(itow(paths.Count()) + L" translation units indexed with " + itow(scheduler.GetWorkerCount()) + L" threads, " + itow(cachedCount) + L" from the cache.");
+	return result;
+}
+
+int IndexService::BuildIndex(const List<WString>& args, TextWriter& writer)
+{
+	vint reading = 1;
+	IndexOptions options;
+	while (args.Count() - reading > 2)
+	{
+		auto& option = args[reading];
+		if (option == L"-j")
+		{
+			options.threads = wtoi(args[reading + 1]);
+		}
+		else if (option == L"-p")
+		{
+			options.prefixPath = GetFullPath(args[reading + 1]);
+		}
+		else if (option == L"-c")
+		{
+			options.cachePath = GetFullPath(args[reading + 1]);
+		}
+		else if (option == L"-b")
+		{
+			if (!ParseBudgets(args[reading + 1], options))
+			{
+				PrintUsage(writer);
+				return 1;
+			}
+		}
+		else if (option == L"-e")
+		{
+			options.functionTypeExpansionLimit = wtoi(args[reading + 1]);
+			if (options.functionTypeExpansionLimit < 1)
+			{
+				PrintUsage(writer);
+				return 1;
+			}
+		}
+		else if (option == L"-k")
+		{
+			options.skipSyntaxErrors = true;
+			reading++;
+			continue;
+		}
+		else
+		{
+			break;
+		}
+		reading += 2;
+	}
+	if (args.Count() - reading < 2)
+	{
+		PrintUsage(writer);
+		return 1;
+	}
+
+	auto& outputPath = args[reading++];
+	List<WString> paths;
+	for (; reading < args.Count(); reading++)
+	{
+		if (!CollectInputs(args[reading], paths, writer))
+		{
+			return 1;
+		}
+	}
+	return BuildIndex(options, outputPath, paths, writer);
+}
+
+/***********************************************************************
+IndexService (definition and references)
+***********************************************************************/
+
+int IndexService::FindDefinition(const WString& indexPath, const WString& sourcePath, vint row, vint column, TextWriter& writer)
+{
+	auto file = OpenIndex(indexPath, writer);
+	if (!file) return 1;
+
+	vint source = file->FindFile(GetFullPath(sourcePath));
+	if (source == -1)
+	{
+		writer.WriteLine(L"The file is not indexed: " + sourcePath);
+		return 1;
+	}
+
+	List<vint> declarations;
+	file->FindDefinitions(source, row - 1, column - 1, declarations);
+	for (vint i = 0; i < declarations.Count(); i++)
+	{
+		PrintDeclaration(file, declarations[i], writer);
+	}
+	return 0;
+}
+
+int IndexService::FindReferences(const WString& indexPath, const WString& qualifiedName, TextWriter& writer)
+{
+	auto file = OpenIndex(indexPath, writer);
+	if (!file) return 1;
+
+	List<vint> symbols;
+	file->FindSymbols(qualifiedName, symbols);
+	for (vint i = 0; i < symbols.Count(); i++)
+	{
+		auto& symbol = file->GetSymbol(symbols[i]);
+		for (vint j = 0; j < symbol.declarationCount; j++)
+		{
+			PrintDeclaration(file, symbol.firstDeclaration + j, writer);
+		}
+		for (vint j = 0; j < symbol.referenceCount; j++)
+		{
+			auto& reference = file->GetReference(symbol.firstReference + j);
+			writer.WriteLine(L"    " + WString(file->GetFile(reference.file)) + L":" + itow(reference.row + 1) + L":" + itow(reference.column + 1));
+		}
+	}
+	return 0;
+}
+
+/***********************************************************************
+IndexService (public)
+***********************************************************************/
+
+IndexService::IndexService()
+{
+}
+
+IndexService::~IndexService()
+{
+}
+
+void IndexService::PrintUsage(TextWriter& writer)
+{
+	writer.WriteLine(L"CppDoc index [-j <threads>] [-p <prefix-file>] [-c <cache-folder>] [-b <budgets>] [-e <limit>] [-k] <index-file> <preprocessed-file | @list-file> ...");
+	writer.WriteLine(L"CppDoc definition <index-file> <preprocessed-file> <row> <column>");
+	writer.WriteLine(L"CppDoc references <index-file> <qualified-name>");
+}
+
+int IndexService::Execute(const List<WString>& args, const WString& _workingDirectory, TextWriter& writer)
+{
+	workingDirectory = _workingDirectory;
+	if (args.Count() >= 3 && args[0] == L"index")
+	{
+		return BuildIndex(args, writer);
+	}
+	else if (args.Count() == 5 && args[0] == L"definition")
+	{
+		return FindDefinition(args[1], args[2], wtoi(args[3]), wtoi(args[4]), writer);
+	}
+	else if (args.Count() == 3 && args[0] == L"references")
+	{
+		return FindReferences(args[1], args[2], writer);
+	}
+	else
+	{
+		PrintUsage(writer);
+		return 1;
+	}
+}
\ No newline at end of file
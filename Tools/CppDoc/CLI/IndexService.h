@@ -0,0 +1,78 @@
+#ifndef VCZH_DOCUMENT_CPPDOC_CLI_INDEXSERVICE
+#define VCZH_DOCUMENT_CPPDOC_CLI_INDEXSERVICE
+
+#include <IndexFile.h>
+#include <PrefixSnapshot.h>
+#include <Scheduler.h>
+
+using namespace vl::stream;
+
+/***********************************************************************
+Commands
+	index		[-j <threads>] [-p <prefix-file>] [-c <cache-folder>] [-b <budgets>] [-e <limit>] [-k] <index-file> <input> ...
+				input is a preprocessed file, or @<list-file> with one preprocessed file in each line
+				prefix-file is parsed once by each thread, inputs beginning with its content continue from the parsed prefix
+				cache-folder keeps the index of each whole input, an input is not parsed again only if its content is unchanged
+				budgets limit each declaration at namespace scope, e.g. rewinds=1000,candidates=10000,tsys=100000,ms=500
+				a declaration exceeding any budget is skipped and reported, its translation unit is not cached
+				-e limits function types created for a function type with ambiguous return or parameter types
+				a declaration with function types not created is reported, its translation unit is not cached
+				-k skips a declaration at namespace scope with a syntax error to the next ";" or balanced "}" and reports it
+				otherwise a syntax error fails its translation unit
+	definition	<index-file> <preprocessed-file> <row> <column>
+	references	<index-file> <qualified-name>
+	Rows and columns are 1-based
+***********************************************************************/
+
+struct IndexOptions
+{
+	vint							threads = 0;
+	WString							prefixPath;
+	WString							cachePath;
+	vint64_t						budgets[(vint)ParsingBudget::Count];	// -1 for no limit
+	bool							skipSyntaxErrors = false;
+	vint							functionTypeExpansionLimit = -1;	// -1 for no limit
+
+	IndexOptions();
+	bool							HasBudgets()const;
+	bool							NeedsRecovery()const;
+};
+
+// Runs commands, lexers, prefix snapshots and opened index files are kept for later commands
+class IndexService : public Object
+{
+protected:
+	class Worker : public Object
+	{
+	public:
+		Ptr<RegexLexer>				lexer;
+		Ptr<PrefixSnapshot>			snapshot;
+		WString						snapshotError;
+	};
+
+	List<Ptr<Worker>>				workers;
+	Dictionary<WString, Ptr<IndexFile>>	indexFiles;		// opened index files by full paths
+	WString							workingDirectory;
+
+	WString							GetFullPath(const WString& path);
+	bool							CollectInputs(const WString& input, List<WString>& paths, TextWriter& writer);
+	void							PrepareWorker(vint worker, const WString& prefixPath, const WString& prefix);
+	Ptr<IndexFile>					OpenIndex(const WString& indexPath, TextWriter& writer);
+	void							PrintDeclaration(Ptr<IndexFile> file, vint index, TextWriter& writer);
+
+	int								BuildIndex(const IndexOptions& options, const WString& outputPath, List<WString>& paths, TextWriter& writer);
+	int								BuildIndex(const List<WString>& args, TextWriter& writer);
+	int								FindDefinition(const WString& indexPath, const WString& sourcePath, vint row, vint column, TextWriter& writer);
+	int								FindReferences(const WString& indexPath, const WString& qualifiedName, TextWriter& writer);
+public:
+	IndexService();
+	~IndexService();
+
+	static void						PrintUsage(TextWriter& writer);
+
+	// Run a command without the program name, relative paths are resolved against the working directory
+	// An index file is opened once and kept until it is written by this service again
+	int								Execute(const List<WString>& args, const WString& _workingDirectory, TextWriter& writer);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,254 @@
+#include "IndexService.h"
+#include "Pipe.h"
+
+using namespace vl::console;
+
+/***********************************************************************
+Commands
+	Commands of IndexService run in this process, or in a daemon by
+	daemon		[-n <pipe-name>]
+				serve commands from clients until a client sends "shutdown"
+	client		[-n <pipe-name>] [-r <repeat>] <command> ...
+				run a command in the daemon, repeat it to measure the latency
+	--stats		<command> ...
+				run a command in this process and print counters of parser internals, Core must be built with CPPDOC_STATISTICS
+***********************************************************************/
+
+#define CPPDOC_DEFAULT_PIPE_NAME L"CppDoc"
+
+void PrintUsage()
+{
+	Console::Write(GenerateToStream([](StreamWriter& writer)
+	{
+		IndexService::PrintUsage(writer);
+	}));
+	Console::WriteLine(L"CppDoc daemon [-n <pipe-name>]");
+	Console::WriteLine(L"CppDoc client [-n <pipe-name>] [-r <repeat>] <command> ...");
+	Console::WriteLine(L"CppDoc --stats <command> ...");
+}
+
+// Run a command of IndexService, an unexpected exception fails only this command
+int ExecuteCommand(IndexService& service, const List<WString>& args, const WString& workingDirectory, StreamWriter& writer)
+{
+	try
+	{
+		return service.Execute(args, workingDirectory, writer);
+	}
+	catch (const Error& e)
+	{
+		writer.WriteLine(WString(L"Exception thrown when running the command: ") + e.Description());
+	}
+	catch (const StopParsingException&)
+	{
+		writer.WriteLine(L"Exception thrown when running the command: unexpected syntax error");
+	}
+	catch (...)
+	{
+		writer.WriteLine(L"Exception thrown when running the command: unexpected exception");
+	}
+	return 1;
+}
+
+/***********************************************************************
+daemon
+	Request		: working directory, number of arguments, arguments
+	Response	: exit code, output
+***********************************************************************/
+
+int RunDaemon(const WString& pipeName)
+{
+	IndexService service;
+	Console::WriteLine(L"Listening on " + pipeName);
+	while (true)
+	{
+		auto connection = PipeConnection::Listen(pipeName);
+		if (!connection)
+		{
+			Console::WriteLine(L"Failed to create pipe " + pipeName);
+			return 1;
+		}
+
+		WString workingDirectory;
+		vint count = 0;
+		List<WString> args;
+		if (!connection->ReadString(workingDirectory) || !connection->ReadInt(count)) continue;
+		for (vint i = 0; i < count; i++)
+		{
+			WString arg;
+			if (!connection->ReadString(arg)) break;
+			args.Add(arg);
+		}
+		if (args.Count() != count) continue;
+
+		if (args.Count() == 1 && args[0] == L"shutdown")
+		{
+			connection->WriteInt(0);
+			connection->WriteString(L"");
+			return 0;
+		}
+
+		int result = 1;
+		auto output = GenerateToStream([&](StreamWriter& writer)
+		{
+			result = ExecuteCommand(service, args, workingDirectory, writer);
+		});
+		connection->WriteInt(result);
+		connection->WriteString(output);
+	}
+}
+
+/***********************************************************************
+client
+***********************************************************************/
+
+int RunClient(const WString& pipeName, vint repeat, const List<WString>& args)
+{
+	auto workingDirectory = FilePath(L".").GetFullPath();
+	vint result = 1;
+	WString output;
+
+	List<vint64_t> latencies;
+	for (vint i = 0; i < repeat; i++)
+	{
+		auto start = GetMicroseconds();
+		auto connection = PipeConnection::Connect(pipeName);
+		if (!connection)
+		{
+			Console::WriteLine(L"Failed to connect to " + pipeName);
+			return 1;
+		}
+
+		bool succeeded = connection->WriteString(workingDirectory) && connection->WriteInt(args.Count());
+		for (vint j = 0; succeeded && j < args.Count(); j++)
+		{
+			succeeded = connection->WriteString(args[j]);
+		}
+		if (!succeeded || !connection->ReadInt(result) || !connection->ReadString(output))
+		{
+			Console::WriteLine(L"Failed to communicate with " + pipeName);
+			return 1;
+		}
+		latencies.Add(GetMicroseconds() - start);
+	}
+
+	Console::Write(output);
+	if (repeat > 1)
+	{
+		vint64_t total = 0;
+		vint64_t minLatency = latencies[0];
+		vint64_t maxLatency = latencies[0];
+		for (vint i = 0; i < latencies.Count(); i++)
+		{
+			total += latencies[i];
+			if (minLatency > latencies[i]) minLatency = latencies[i];
+			if (maxLatency < latencies[i]) maxLatency = latencies[i];
+		}
+		Console::WriteLine(
+			itow(repeat) + L" requests, latency in microseconds: first " + i64tow(latencies[0]) +
+			L", min " + i64tow(minLatency) +
+			L", average " + i64tow(total / repeat) +
+			L", max " + i64tow(maxLatency));
+	}
+	return (int)result;
+}
+
+/***********************************************************************
+main
+***********************************************************************/
+
+int RunCommand(List<WString>& arguments)
+{
+	bool statistics = arguments.Count() > 0 && arguments[0] == L"--stats";
+	if (statistics)
+	{
+		if (!IsStatisticsEnabled())
+		{
+			Console::WriteLine(L"Statistics are not collected, define CPPDOC_STATISTICS to build Core and CLI");
+			return 1;
+		}
+		arguments.RemoveAt(0);
+	}
+
+	if (arguments.Count() == 0 || (statistics && (arguments[0] == L"daemon" || arguments[0] == L"client")))
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	if (arguments[0] == L"daemon" || arguments[0] == L"client")
+	{
+		bool daemon = arguments[0] == L"daemon";
+		WString pipeName = CPPDOC_DEFAULT_PIPE_NAME;
+		vint repeat = 1;
+		vint reading = 1;
+		while (reading + 1 < arguments.Count())
+		{
+			if (arguments[reading] == L"-n")
+			{
+				pipeName = arguments[reading + 1];
+			}
+			else if (!daemon && arguments[reading] == L"-r")
+			{
+				repeat = wtoi(arguments[reading + 1]);
+			}
+			else
+			{
+				break;
+			}
+			reading += 2;
+		}
+
+		if (daemon)
+		{
+			if (reading != arguments.Count())
+			{
+				PrintUsage();
+				return 1;
+			}
+			return RunDaemon(pipeName);
+		}
+		else
+		{
+			if (reading == arguments.Count() || repeat < 1)
+			{
+				PrintUsage();
+				return 1;
+			}
+			arguments.RemoveRange(0, reading);
+			return RunClient(pipeName, repeat, arguments);
+		}
+	}
+
+	int result = 1;
+	Console::Write(GenerateToStream([&](StreamWriter& writer)
+	{
+		IndexService service;
+		result = ExecuteCommand(service, arguments, WString::Empty, writer);
+		if (statistics)
+		{
+			WriteStatisticsTable(writer);
+		}
+	}));
+	return result;
+}
+
+#if defined VCZH_MSVC
+int wmain(int argc, wchar_t* argv[])
+#elif defined VCZH_GCC
+int main(int argc, char* argv[])
+#endif
+{
+	List<WString> args;
+	for (vint i = 1; i < argc; i++)
+	{
+#if defined VCZH_MSVC
+		args.Add(argv[i]);
+#elif defined VCZH_GCC
+		args.Add(atow(argv[i]));
+#endif
+	}
+
+	int result = RunCommand(args);
+	FinalizeGlobalStorage();
+	return result;
+}
\ No newline at end of file
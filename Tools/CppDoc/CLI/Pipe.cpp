@@ -0,0 +1,276 @@
+#include "Pipe.h"
+
+#if defined VCZH_MSVC
+#include <Windows.h>
+#elif defined VCZH_GCC
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+// a longer string is treated as a broken message, so that a client could not make the daemon allocate without limit
+static const vint MaxStringLength = 64 * 1024 * 1024;
+
+#if defined VCZH_MSVC
+
+/***********************************************************************
+PipeConnection (Windows)
+***********************************************************************/
+
+static WString GetPipePath(const WString& name)
+{
+	return L"\\\\.\\pipe\\" + name;
+}
+
+PipeConnection::PipeConnection(void* _handle, bool _server)
+	:handle(_handle)
+	, server(_server)
+{
+}
+
+PipeConnection::~PipeConnection()
+{
+	if (server)
+	{
+		// make sure the client receives everything before the connection is closed
+		FlushFileBuffers((HANDLE)handle);
+		DisconnectNamedPipe((HANDLE)handle);
+	}
+	CloseHandle((HANDLE)handle);
+}
+
+Ptr<PipeConnection> PipeConnection::Listen(const WString& name)
+{
+	// only one client is served at a time
+	HANDLE pipe = CreateNamedPipe(GetPipePath(name).Buffer(), PIPE_ACCESS_DUPLEX, PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS, 1, 65536, 65536, 0, NULL);
+	if (pipe == INVALID_HANDLE_VALUE) return nullptr;
+
+	if (!ConnectNamedPipe(pipe, NULL) && GetLastError() != ERROR_PIPE_CONNECTED)
+	{
+		CloseHandle(pipe);
+		return nullptr;
+	}
+	return new PipeConnection(pipe, true);
+}
+
+Ptr<PipeConnection> PipeConnection::Connect(const WString& name)
+{
+	auto path = GetPipePath(name);
+	while (true)
+	{
+		HANDLE pipe = CreateFile(path.Buffer(), GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, 0, NULL);
+		if (pipe != INVALID_HANDLE_VALUE)
+		{
+			return new PipeConnection(pipe, false);
+		}
+
+		// the server is serving another client
+		if (GetLastError() != ERROR_PIPE_BUSY || !WaitNamedPipe(path.Buffer(), 10000))
+		{
+			return nullptr;
+		}
+	}
+}
+
+bool PipeConnection::Read(void* buffer, vint size)
+{
+	auto reading = (char*)buffer;
+	while (size > 0)
+	{
+		DWORD read = 0;
+		if (!ReadFile((HANDLE)handle, reading, (DWORD)size, &read, NULL) || read == 0) return false;
+		reading += read;
+		size -= read;
+	}
+	return true;
+}
+
+bool PipeConnection::Write(const void* buffer, vint size)
+{
+	auto writing = (const char*)buffer;
+	while (size > 0)
+	{
+		DWORD written = 0;
+		if (!WriteFile((HANDLE)handle, writing, (DWORD)size, &written, NULL) || written == 0) return false;
+		writing += written;
+		size -= written;
+	}
+	return true;
+}
+
+#elif defined VCZH_GCC
+
+/***********************************************************************
+PipeConnection (Linux)
+***********************************************************************/
+
+static AString GetPipePath(const WString& name)
+{
+	return wtoa(L"/tmp/" + name + L".sock");
+}
+
+static int CreatePipeSocket(const AString& path, sockaddr_un& address)
+{
+	if (path.Length() >= (vint)sizeof(address.sun_path)) return -1;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	memcpy(address.sun_path, path.Buffer(), path.Length());
+	return socket(AF_UNIX, SOCK_STREAM, 0);
+}
+
+// a socket keeps listening between calls to Listen, clients wait in its backlog like waiting for a busy named pipe
+class PipeListener
+{
+public:
+	AString						path;
+	int							socket = -1;
+
+	~PipeListener()
+	{
+		Close();
+	}
+
+	void Close()
+	{
+		if (socket != -1)
+		{
+			close(socket);
+			unlink(path.Buffer());
+			socket = -1;
+		}
+	}
+};
+
+static PipeListener pipeListener;
+
+PipeConnection::PipeConnection(void* _handle, bool _server)
+	:handle(_handle)
+	, server(_server)
+{
+}
+
+PipeConnection::~PipeConnection()
+{
+	// data written before closing is still delivered to the peer
+	close((int)(intptr_t)handle);
+}
+
+Ptr<PipeConnection> PipeConnection::Listen(const WString& name)
+{
+	auto path = GetPipePath(name);
+	if (pipeListener.socket == -1 || pipeListener.path != path)
+	{
+		pipeListener.Close();
+
+		// only one server is allowed for a name, a socket file is removed only if nobody is listening on it
+		if (auto client = Connect(name)) return nullptr;
+		unlink(path.Buffer());
+
+		sockaddr_un address;
+		int listener = CreatePipeSocket(path, address);
+		if (listener == -1) return nullptr;
+		if (bind(listener, (sockaddr*)&address, sizeof(address)) != 0 || chmod(path.Buffer(), S_IRUSR | S_IWUSR) != 0 || listen(listener, 16) != 0)
+		{
+			close(listener);
+			unlink(path.Buffer());
+			return nullptr;
+		}
+		pipeListener.path = path;
+		pipeListener.socket = listener;
+	}
+
+	while (true)
+	{
+		int connection = accept(pipeListener.socket, nullptr, nullptr);
+		if (connection != -1)
+		{
+			return new PipeConnection((void*)(intptr_t)connection, true);
+		}
+		if (errno != EINTR && errno != ECONNABORTED)
+		{
+			return nullptr;
+		}
+	}
+}
+
+Ptr<PipeConnection> PipeConnection::Connect(const WString& name)
+{
+	sockaddr_un address;
+	int connection = CreatePipeSocket(GetPipePath(name), address);
+	if (connection == -1) return nullptr;
+	if (connect(connection, (sockaddr*)&address, sizeof(address)) != 0)
+	{
+		close(connection);
+		return nullptr;
+	}
+	return new PipeConnection((void*)(intptr_t)connection, false);
+}
+
+bool PipeConnection::Read(void* buffer, vint size)
+{
+	auto reading = (char*)buffer;
+	while (size > 0)
+	{
+		auto read = recv((int)(intptr_t)handle, reading, (size_t)size, 0);
+		if (read == -1 && errno == EINTR) continue;
+		if (read <= 0) return false;
+		reading += read;
+		size -= read;
+	}
+	return true;
+}
+
+bool PipeConnection::Write(const void* buffer, vint size)
+{
+	// a closed peer fails the call instead of raising SIGPIPE
+	auto writing = (const char*)buffer;
+	while (size > 0)
+	{
+		auto written = send((int)(intptr_t)handle, writing, (size_t)size, MSG_NOSIGNAL);
+		if (written == -1 && errno == EINTR) continue;
+		if (written <= 0) return false;
+		writing += written;
+		size -= written;
+	}
+	return true;
+}
+
+#endif
+
+/***********************************************************************
+PipeConnection
+***********************************************************************/
+
+bool PipeConnection::ReadInt(vint& value)
+{
+	vint32_t data = 0;
+	if (!Read(&data, sizeof(data))) return false;
+	value = data;
+	return true;
+}
+
+bool PipeConnection::WriteInt(vint value)
+{
+	vint32_t data = (vint32_t)value;
+	return Write(&data, sizeof(data));
+}
+
+bool PipeConnection::ReadString(WString& value)
+{
+	vint length = 0;
+	if (!ReadInt(length) || length < 0 || length > MaxStringLength) return false;
+
+	Array<wchar_t> buffer(length + 1);
+	buffer[length] = 0;
+	if (length > 0 && !Read(&buffer[0], sizeof(wchar_t) * length)) return false;
+	value = &buffer[0];
+	return true;
+}
+
+bool PipeConnection::WriteString(const WString& value)
+{
+	if (value.Length() > MaxStringLength) return false;
+	return WriteInt(value.Length()) && Write(value.Buffer(), sizeof(wchar_t) * value.Length());
+}
\ No newline at end of file
@@ -0,0 +1,37 @@
+#ifndef VCZH_DOCUMENT_CPPDOC_CLI_PIPE
+#define VCZH_DOCUMENT_CPPDOC_CLI_PIPE
+
+#include <Utility.h>
+
+/***********************************************************************
+PipeConnection
+	A connection of a local named pipe on Windows, or a Unix domain socket /tmp/<name>.sock on Linux
+	Only accessible from the same machine, the socket file is only accessible by the same user
+	Every string is sent as a 32 bits length followed by wchar_t characters, a string is limited to 64M characters
+***********************************************************************/
+
+class PipeConnection : public Object
+{
+protected:
+	void*						handle = nullptr;
+	bool						server = false;
+
+	PipeConnection(void* _handle, bool _server);
+public:
+	~PipeConnection();
+
+	// Create the pipe and wait for a client, returns nullptr if the pipe cannot be created
+	static Ptr<PipeConnection>	Listen(const WString& name);
+	// Connect to a server, returns nullptr if there is no server
+	static Ptr<PipeConnection>	Connect(const WString& name);
+
+	bool						Read(void* buffer, vint size);
+	bool						Write(const void* buffer, vint size);
+	bool						ReadInt(vint& value);
+	bool						WriteInt(vint value);
+	// Returns false if the length is invalid, the connection should be dropped
+	bool						ReadString(WString& value);
+	bool						WriteString(const WString& value);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,164 @@
+#include "Allocations.h"
+#include <stdlib.h>
+#include <new>
+
+using namespace vl::stream;
+
+/***********************************************************************
+CppAllocationCategory
+***********************************************************************/
+
+// Categories are global variables, they are registered during static initialization
+static CppAllocationCategory* firstCategory = nullptr;
+
+// Placed before each allocation, the size keeps allocations aligned like malloc
+struct CppAllocationHeader
+{
+	CppAllocationCategory*			category;
+	vint64_t						size;
+};
+static const vint					AllocationHeaderSize = 16;
+static_assert(sizeof(CppAllocationHeader) <= AllocationHeaderSize, "CppAllocationHeader is too large");
+
+CppAllocationCategory::CppAllocationCategory(const wchar_t* _group, const wchar_t* _name)
+	:group(_group)
+	, name(_name)
+{
+	next = firstCategory;
+	firstCategory = this;
+}
+
+void* CppAllocationCategory::Allocate(size_t size)
+{
+	auto buffer = (char*)malloc(AllocationHeaderSize + size);
+	if (!buffer) throw std::bad_alloc();
+
+	auto header = (CppAllocationHeader*)buffer;
+	header->category = this;
+	header->size = (vint64_t)size;
+	SPIN_LOCK(lock)
+	{
+		count++;
+		bytes += size;
+		liveBytes += size;
+		if (peakBytes < liveBytes) peakBytes = liveBytes;
+	}
+	return buffer + AllocationHeaderSize;
+}
+
+void CppAllocationCategory::Reset()
+{
+	SPIN_LOCK(lock)
+	{
+		count = 0;
+		bytes = 0;
+		peakBytes = liveBytes;
+	}
+}
+
+void CppAllocationCategory::Free(void* buffer)
+{
+	if (!buffer) return;
+	auto header = (CppAllocationHeader*)((char*)buffer - AllocationHeaderSize);
+	auto category = header->category;
+	SPIN_LOCK(category->lock)
+	{
+		category->liveBytes -= header->size;
+	}
+	free(header);
+}
+
+// Categories that have been allocated, the one with the most peak bytes comes first
+static void GetAllocationCategories(List<CppAllocationCategory*>& categories)
+{
+	for (auto category = firstCategory; category; category = category->next)
+	{
+		if (category->count > 0 || category->liveBytes > 0)
+		{
+			categories.Add(category);
+		}
+	}
+
+	if (categories.Count() > 0)
+	{
+		Sort<CppAllocationCategory*>(&categories[0], categories.Count(), [](CppAllocationCategory* a, CppAllocationCategory* b)->vint
+		{
+			if (a->peakBytes != b->peakBytes) return a->peakBytes > b->peakBytes ? -1 : 1;
+			if (a->bytes != b->bytes) return a->bytes > b->bytes ? -1 : 1;
+			return wcscmp(a->name, b->name);
+		});
+	}
+}
+
+/***********************************************************************
+Allocations
+***********************************************************************/
+
+bool IsAllocationAccountingEnabled()
+{
+#ifdef CPPDOC_ALLOCATIONS
+	return true;
+#else
+	return false;
+#endif
+}
+
+void ResetAllocations()
+{
+	for (auto category = firstCategory; category; category = category->next)
+	{
+		category->Reset();
+	}
+}
+
+void WriteAllocationTable(TextWriter& writer)
+{
+	auto writeCell = [&](const WString& text)
+	{
+		writer.WriteString(text);
+		for (vint i = text.Length(); i < 12; i++)
+		{
+			writer.WriteChar(L' ');
+		}
+		writer.WriteString(L"  ");
+	};
+
+	List<CppAllocationCategory*> categories;
+	GetAllocationCategories(categories);
+
+	writeCell(L"count");
+	writeCell(L"bytes");
+	writeCell(L"peak bytes");
+	writer.WriteLine(L"category");
+	for (vint i = 0; i < categories.Count(); i++)
+	{
+		auto category = categories[i];
+		writeCell(i64tow(category->count));
+		writeCell(i64tow(category->bytes));
+		writeCell(i64tow(category->peakBytes));
+		writer.WriteLine(WString(category->group) + L"::" + category->name);
+	}
+}
+
+WString GetAllocationsJson(const WString& indentation)
+{
+	return GenerateToStream([&](StreamWriter& writer)
+	{
+		List<CppAllocationCategory*> categories;
+		GetAllocationCategories(categories);
+
+		writer.WriteLine(L"{");
+		for (vint i = 0; i < categories.Count(); i++)
+		{
+			auto category = categories[i];
+			WString line = indentation + L"\t" + ToJsonString(category->name) + L": {";
+			line += L" \"group\": " + ToJsonString(category->group);
+			line += L", \"count\": " + i64tow(category->count);
+			line += L", \"bytes\": " + i64tow(category->bytes);
+			line += L", \"peakBytes\": " + i64tow(category->peakBytes);
+			line += i == categories.Count() - 1 ? L" }" : L" },";
+			writer.WriteLine(line);
+		}
+		writer.WriteString(indentation + L"}");
+	});
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+#ifndef VCZH_DOCUMENT_CPPDOC_ALLOCATIONS
+#define VCZH_DOCUMENT_CPPDOC_ALLOCATIONS
+
+#include "Utility.h"
+
+/***********************************************************************
+Allocations
+	Accounting of allocations by category, only collected when CPPDOC_ALLOCATIONS is defined for every project
+	Otherwise CPPDOC_ALLOCATION_* macros compile to nothing and no category is reported
+	Categories are AST classes, Symbol, Resolving and blocks of each ITsys_Allocator
+	Bytes are sizes requested by new, a small header before each allocation is not counted
+***********************************************************************/
+
+class CppAllocationCategory
+{
+protected:
+	SpinLock						lock;
+
+public:
+	const wchar_t*					group;
+	const wchar_t*					name;
+	vint64_t						count = 0;			// allocations since the last ResetAllocations
+	vint64_t						bytes = 0;			// bytes allocated since the last ResetAllocations
+	vint64_t						liveBytes = 0;		// bytes allocated and not freed
+	vint64_t						peakBytes = 0;		// the maximum liveBytes since the last ResetAllocations
+	CppAllocationCategory*			next = nullptr;
+
+	CppAllocationCategory(const wchar_t* _group, const wchar_t* _name);
+
+	void*							Allocate(size_t size);
+	void							Reset();
+	static void						Free(void* buffer);
+};
+
+extern bool							IsAllocationAccountingEnabled();
+extern void							ResetAllocations();
+extern void							WriteAllocationTable(stream::TextWriter& writer);
+extern WString						GetAllocationsJson(const WString& indentation);	// a JSON object, every line except the first one begins with indentation
+
+#ifdef CPPDOC_ALLOCATIONS
+
+#ifdef VCZH_CHECK_MEMORY_LEAKS_NEW
+#error CPPDOC_ALLOCATIONS replaces operator new, it cannot be defined with VCZH_CHECK_MEMORY_LEAKS
+#endif
+
+// Declare operator new and operator delete in a class, defined by CPPDOC_ALLOCATION_DEFINE
+#define CPPDOC_ALLOCATION_OPERATORS\
+	static void* operator new(size_t size);\
+	static void operator delete(void* buffer);
+
+#define CPPDOC_ALLOCATION_DEFINE(GROUP, NAME)\
+	static CppAllocationCategory NAME##_Allocations(GROUP, L_(#NAME));\
+	void* NAME::operator new(size_t size) { return NAME##_Allocations.Allocate(size); }\
+	void NAME::operator delete(void* buffer) { CppAllocationCategory::Free(buffer); }
+
+#else
+#define CPPDOC_ALLOCATION_OPERATORS
+#define CPPDOC_ALLOCATION_DEFINE(GROUP, NAME)
+#endif
+
+#endif
\ No newline at end of file
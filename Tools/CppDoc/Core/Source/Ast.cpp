@@ -21,6 +21,24 @@ CPPDOC_EXPR_LIST(CPPDOC_ACCEPT)
 CPPDOC_STAT_LIST(CPPDOC_ACCEPT)
 #undef CPPDOC_ACCEPT
 
+#define CPPDOC_ALLOCATION(NAME) CPPDOC_ALLOCATION_DEFINE(L"Type", NAME)
+CPPDOC_TYPE_LIST(CPPDOC_ALLOCATION)
+#undef CPPDOC_ALLOCATION
+
+#define CPPDOC_ALLOCATION(NAME) CPPDOC_ALLOCATION_DEFINE(L"Declaration", NAME)
+CPPDOC_DECL_LIST(CPPDOC_ALLOCATION)
+#undef CPPDOC_ALLOCATION
+
+#define CPPDOC_ALLOCATION(NAME) CPPDOC_ALLOCATION_DEFINE(L"Expr", NAME)
+CPPDOC_EXPR_LIST(CPPDOC_ALLOCATION)
+#undef CPPDOC_ALLOCATION
+
+#define CPPDOC_ALLOCATION(NAME) CPPDOC_ALLOCATION_DEFINE(L"Stat", NAME)
+CPPDOC_STAT_LIST(CPPDOC_ALLOCATION)
+#undef CPPDOC_ALLOCATION
+
+CPPDOC_ALLOCATION_DEFINE(L"Resolving", Resolving)
+
 /***********************************************************************
 Resolving
 ***********************************************************************/
@@ -28,32 +46,52 @@ Resolving
 // Change all forward declaration symbols to their real definition
 void Resolving::Calibrate()
 {
+	if (uncalibratedSymbols)
+	{
+		// a real definition could be removed and created again by PrefixSnapshot::Restore, so replaced forward declarations are checked again
+		for (vint i = 0; i < uncalibratedSymbols->Count(); i++)
+		{
+			auto symbol = (*uncalibratedSymbols.Obj())[i];
+			if (symbol->isForwardDeclaration && !resolvedSymbols.Contains(symbol->forwardDeclarationRoot ? symbol->forwardDeclarationRoot : symbol))
+			{
+				CopyFrom(resolvedSymbols, *uncalibratedSymbols.Obj());
+				fullyCalibrated = false;
+				break;
+			}
+		}
+	}
+
 	if (fullyCalibrated) return;
 	vint forwards = 0;
+	bool replaced = false;
 
-	SortedList<Symbol*> used;
+	// forward declarations sharing the same definition, or the definition itself, become one symbol
+	SmallSet<Symbol*> calibrated;
 	for (vint i = 0; i < resolvedSymbols.Count(); i++)
 	{
-		auto& symbol = resolvedSymbols[i];
+		auto symbol = resolvedSymbols[i];
 		if (symbol->isForwardDeclaration)
 		{
 			if (symbol->forwardDeclarationRoot)
 			{
-				if (used.Contains(symbol->forwardDeclarationRoot))
-				{
-					resolvedSymbols.RemoveAt(i);
-					i--;
-				}
-				else
-				{
-					symbol = symbol->forwardDeclarationRoot;
-				}
+				symbol = symbol->forwardDeclarationRoot;
+				replaced = true;
 			}
 			else
 			{
 				forwards++;
 			}
 		}
+		calibrated.Add(symbol);
+	}
+	if (replaced)
+	{
+		if (!uncalibratedSymbols)
+		{
+			uncalibratedSymbols = MakePtr<List<Symbol*>>();
+			CopyFrom(*uncalibratedSymbols.Obj(), resolvedSymbols);
+		}
+		CopyFrom(resolvedSymbols, calibrated);
 	}
 
 	if (forwards == 0)
@@ -1,7 +1,9 @@
 #ifndef VCZH_DOCUMENT_CPPDOC_AST
 #define VCZH_DOCUMENT_CPPDOC_AST
 
+#include "Lexer.h"
 #include "TypeSystem.h"
+#include "Allocations.h"
 
 using namespace vl::regex;
 
@@ -36,38 +38,79 @@ class Resolving : public Object
 {
 protected:
 	bool					fullyCalibrated = false;
+	Ptr<List<Symbol*>>		uncalibratedSymbols;	// resolvedSymbols before any forward declaration is replaced, nullptr if nothing is replaced
 
 public:
-	List<Symbol*>			resolvedSymbols;
+	SmallSet<Symbol*>		resolvedSymbols;
 
+	CPPDOC_ALLOCATION_OPERATORS
 	void					Calibrate();
+	bool					IsFullyCalibrated()const { return fullyCalibrated; }	// false if any forward declaration could still be replaced by its definition
 };
 
 /***********************************************************************
 AST
 ***********************************************************************/
 
+struct CppTokenRange
+{
+	vint					start = -1;		// -1 if the range is not recorded
+	vint					end = -1;		// the end of the last token (exclusive), -1 if the node reaches the end of the input
+};
+
 class IDeclarationVisitor;
 class Declaration : public Object
 {
 public:
 	CppName					name;
 	Symbol*					symbol = nullptr;
+	CppTokenRange			range;
+	CppDocumentRange		document;		// DOCUMENT tokens before the first token of the declaration
 
 	virtual void			Accept(IDeclarationVisitor* visitor) = 0;
 };
 
+// TypeToTsys results of a type
+class TypeTsysCache : public Object
+{
+public:
+	ITsysAlloc*							owner = nullptr;	// the allocator that created everything in results
+	vint								version = 0;		// the version of the allocator when results are filled
+	Dictionary<vint, Ptr<List<ITsys*>>>	results;			// keyed by calling convention and memberOf
+};
+
 class ITypeVisitor;
 class Type : public Object
 {
 public:
+	Ptr<TypeTsysCache>		tsysCache;		// nullptr until any TypeToTsys result is cached
+
 	virtual void			Accept(ITypeVisitor* visitor) = 0;
 };
 
+class IIndexRecorder;
+class IndexTable;
+
+// The last ExprToTsys result of an expression
+class ExprTsysCache : public Object
+{
+public:
+	ITsysAlloc*				owner = nullptr;		// the allocator that created everything in results
+	vint					version = 0;			// the version of the allocator when results are filled
+	vint					symbolVersion = 0;		// descendantVersion of the root when results are filled, any symbol added later could change results
+	Symbol*					context = nullptr;		// the context that results are resolved in
+	IIndexRecorder*			recorder = nullptr;		// the recorder that has been notified when creating results
+	IndexTable*				index = nullptr;		// the index table that has been filled when creating results
+	List<ExprTsysItem>		results;
+};
+
 class IExprVisitor;
 class Expr : public Object
 {
 public:
+	Ptr<ExprTsysCache>		tsysCache;		// nullptr until any ExprToTsys result is cached
+	CppTokenRange			range;
+
 	virtual void			Accept(IExprVisitor* visitor) = 0;
 };
 
@@ -76,6 +119,7 @@ class Stat : public Object
 {
 public:
 	Symbol*					symbol = nullptr;
+	CppTokenRange			range;
 
 	virtual void			Accept(IStatVisitor* visitor) = 0;
 };
@@ -125,7 +169,20 @@ using TypeTsysList = List<ITsys*>;
 using ExprTsysList = List<ExprTsysItem>;
 
 extern bool					IsSameResolvedType(Ptr<Type> t1, Ptr<Type> t2);
+struct FunctionTypeExpansionCounters
+{
+	vint					ambiguousFunctions = 0;		// function types with more than one combination of return and parameter types
+	vint					createdCombinations = 0;	// function type objects created for ambiguous function types
+	vint					droppedCombinations = 0;	// combinations not created because of ParsingRecovery::functionTypeExpansionLimit
+	vint					deferredFunctions = 0;		// ambiguous function types called by candidates of each parameter, without creating combinations
+};
+
+extern bool					TypeToTsysCacheEnabled;
+extern FunctionTypeExpansionCounters	GetFunctionTypeExpansionStatistics();	// counters of all threads
 extern void					TypeToTsys(ParsingArguments& pa, Ptr<Type> t, TypeTsysList& tsys, TsysCallingConvention cc = TsysCallingConvention::None, bool memberOf = false);
+class FunctionType;
+extern vint					TypeToFunctionTypeCandidates(ParsingArguments& pa, Ptr<FunctionType> t, Array<TypeTsysList>& candidates);	// candidates[0] for the return type and candidates[i + 1] for each parameter, returns the number of combinations
+extern bool					ExprToTsysCacheEnabled;
 extern void					ExprToTsys(ParsingArguments& pa, Ptr<Expr> e, ExprTsysList& tsys);
 
 #endif
\ No newline at end of file
@@ -34,7 +34,7 @@ public:
 #undef CPPDOC_VISIT
 };
 
-#define IDeclarationVisitor_ACCEPT void Accept(IDeclarationVisitor* visitor)override
+#define IDeclarationVisitor_ACCEPT CPPDOC_ALLOCATION_OPERATORS void Accept(IDeclarationVisitor* visitor)override
 
 /***********************************************************************
 Types
@@ -103,6 +103,7 @@ public:
 	bool											decoratorForceInline = false;
 	bool											decoratorAbstract = false;
 	bool											needResolveTypeFromStatement = false;
+	vint											defaultParameterCount = 0;	// number of trailing parameters with default values
 };
 
 class ForwardEnumDeclaration : public Declaration
@@ -40,7 +40,7 @@ public:
 #undef CPPDOC_VISIT
 };
 
-#define IExprVisitor_ACCEPT void Accept(IExprVisitor* visitor)override
+#define IExprVisitor_ACCEPT CPPDOC_ALLOCATION_OPERATORS void Accept(IExprVisitor* visitor)override
 
 /***********************************************************************
 Preparation
@@ -33,9 +33,24 @@ public:
 
 	static void AddInternal(ExprTsysList& list, ExprTsysList& items)
 	{
+		if (list.Count() + items.Count() <= 8)
+		{
+			for (vint i = 0; i < items.Count(); i++)
+			{
+				AddInternal(list, items[i]);
+			}
+			return;
+		}
+
+		// a hash set of existing items avoids scanning list for each item when both lists are large
+		SmallSet<ExprTsysItem> added;
+		CopyFrom(added, list);
 		for (vint i = 0; i < items.Count(); i++)
 		{
-			AddInternal(list, items[i]);
+			if (added.Add(items[i]))
+			{
+				list.Add(items[i]);
+			}
 		}
 	}
 
@@ -81,6 +96,27 @@ public:
 		}
 	}
 
+	/***********************************************************************
+	DeferredFunction: An ambiguous function called by candidates of each parameter
+		Overloading is resolved for each argument independently,
+		so function types of all combinations are not necessary
+	***********************************************************************/
+
+	class DeferredFunction : public Object
+	{
+	public:
+		Symbol*					symbol = nullptr;
+		bool					ellipsis = false;
+		Array<TypeTsysList>		candidates;			// candidates[0] for the return type, candidates[i + 1] for the i-th parameter
+
+		DeferredFunction(vint paramCount)
+			:candidates(paramCount + 1)
+		{
+		}
+	};
+
+	using DeferredFunctionList = List<Ptr<DeferredFunction>>;
+
 	/***********************************************************************
 	IsStaticSymbol: Test if a symbol is a static class member
 	***********************************************************************/
@@ -88,7 +124,7 @@ public:
 	template<typename TForward>
 	static bool IsStaticSymbol(Symbol* symbol, Ptr<TForward> decl)
 	{
-		if (auto rootDecl = decl.Cast<typename TForward::ForwardRootType>())
+		if (auto rootDecl = decl.template Cast<typename TForward::ForwardRootType>())
 		{
 			if (rootDecl->decoratorStatic)
 			{
@@ -387,7 +423,7 @@ public:
 	FindQualifiedFunctions: Remove everything that are not qualified functions
 	***********************************************************************/
 
-	static void FindQualifiedFunctions(ParsingArguments& pa, TsysCV thisCV, TsysRefType thisRef, ExprTsysList& funcTypes, bool lookForOp)
+	static void FindQualifiedFunctions(ParsingArguments& pa, TsysCV thisCV, TsysRefType thisRef, ExprTsysList& funcTypes, bool lookForOp, DeferredFunctionList* deferred = nullptr)
 	{
 		ExprTsysList expandedFuncTypes;
 		List<TsysConv> funcChoices;
@@ -434,7 +470,35 @@ public:
 			}
 		}
 
-		FilterFunctionByConv(expandedFuncTypes, funcChoices);
+		if (deferred && deferred->Count() > 0)
+		{
+			// deferred functions are filtered together with function types
+			vint funcCount = expandedFuncTypes.Count();
+			for (vint i = 0; i < deferred->Count(); i++)
+			{
+				funcChoices.Add(TestFunctionQualifier(thisCV, thisRef, { deferred->Get(i)->symbol,ExprTsysType::PRValue,nullptr }));
+			}
+
+			auto target = FindMinConv(funcChoices);
+			for (vint i = funcChoices.Count() - 1; i >= 0; i--)
+			{
+				if (target == TsysConv::Illegal || funcChoices[i] != target)
+				{
+					if (i < funcCount)
+					{
+						expandedFuncTypes.RemoveAt(i);
+					}
+					else
+					{
+						deferred->RemoveAt(i - funcCount);
+					}
+				}
+			}
+		}
+		else
+		{
+			FilterFunctionByConv(expandedFuncTypes, funcChoices);
+		}
 		CopyFrom(funcTypes, expandedFuncTypes);
 	}
 
@@ -442,67 +506,241 @@ public:
 	VisitOverloadedFunction: Select good candidates from overloaded functions
 	***********************************************************************/
 
-	static void VisitOverloadedFunction(ParsingArguments& pa, ExprTsysList& funcTypes, List<Ptr<ExprTsysList>>& argTypesList, ExprTsysList& result)
+	static vint GetDefaultParameterCount(Symbol* symbol)
 	{
-		Array<vint> funcDPs(funcTypes.Count());
-		for (vint i = 0; i < funcTypes.Count(); i++)
+		if (symbol->decls.Count() != 1) return 0;
+		auto decl = symbol->decls[0].Cast<ForwardFunctionDeclaration>();
+		return decl ? decl->defaultParameterCount : 0;
+	}
+
+	// Test if a function could be called with a number of arguments by its declaration, before its type is evaluated
+	// Returns true for anything that is not a function, e.g. a variable of a class with operator()
+	static bool IsArityAcceptable(Symbol* symbol, vint argumentCount)
+	{
+		if (symbol->decls.Count() != 1) return true;
+		auto decl = symbol->decls[0].Cast<ForwardFunctionDeclaration>();
+		if (!decl) return true;
+		auto type = GetTypeWithoutMemberAndCC(decl->type).Cast<FunctionType>();
+		if (!type) return true;
+
+		vint missParamCount = type->parameters.Count() - argumentCount;
+		return missParamCount < 0 ? type->ellipsis : missParamCount <= decl->defaultParameterCount;
+	}
+
+	// Get functions of a name in a scope bucketed by the number of parameters, the bucket is built on the first call
+	static OverloadArityTable::OverloadSet* GetOverloadSet(Symbol* scope, const WString& name)
+	{
+		if (!scope->overloadArityTable)
 		{
-			auto symbol = funcTypes[i].symbol;
-			if (symbol->decls.Count() == 1)
+			scope->overloadArityTable = MakePtr<OverloadArityTable>();
+		}
+		auto& overloadSets = scope->overloadArityTable->overloadSets;
+
+		vint index = overloadSets.Keys().IndexOf(name);
+		if (index != -1)
+		{
+			return overloadSets.Values()[index].Obj();
+		}
+
+		auto overloadSet = MakePtr<OverloadArityTable::OverloadSet>();
+		index = scope->children.Keys().IndexOf(name);
+		if (index != -1)
+		{
+			const auto& symbols = scope->children.GetByIndex(index);
+			for (vint i = 0; i < symbols.Count(); i++)
 			{
-				if (auto decl = symbol->decls[0].Cast<ForwardFunctionDeclaration>())
+				auto symbol = symbols[i].Obj();
+				auto decl = symbol->decls.Count() == 1 ? symbol->decls[0].Cast<ForwardFunctionDeclaration>() : nullptr;
+				auto type = decl ? GetTypeWithoutMemberAndCC(decl->type).Cast<FunctionType>() : nullptr;
+				if (!type)
+				{
+					overloadSet->others.Add(symbol);
+				}
+				else if (type->ellipsis)
 				{
-					if (auto type = GetTypeWithoutMemberAndCC(decl->type).Cast<FunctionType>())
+					overloadSet->ellipsis.Add(symbol);
+				}
+				else
+				{
+					overloadSet->fixedArity.Add(type->parameters.Count(), symbol);
+					if (overloadSet->maxDefaultParameterCount < decl->defaultParameterCount)
 					{
-						for (vint j = 0; j < type->parameters.Count(); j++)
-						{
-							if (type->parameters[j]->initializer)
-							{
-								funcDPs[i] = type->parameters.Count() - j;
-								goto EXAMINE_NEXT_FUNCTION;
-							}
-						}
-						funcDPs[i] = 0;
-					EXAMINE_NEXT_FUNCTION:;
+						overloadSet->maxDefaultParameterCount = decl->defaultParameterCount;
 					}
 				}
 			}
 		}
 
-		ExprTsysList validFuncTypes;
-		for (vint i = 0; i < funcTypes.Count(); i++)
+		overloadSets.Add(name, overloadSet);
+		return overloadSet.Obj();
+	}
+
+	// Add functions of a name in a scope that could be called with a number of arguments
+	// Only buckets of functions with argumentCount to argumentCount + maxDefaultParameterCount parameters are examined
+	static void FindArityAcceptableFunctions(Symbol* scope, const WString& name, vint argumentCount, SmallSet<Symbol*>& acceptable)
+	{
+		auto overloadSet = GetOverloadSet(scope, name);
+		for (vint i = 0; i <= overloadSet->maxDefaultParameterCount; i++)
 		{
-			auto funcType = funcTypes[i];
+			vint index = overloadSet->fixedArity.Keys().IndexOf(argumentCount + i);
+			if (index == -1) continue;
 
-			vint funcParamCount = funcType.tsys->GetParamCount();
-			vint missParamCount = funcParamCount - argTypesList.Count();
-			if (missParamCount > 0)
+			const auto& symbols = overloadSet->fixedArity.GetByIndex(index);
+			for (vint j = 0; j < symbols.Count(); j++)
 			{
-				if (missParamCount > funcDPs[i])
+				if (IsArityAcceptable(symbols[j], argumentCount))
 				{
-					continue;
+					acceptable.Add(symbols[j]);
 				}
 			}
-			else if (missParamCount < 0)
+		}
+
+		for (vint i = 0; i < overloadSet->ellipsis.Count(); i++)
+		{
+			if (IsArityAcceptable(overloadSet->ellipsis[i], argumentCount))
 			{
-				if (!funcType.tsys->GetFunc().ellipsis)
+				acceptable.Add(overloadSet->ellipsis[i]);
+			}
+		}
+
+		for (vint i = 0; i < overloadSet->others.Count(); i++)
+		{
+			acceptable.Add(overloadSet->others[i]);
+		}
+	}
+
+	// Evaluate candidates of each parameter instead of function types, returns nullptr if the function type has only one combination
+	static Ptr<DeferredFunction> DeferFunction(ParsingArguments& pa, Symbol* symbol, bool afterScope)
+	{
+		if (symbol->forwardDeclarationRoot || symbol->decls.Count() != 1) return nullptr;
+		auto decl = symbol->decls[0].Cast<ForwardFunctionDeclaration>();
+		if (!decl || decl->needResolveTypeFromStatement) return nullptr;
+		auto type = decl->type.Cast<FunctionType>();
+		if (!type) return nullptr;
+
+		// a pointer to member is not callable
+		if (afterScope && symbol->parent && symbol->parent->decls.Count() > 0 && symbol->parent->decls[0].Cast<ClassDeclaration>())
+		{
+			if (!IsStaticSymbol<ForwardFunctionDeclaration>(symbol, decl)) return nullptr;
+		}
+
+		auto deferred = MakePtr<DeferredFunction>(type->parameters.Count());
+		if (TypeToFunctionTypeCandidates(pa, type, deferred->candidates) <= 1) return nullptr;
+		deferred->symbol = symbol;
+		deferred->ellipsis = type->ellipsis;
+		return deferred;
+	}
+
+	// Visit functions of a name that could be called with a number of arguments, returns false if the expression is not a name
+	// Ambiguous functions are stored in deferred instead of creating function types of all combinations
+	static bool VisitFunctionsByArity(ParsingArguments& pa, Ptr<Expr> expr, vint argumentCount, ExprTsysList& result, DeferredFunctionList& deferred)
+	{
+		Ptr<Resolving> resolving;
+		bool afterScope = false;
+		if (auto idExpr = expr.Cast<IdExpr>())
+		{
+			resolving = idExpr->resolving;
+		}
+		else if (auto childExpr = expr.Cast<ChildExpr>())
+		{
+			resolving = childExpr->resolving;
+			afterScope = true;
+		}
+		if (!resolving) return false;
+
+		// acceptable functions are taken from the overload set of each scope, and visited in the order of resolved symbols
+		SmallSet<Symbol*> scopes, acceptable;
+		for (vint i = 0; i < resolving->resolvedSymbols.Count(); i++)
+		{
+			auto symbol = resolving->resolvedSymbols[i];
+			if (!symbol->parent)
+			{
+				acceptable.Add(symbol);
+			}
+			else if (scopes.Add(symbol->parent))
+			{
+				FindArityAcceptableFunctions(symbol->parent, symbol->name, argumentCount, acceptable);
+			}
+
+			if (acceptable.Contains(symbol))
+			{
+				if (auto deferredFunction = DeferFunction(pa, symbol, afterScope))
 				{
-					continue;
+					deferred.Add(deferredFunction);
+				}
+				else
+				{
+					VisitSymbol(pa, nullptr, symbol, afterScope, result);
 				}
 			}
+		}
+		return true;
+	}
 
-			validFuncTypes.Add(funcType);
+	static TsysConv TestArgument(ParsingArguments& pa, ITsys* paramType, ExprTsysList& argTypes)
+	{
+		auto bestChoice = TsysConv::Illegal;
+		for (vint k = 0; k < argTypes.Count(); k++)
+		{
+			auto choice = TestConvert(pa, paramType, argTypes[k]);
+			if ((vint)bestChoice > (vint)choice) bestChoice = choice;
+		}
+		return bestChoice;
+	}
+
+	static bool IsParamCountAcceptable(Symbol* symbol, vint funcParamCount, bool ellipsis, vint argumentCount)
+	{
+		vint missParamCount = funcParamCount - argumentCount;
+		if (missParamCount > 0)
+		{
+			return missParamCount <= GetDefaultParameterCount(symbol);
+		}
+		else if (missParamCount < 0)
+		{
+			return ellipsis;
+		}
+		return true;
+	}
+
+	static void VisitOverloadedFunction(ParsingArguments& pa, ExprTsysList& funcTypes, List<Ptr<ExprTsysList>>& argTypesList, ExprTsysList& result, DeferredFunctionList* deferred = nullptr)
+	{
+		vint deferredCount = deferred ? deferred->Count() : 0;
+		CPPDOC_COUNT(overloadResolutions);
+		CPPDOC_COUNT_ADD(overloadCandidates, funcTypes.Count() + deferredCount);
+		ConsumeBudget(pa, ParsingBudget::OverloadCandidates, funcTypes.Count() + deferredCount);
+		CPPDOC_TRACE_SCOPE(L"VisitOverloadedFunction");
+		CPPDOC_TRACE_DETAIL(itow(funcTypes.Count() + deferredCount) + L" candidates");
+		ExprTsysList validFuncTypes;
+		for (vint i = 0; i < funcTypes.Count(); i++)
+		{
+			auto funcType = funcTypes[i];
+			if (IsParamCountAcceptable(funcType.symbol, funcType.tsys->GetParamCount(), funcType.tsys->GetFunc().ellipsis, argTypesList.Count()))
+			{
+				validFuncTypes.Add(funcType);
+			}
+		}
+
+		DeferredFunctionList validDeferred;
+		for (vint i = 0; i < deferredCount; i++)
+		{
+			auto deferredFunction = deferred->Get(i);
+			if (IsParamCountAcceptable(deferredFunction->symbol, deferredFunction->candidates.Count() - 1, deferredFunction->ellipsis, argTypesList.Count()))
+			{
+				validDeferred.Add(deferredFunction);
+			}
 		}
 
-		Array<bool> selectedIndices(validFuncTypes.Count());
-		for (vint i = 0; i < validFuncTypes.Count(); i++)
+		vint funcCount = validFuncTypes.Count();
+		Array<bool> selectedIndices(funcCount + validDeferred.Count());
+		for (vint i = 0; i < selectedIndices.Count(); i++)
 		{
 			selectedIndices[i] = true;
 		}
 
 		for (vint i = 0; i < argTypesList.Count(); i++)
 		{
-			Array<TsysConv> funcChoices(validFuncTypes.Count());
+			Array<TsysConv> funcChoices(selectedIndices.Count());
+			auto& argTypes = *argTypesList[i].Obj();
 
 			for (vint j = 0; j < validFuncTypes.Count(); j++)
 			{
@@ -515,16 +753,26 @@ public:
 					continue;
 				}
 
-				auto paramType = funcType.tsys->GetParam(i);
-				auto& argTypes = *argTypesList[i].Obj();
+				funcChoices[j] = TestArgument(pa, funcType.tsys->GetParam(i), argTypes);
+			}
+
+			for (vint j = 0; j < validDeferred.Count(); j++)
+			{
+				// a deferred function has a selected combination if any candidate of this parameter is the best
+				auto& candidates = validDeferred[j]->candidates;
+				if (candidates.Count() - 1 <= i)
+				{
+					funcChoices[funcCount + j] = TsysConv::Ellipsis;
+					continue;
+				}
 
 				auto bestChoice = TsysConv::Illegal;
-				for (vint k = 0; k < argTypes.Count(); k++)
+				for (vint k = 0; k < candidates[i + 1].Count(); k++)
 				{
-					auto choice = TestConvert(pa, paramType, argTypes[k]);
+					auto choice = TestArgument(pa, candidates[i + 1][k], argTypes);
 					if ((vint)bestChoice > (vint)choice) bestChoice = choice;
 				}
-				funcChoices[j] = bestChoice;
+				funcChoices[funcCount + j] = bestChoice;
 			}
 
 			auto min = FindMinConv(funcChoices);
@@ -533,7 +781,7 @@ public:
 				return;
 			}
 
-			for (vint j = 0; j < validFuncTypes.Count(); j++)
+			for (vint j = 0; j < selectedIndices.Count(); j++)
 			{
 				if (funcChoices[j] != min)
 				{
@@ -542,13 +790,21 @@ public:
 			}
 		}
 
-		for (vint i = 0; i < selectedIndices.Count(); i++)
+		for (vint i = 0; i < funcCount; i++)
 		{
 			if (selectedIndices[i])
 			{
 				AddTemp(result, validFuncTypes[i].tsys->GetElement());
 			}
 		}
+
+		for (vint i = 0; i < validDeferred.Count(); i++)
+		{
+			if (selectedIndices[funcCount + i])
+			{
+				AddTemp(result, validDeferred[i]->candidates[0]);
+			}
+		}
 	}
 
 	/***********************************************************************
@@ -567,6 +823,113 @@ public:
 		AddInternal(result, fieldResult);
 	}
 
+	/***********************************************************************
+	VisitOperator: Find user-defined operators
+		rightItem: nullptr for prefix unary operators
+		Returns: true if any operator is found, even if nothing is selected
+	***********************************************************************/
+
+	static bool VisitOperatorInternal(ParsingArguments& pa, CppName& name, const ExprTsysItem& leftItem, const ExprTsysItem* rightItem, ExprTsysList& result)
+	{
+		TsysCV leftCV, rightCV;
+		TsysRefType leftRefType, rightRefType;
+		auto leftEntity = leftItem.tsys->GetEntity(leftCV, leftRefType);
+		auto rightEntity = rightItem ? rightItem->tsys->GetEntity(rightCV, rightRefType) : nullptr;
+
+		CppName opName = name;
+		opName.name = L"operator " + opName.name;
+
+		ResolveSymbolResult opMethods, opFuncs;
+		if (leftEntity->GetType() == TsysType::Decl)
+		{
+			{
+				ParsingArguments newPa(pa, leftEntity->GetDecl());
+				opMethods = ResolveSymbol(newPa, opName, SearchPolicy::ChildSymbol, opMethods);
+			}
+			{
+				ParsingArguments newPa(pa, leftEntity->GetDecl()->parent);
+				opFuncs = ResolveSymbol(newPa, opName, SearchPolicy::ChildSymbol, opFuncs);
+			}
+		}
+		if (rightEntity && rightEntity->GetType() == TsysType::Decl)
+		{
+			ParsingArguments newPa(pa, rightEntity->GetDecl()->parent);
+			opFuncs = ResolveSymbol(newPa, opName, SearchPolicy::ChildSymbol, opFuncs);
+		}
+		opFuncs = ResolveSymbol(pa, opName, SearchPolicy::SymbolAccessableInScope, opFuncs);
+
+		if (opMethods.values)
+		{
+			ExprTsysList opTypes;
+			for (vint i = 0; i < opMethods.values->resolvedSymbols.Count(); i++)
+			{
+				VisitSymbol(pa, &leftItem, opMethods.values->resolvedSymbols[i], false, opTypes);
+			}
+			FilterFunctionByQualifier(leftCV, leftRefType, opTypes);
+
+			List<Ptr<ExprTsysList>> argTypesList;
+			if (rightItem)
+			{
+				argTypesList.Add(MakePtr<ExprTsysList>());
+				AddInternal(*argTypesList[0].Obj(), *rightItem);
+			}
+			FindQualifiedFunctions(pa, {}, TsysRefType::None, opTypes, false);
+			VisitOverloadedFunction(pa, opTypes, argTypesList, result);
+		}
+
+		if (opFuncs.values)
+		{
+			ExprTsysList opTypes;
+			for (vint i = 0; i < opFuncs.values->resolvedSymbols.Count(); i++)
+			{
+				VisitSymbol(pa, nullptr, opFuncs.values->resolvedSymbols[i], true, opTypes);
+			}
+
+			List<Ptr<ExprTsysList>> argTypesList;
+			argTypesList.Add(MakePtr<ExprTsysList>());
+			AddInternal(*argTypesList[0].Obj(), leftItem);
+			if (rightItem)
+			{
+				argTypesList.Add(MakePtr<ExprTsysList>());
+				AddInternal(*argTypesList[1].Obj(), *rightItem);
+			}
+			FindQualifiedFunctions(pa, {}, TsysRefType::None, opTypes, false);
+			VisitOverloadedFunction(pa, opTypes, argTypesList, result);
+		}
+
+		return opMethods.values || opFuncs.values;
+	}
+
+	bool VisitOperator(CppName& name, const ExprTsysItem& leftItem, const ExprTsysItem* rightItem, ExprTsysList& result)
+	{
+		auto cache = pa.operatorCache.Obj();
+		if (!cache)
+		{
+			return VisitOperatorInternal(pa, name, leftItem, rightItem, result);
+		}
+
+		// other symbols are not operator candidates and do not change conversions of operands
+		if (cache->symbolVersion != pa.root->operatorVersion)
+		{
+			cache->results.Clear();
+			cache->symbolVersion = pa.root->operatorVersion;
+		}
+
+		Tuple<WString, ExprTsysItem, ExprTsysItem, Symbol*> key(name.name, leftItem, rightItem ? *rightItem : ExprTsysItem(), pa.context);
+		vint index = cache->results.Keys().IndexOf(key);
+		if (index == -1)
+		{
+			auto opResult = MakePtr<ExprTsysList>();
+			bool found = VisitOperatorInternal(pa, name, leftItem, rightItem, *opResult.Obj());
+			cache->results.Add(key, { found,opResult });
+			index = cache->results.Keys().IndexOf(key);
+		}
+
+		auto value = cache->results.Values()[index];
+		AddInternal(result, *value.f1.Obj());
+		return value.f0;
+	}
+
 	/***********************************************************************
 	Expressions
 	***********************************************************************/
@@ -735,6 +1098,7 @@ public:
 		}
 
 		auto global = pa.root.Obj();
+		if (pa.partition) pa.partition->Lookup(global, L"std");
 		vint index = global->children.Keys().IndexOf(L"std");
 		if (index == -1) return;
 		auto& stds = global->children.GetByIndex(index);
@@ -887,16 +1251,13 @@ public:
 		}
 
 		self->resolving = totalRar.values;
-		if (pa.recorder)
+		if (totalRar.values)
 		{
-			if (totalRar.values)
-			{
-				pa.recorder->Index(self->name, totalRar.values);
-			}
-			if (totalRar.types)
-			{
-				pa.recorder->ExpectValueButType(self->name, totalRar.types);
-			}
+			IndexResolving(pa, self->name, totalRar.values, IndexReason::Resolved);
+		}
+		if (totalRar.types)
+		{
+			IndexResolving(pa, self->name, totalRar.types, IndexReason::ExpectValueButType);
 		}
 	}
 
@@ -979,11 +1340,16 @@ public:
 		}
 		else if (self->expr)
 		{
+			// functions of a name are filtered by arity before their types are evaluated
 			ExprTsysList funcTypes;
-			ExprToTsys(pa, self->expr, funcTypes);
+			DeferredFunctionList deferred;
+			if (!VisitFunctionsByArity(pa, self->expr, argTypesList.Count(), funcTypes, deferred))
+			{
+				ExprToTsys(pa, self->expr, funcTypes);
+			}
 
-			FindQualifiedFunctions(pa, {}, TsysRefType::None, funcTypes, true);
-			VisitOverloadedFunction(pa, funcTypes, argTypesList, result);
+			FindQualifiedFunctions(pa, {}, TsysRefType::None, funcTypes, true, &deferred);
+			VisitOverloadedFunction(pa, funcTypes, argTypesList, result, &deferred);
 		}
 	}
 
@@ -1000,57 +1366,8 @@ public:
 
 			if (entity->GetType() == TsysType::Decl)
 			{
-				ResolveSymbolResult opMethods, opFuncs;
-				{
-					CppName opName = self->opName;
-					opName.name = L"operator " + opName.name;
-					ParsingArguments newPa(pa, entity->GetDecl());
-					opMethods = ResolveSymbol(newPa, opName, SearchPolicy::ChildSymbol, opMethods);
-				}
-				{
-					CppName opName = self->opName;
-					opName.name = L"operator " + opName.name;
-					ParsingArguments newPa(pa, entity->GetDecl()->parent);
-					opFuncs = ResolveSymbol(newPa, opName, SearchPolicy::ChildSymbol, opFuncs);
-				}
-				{
-					CppName opName = self->opName;
-					opName.name = L"operator " + opName.name;
-					opFuncs = ResolveSymbol(pa, opName, SearchPolicy::SymbolAccessableInScope, opFuncs);
-				}
-
-				if (opMethods.values)
-				{
-					ExprTsysList opTypes;
-					for (vint j = 0; j < opMethods.values->resolvedSymbols.Count(); j++)
-					{
-						VisitSymbol(pa, &types[i], opMethods.values->resolvedSymbols[j], false, opTypes);
-					}
-					FilterFunctionByQualifier(cv, refType, opTypes);
-
-					List<Ptr<ExprTsysList>> argTypesList;
-					argTypesList.Add(MakePtr<ExprTsysList>());
-					AddInternal(*argTypesList[0].Obj(), { nullptr,ExprTsysType::PRValue,pa.tsys->Int() });
-					FindQualifiedFunctions(pa, {}, TsysRefType::None, opTypes, false);
-					VisitOverloadedFunction(pa, opTypes, argTypesList, result);
-				}
-
-				if (opFuncs.values)
-				{
-					ExprTsysList opTypes;
-					for (vint j = 0; j < opFuncs.values->resolvedSymbols.Count(); j++)
-					{
-						VisitSymbol(pa, nullptr, opFuncs.values->resolvedSymbols[j], true, opTypes);
-					}
-
-					List<Ptr<ExprTsysList>> argTypesList;
-					argTypesList.Add(MakePtr<ExprTsysList>());
-					argTypesList.Add(MakePtr<ExprTsysList>());
-					AddInternal(*argTypesList[0].Obj(), types[i]);
-					AddInternal(*argTypesList[1].Obj(), { nullptr,ExprTsysType::PRValue,pa.tsys->Int() });
-					FindQualifiedFunctions(pa, {}, TsysRefType::None, opTypes, false);
-					VisitOverloadedFunction(pa, opTypes, argTypesList, result);
-				}
+				ExprTsysItem intItem(nullptr, ExprTsysType::PRValue, pa.tsys->Int());
+				VisitOperator(self->opName, types[i], &intItem, result);
 			}
 			else if (entity->GetType()==TsysType::Primitive)
 			{
@@ -1140,55 +1457,7 @@ public:
 
 			if (entity->GetType() == TsysType::Decl)
 			{
-				ResolveSymbolResult opMethods, opFuncs;
-				{
-					CppName opName = self->opName;
-					opName.name = L"operator " + opName.name;
-					ParsingArguments newPa(pa, entity->GetDecl());
-					opMethods = ResolveSymbol(newPa, opName, SearchPolicy::ChildSymbol, opMethods);
-				}
-				{
-					CppName opName = self->opName;
-					opName.name = L"operator " + opName.name;
-					ParsingArguments newPa(pa, entity->GetDecl()->parent);
-					opFuncs = ResolveSymbol(newPa, opName, SearchPolicy::ChildSymbol, opFuncs);
-				}
-				{
-					CppName opName = self->opName;
-					opName.name = L"operator " + opName.name;
-					opFuncs = ResolveSymbol(pa, opName, SearchPolicy::SymbolAccessableInScope, opFuncs);
-				}
-
-				if (opMethods.values)
-				{
-					ExprTsysList opTypes;
-					for (vint j = 0; j < opMethods.values->resolvedSymbols.Count(); j++)
-					{
-						VisitSymbol(pa, &types[i], opMethods.values->resolvedSymbols[j], false, opTypes);
-					}
-					FilterFunctionByQualifier(cv, refType, opTypes);
-
-					List<Ptr<ExprTsysList>> argTypesList;
-					FindQualifiedFunctions(pa, {}, TsysRefType::None, opTypes, false);
-					VisitOverloadedFunction(pa, opTypes, argTypesList, result);
-				}
-
-				if (opFuncs.values)
-				{
-					ExprTsysList opTypes;
-					for (vint j = 0; j < opFuncs.values->resolvedSymbols.Count(); j++)
-					{
-						VisitSymbol(pa, nullptr, opFuncs.values->resolvedSymbols[j], true, opTypes);
-					}
-
-					List<Ptr<ExprTsysList>> argTypesList;
-					argTypesList.Add(MakePtr<ExprTsysList>());
-					AddInternal(*argTypesList[0].Obj(), types[i]);
-					FindQualifiedFunctions(pa, {}, TsysRefType::None, opTypes, false);
-					VisitOverloadedFunction(pa, opTypes, argTypesList, result);
-				}
-
-				if (opMethods.values || opFuncs.values)
+				if (VisitOperator(self->opName, types[i], nullptr, result))
 				{
 					break;
 				}
@@ -1317,71 +1586,7 @@ public:
 
 				if (leftEntity->GetType() == TsysType::Decl || rightEntity->GetType() == TsysType::Decl)
 				{
-					ResolveSymbolResult opMethods, opFuncs;
-					if (leftEntity->GetType() == TsysType::Decl)
-					{
-						{
-							CppName opName = self->opName;
-							opName.name = L"operator " + opName.name;
-							ParsingArguments newPa(pa, leftEntity->GetDecl());
-							opMethods = ResolveSymbol(newPa, opName, SearchPolicy::ChildSymbol, opMethods);
-						}
-						{
-							CppName opName = self->opName;
-							opName.name = L"operator " + opName.name;
-							ParsingArguments newPa(pa, leftEntity->GetDecl()->parent);
-							opFuncs = ResolveSymbol(newPa, opName, SearchPolicy::ChildSymbol, opFuncs);
-						}
-					}
-					if (rightEntity->GetType() == TsysType::Decl)
-					{
-						{
-							CppName opName = self->opName;
-							opName.name = L"operator " + opName.name;
-							ParsingArguments newPa(pa, rightEntity->GetDecl()->parent);
-							opFuncs = ResolveSymbol(newPa, opName, SearchPolicy::ChildSymbol, opFuncs);
-						}
-					}
-					{
-						CppName opName = self->opName;
-						opName.name = L"operator " + opName.name;
-						opFuncs = ResolveSymbol(pa, opName, SearchPolicy::SymbolAccessableInScope, opFuncs);
-					}
-
-					if (opMethods.values)
-					{
-						ExprTsysList opTypes;
-						for (vint k = 0; k < opMethods.values->resolvedSymbols.Count(); k++)
-						{
-							VisitSymbol(pa, &leftTypes[i], opMethods.values->resolvedSymbols[k], false, opTypes);
-						}
-						FilterFunctionByQualifier(leftCV, leftRefType, opTypes);
-
-						List<Ptr<ExprTsysList>> argTypesList;
-						argTypesList.Add(MakePtr<ExprTsysList>());
-						AddInternal(*argTypesList[0].Obj(), rightTypes[j]);
-						FindQualifiedFunctions(pa, {}, TsysRefType::None, opTypes, false);
-						VisitOverloadedFunction(pa, opTypes, argTypesList, result);
-					}
-
-					if (opFuncs.values)
-					{
-						ExprTsysList opTypes;
-						for (vint k = 0; k < opFuncs.values->resolvedSymbols.Count(); k++)
-						{
-							VisitSymbol(pa, nullptr, opFuncs.values->resolvedSymbols[k], true, opTypes);
-						}
-
-						List<Ptr<ExprTsysList>> argTypesList;
-						argTypesList.Add(MakePtr<ExprTsysList>());
-						argTypesList.Add(MakePtr<ExprTsysList>());
-						AddInternal(*argTypesList[0].Obj(), leftTypes[i]);
-						AddInternal(*argTypesList[1].Obj(), rightTypes[j]);
-						FindQualifiedFunctions(pa, {}, TsysRefType::None, opTypes, false);
-						VisitOverloadedFunction(pa, opTypes, argTypesList, result);
-					}
-
-					if (opMethods.values || opFuncs.values)
+					if (VisitOperator(self->opName, leftTypes[i], &rightTypes[j], result))
 					{
 						break;
 					}
@@ -1520,10 +1725,48 @@ public:
 	}
 };
 
+// Set to false to always resolve expressions from scratch
+bool ExprToTsysCacheEnabled = true;
+
 // Resolve expressions to types
 void ExprToTsys(ParsingArguments& pa, Ptr<Expr> e, ExprTsysList& tsys)
 {
 	if (!e) throw IllegalExprException();
-	ExprToTsysVisitor visitor(pa, tsys);
-	e->Accept(&visitor);
+	ConsumeBudget(pa, ParsingBudget::Tsys, 0);
+	CPPDOC_TRACE_SCOPE(L"ExprToTsys");
+	CPPDOC_TRACE_DETAIL(L"offset " + itow(e->range.start));
+
+	auto cache = e->tsysCache.Obj();
+	bool cacheHit =
+		ExprToTsysCacheEnabled &&
+		cache &&
+		cache->owner == pa.tsys.Obj() &&
+		cache->version == pa.tsys->GetVersion() &&
+		cache->symbolVersion == pa.root->descendantVersion &&
+		cache->context == pa.context &&
+		cache->recorder == pa.recorder.Obj() &&
+		cache->index == pa.index.Obj();
+
+	if (!cacheHit)
+	{
+		auto newCache = MakePtr<ExprTsysCache>();
+		ExprToTsysVisitor visitor(pa, newCache->results);
+		e->Accept(&visitor);
+
+		if (!ExprToTsysCacheEnabled)
+		{
+			ExprToTsysVisitor::AddInternal(tsys, newCache->results);
+			return;
+		}
+
+		newCache->owner = pa.tsys.Obj();
+		newCache->version = pa.tsys->GetVersion();
+		newCache->symbolVersion = pa.root->descendantVersion;
+		newCache->context = pa.context;
+		newCache->recorder = pa.recorder.Obj();
+		newCache->index = pa.index.Obj();
+		e->tsysCache = newCache;
+		cache = newCache.Obj();
+	}
+	ExprToTsysVisitor::AddInternal(tsys, cache->results);
 }
\ No newline at end of file
@@ -0,0 +1,568 @@
+#include "Ast_Range.h"
+#include "Ast_Decl.h"
+#include "Ast_Expr.h"
+#include "Ast_Stat.h"
+#include "Ast_Type.h"
+
+/***********************************************************************
+CollectRangeVisitor
+***********************************************************************/
+
+class CollectRangeVisitor
+	: public Object
+	, public virtual IDeclarationVisitor
+	, public virtual ITypeVisitor
+	, public virtual IExprVisitor
+	, public virtual IStatVisitor
+{
+public:
+	List<AstRangeItem>		items;				// in pre-order
+	SortedList<Object*>		visited;			// types and initializers could be shared by declarators and declarations
+
+	bool Enter(Object* node)
+	{
+		if (!node || visited.Contains(node)) return false;
+		visited.Add(node);
+		return true;
+	}
+
+	void Add(AstRangeKind kind, Object* node, const CppTokenRange& range)
+	{
+		if (range.start == -1) return;
+		AstRangeItem item;
+		item.kind = kind;
+		item.node = node;
+		item.start = range.start;
+		item.end = range.end;
+		items.Add(item);
+	}
+
+	void Collect(Declaration* decl)
+	{
+		if (Enter(decl))
+		{
+			Add(AstRangeKind::Declaration, decl, decl->range);
+			decl->Accept(this);
+		}
+	}
+
+	void Collect(Type* type)
+	{
+		if (Enter(type))
+		{
+			type->Accept(this);
+		}
+	}
+
+	void Collect(Expr* expr)
+	{
+		if (Enter(expr))
+		{
+			Add(AstRangeKind::Expr, expr, expr->range);
+			expr->Accept(this);
+		}
+	}
+
+	void Collect(Stat* stat)
+	{
+		if (Enter(stat))
+		{
+			Add(AstRangeKind::Stat, stat, stat->range);
+			stat->Accept(this);
+		}
+	}
+
+	void Collect(Initializer* initializer)
+	{
+		if (initializer)
+		{
+			for (vint i = 0; i < initializer->arguments.Count(); i++)
+			{
+				Collect(initializer->arguments[i]);
+			}
+		}
+	}
+
+	template<typename T>
+	void Collect(const Ptr<T>& node)
+	{
+		Collect(node.Obj());
+	}
+
+	template<typename T>
+	void CollectAll(List<Ptr<T>>& nodes)
+	{
+		for (vint i = 0; i < nodes.Count(); i++)
+		{
+			Collect(nodes[i].Obj());
+		}
+	}
+
+	// Declarations
+
+	void Visit(ForwardVariableDeclaration* self)override
+	{
+		Collect(self->type);
+	}
+
+	void Visit(ForwardFunctionDeclaration* self)override
+	{
+		Collect(self->type);
+	}
+
+	void Visit(ForwardEnumDeclaration* self)override
+	{
+		Collect(self->baseType);
+	}
+
+	void Visit(ForwardClassDeclaration* self)override
+	{
+	}
+
+	void Visit(VariableDeclaration* self)override
+	{
+		Collect(self->type);
+		Collect(self->initializer);
+	}
+
+	void Visit(FunctionDeclaration* self)override
+	{
+		Collect(self->type);
+		Collect(self->statement);
+	}
+
+	void Visit(EnumItemDeclaration* self)override
+	{
+		Collect(self->value);
+	}
+
+	void Visit(EnumDeclaration* self)override
+	{
+		Collect(self->baseType);
+		CollectAll(self->items);
+	}
+
+	void Visit(ClassDeclaration* self)override
+	{
+		for (vint i = 0; i < self->baseTypes.Count(); i++)
+		{
+			Collect(self->baseTypes[i].f1);
+		}
+		for (vint i = 0; i < self->decls.Count(); i++)
+		{
+			Collect(self->decls[i].f1);
+		}
+	}
+
+	void Visit(TypeAliasDeclaration* self)override
+	{
+		Collect(self->type);
+	}
+
+	void Visit(UsingNamespaceDeclaration* self)override
+	{
+		Collect(self->type);
+	}
+
+	void Visit(UsingDeclaration* self)override
+	{
+		Collect(self->type);
+	}
+
+	void Visit(NamespaceDeclaration* self)override
+	{
+		CollectAll(self->decls);
+	}
+
+	// Types
+
+	void Visit(PrimitiveType* self)override
+	{
+	}
+
+	void Visit(ReferenceType* self)override
+	{
+		Collect(self->type);
+	}
+
+	void Visit(ArrayType* self)override
+	{
+		Collect(self->type);
+		Collect(self->expr);
+	}
+
+	void Visit(CallingConventionType* self)override
+	{
+		Collect(self->type);
+	}
+
+	void Visit(FunctionType* self)override
+	{
+		Collect(self->returnType);
+		CollectAll(self->parameters);
+		CollectAll(self->exceptions);
+		Collect(self->decoratorReturnType);
+	}
+
+	void Visit(MemberType* self)override
+	{
+		Collect(self->classType);
+		Collect(self->type);
+	}
+
+	void Visit(DeclType* self)override
+	{
+		Collect(self->expr);
+	}
+
+	void Visit(DecorateType* self)override
+	{
+		Collect(self->type);
+	}
+
+	void Visit(RootType* self)override
+	{
+	}
+
+	void Visit(IdType* self)override
+	{
+	}
+
+	void Visit(ChildType* self)override
+	{
+		Collect(self->classType);
+	}
+
+	void Visit(GenericType* self)override
+	{
+		Collect(self->type);
+		for (vint i = 0; i < self->arguments.Count(); i++)
+		{
+			Collect(self->arguments[i].type);
+			Collect(self->arguments[i].expr);
+		}
+	}
+
+	void Visit(VariadicTemplateArgumentType* self)override
+	{
+		Collect(self->type);
+	}
+
+	// Expressions
+
+	void Visit(LiteralExpr* self)override
+	{
+	}
+
+	void Visit(ThisExpr* self)override
+	{
+	}
+
+	void Visit(NullptrExpr* self)override
+	{
+	}
+
+	void Visit(ParenthesisExpr* self)override
+	{
+		Collect(self->expr);
+	}
+
+	void Visit(CastExpr* self)override
+	{
+		Collect(self->type);
+		Collect(self->expr);
+	}
+
+	void Visit(TypeidExpr* self)override
+	{
+		Collect(self->type);
+		Collect(self->expr);
+	}
+
+	void Visit(SizeofExpr* self)override
+	{
+		Collect(self->type);
+		Collect(self->expr);
+	}
+
+	void Visit(ThrowExpr* self)override
+	{
+		Collect(self->expr);
+	}
+
+	void Visit(NewExpr* self)override
+	{
+		CollectAll(self->placementArguments);
+		Collect(self->type);
+		CollectAll(self->arguments);
+	}
+
+	void Visit(DeleteExpr* self)override
+	{
+		Collect(self->expr);
+	}
+
+	void Visit(IdExpr* self)override
+	{
+	}
+
+	void Visit(ChildExpr* self)override
+	{
+		Collect(self->classType);
+	}
+
+	void Visit(FieldAccessExpr* self)override
+	{
+		Collect(self->expr);
+	}
+
+	void Visit(ArrayAccessExpr* self)override
+	{
+		Collect(self->expr);
+		Collect(self->index);
+	}
+
+	void Visit(FuncAccessExpr* self)override
+	{
+		Collect(self->type);
+		Collect(self->expr);
+		CollectAll(self->arguments);
+	}
+
+	void Visit(PostfixUnaryExpr* self)override
+	{
+		Collect(self->operand);
+	}
+
+	void Visit(PrefixUnaryExpr* self)override
+	{
+		Collect(self->operand);
+	}
+
+	void Visit(BinaryExpr* self)override
+	{
+		Collect(self->left);
+		Collect(self->right);
+	}
+
+	void Visit(IfExpr* self)override
+	{
+		Collect(self->condition);
+		Collect(self->left);
+		Collect(self->right);
+	}
+
+	// Statements
+
+	void Visit(EmptyStat* self)override
+	{
+	}
+
+	void Visit(BlockStat* self)override
+	{
+		CollectAll(self->stats);
+	}
+
+	void Visit(DeclStat* self)override
+	{
+		CollectAll(self->decls);
+	}
+
+	void Visit(ExprStat* self)override
+	{
+		Collect(self->expr);
+	}
+
+	void Visit(LabelStat* self)override
+	{
+		Collect(self->stat);
+	}
+
+	void Visit(DefaultStat* self)override
+	{
+		Collect(self->stat);
+	}
+
+	void Visit(CaseStat* self)override
+	{
+		Collect(self->expr);
+		Collect(self->stat);
+	}
+
+	void Visit(GotoStat* self)override
+	{
+	}
+
+	void Visit(BreakStat* self)override
+	{
+	}
+
+	void Visit(ContinueStat* self)override
+	{
+	}
+
+	void Visit(WhileStat* self)override
+	{
+		Collect(self->varExpr);
+		Collect(self->expr);
+		Collect(self->stat);
+	}
+
+	void Visit(DoWhileStat* self)override
+	{
+		Collect(self->stat);
+		Collect(self->expr);
+	}
+
+	void Visit(ForEachStat* self)override
+	{
+		Collect(self->varDecl);
+		Collect(self->expr);
+		Collect(self->stat);
+	}
+
+	void Visit(ForStat* self)override
+	{
+		CollectAll(self->varDecls);
+		Collect(self->init);
+		Collect(self->expr);
+		Collect(self->effect);
+		Collect(self->stat);
+	}
+
+	void Visit(IfElseStat* self)override
+	{
+		CollectAll(self->varDecls);
+		Collect(self->varExpr);
+		Collect(self->expr);
+		Collect(self->trueStat);
+		Collect(self->falseStat);
+	}
+
+	void Visit(SwitchStat* self)override
+	{
+		Collect(self->varExpr);
+		Collect(self->expr);
+		Collect(self->stat);
+	}
+
+	void Visit(TryCatchStat* self)override
+	{
+		Collect(self->tryStat);
+		Collect(self->exception);
+		Collect(self->catchStat);
+	}
+
+	void Visit(ReturnStat* self)override
+	{
+		Collect(self->expr);
+	}
+
+	void Visit(__Try__ExceptStat* self)override
+	{
+		Collect(self->tryStat);
+		Collect(self->expr);
+		Collect(self->exceptStat);
+	}
+
+	void Visit(__Try__FinallyStat* self)override
+	{
+		Collect(self->tryStat);
+		Collect(self->finallyStat);
+	}
+
+	void Visit(__LeaveStat* self)override
+	{
+	}
+
+	void Visit(__IfExistsStat* self)override
+	{
+		Collect(self->expr);
+		Collect(self->stat);
+	}
+
+	void Visit(__IfNotExistsStat* self)override
+	{
+		Collect(self->expr);
+		Collect(self->stat);
+	}
+};
+
+/***********************************************************************
+AstRangeIndex
+***********************************************************************/
+
+void AstRangeIndex::Build(Ptr<Program> program)
+{
+	items.Clear();
+
+	CollectRangeVisitor visitor;
+	visitor.CollectAll(program->decls);
+	if (visitor.items.Count() == 0) return;
+
+	// sort by start, then put outer items first, then keep the pre-order for items with the same range
+	Array<vint> orders(visitor.items.Count());
+	for (vint i = 0; i < orders.Count(); i++)
+	{
+		orders[i] = i;
+	}
+
+	auto& collected = visitor.items;
+	Sort<vint>(&orders[0], orders.Count(), [&](vint a, vint b)
+	{
+		auto& ia = collected[a];
+		auto& ib = collected[b];
+		if (ia.start != ib.start) return ia.start < ib.start ? -1 : 1;
+		if (ia.end != ib.end)
+		{
+			if (ia.end == -1) return -1;
+			if (ib.end == -1) return 1;
+			return ia.end > ib.end ? -1 : 1;
+		}
+		return a < b ? -1 : a > b ? 1 : 0;
+	});
+
+	List<vint> stack;
+	for (vint i = 0; i < orders.Count(); i++)
+	{
+		auto item = collected[orders[i]];
+		while (stack.Count() > 0 && !Contains(stack[stack.Count() - 1], item.start))
+		{
+			stack.RemoveAt(stack.Count() - 1);
+		}
+		item.parent = stack.Count() > 0 ? stack[stack.Count() - 1] : -1;
+		stack.Add(items.Add(item));
+	}
+}
+
+bool AstRangeIndex::Contains(vint index, vint offset)const
+{
+	auto& item = items[index];
+	return item.start <= offset && (item.end == -1 || offset < item.end);
+}
+
+vint AstRangeIndex::FindInnermost(vint offset)const
+{
+	// find the last item that starts before or at the offset
+	vint start = 0;
+	vint end = items.Count();
+	while (start < end)
+	{
+		vint middle = (start + end) / 2;
+		if (items[middle].start <= offset)
+		{
+			start = middle + 1;
+		}
+		else
+		{
+			end = middle;
+		}
+	}
+
+	vint index = start - 1;
+	while (index != -1 && !Contains(index, offset))
+	{
+		index = items[index].parent;
+	}
+	return index;
+}
\ No newline at end of file
@@ -0,0 +1,42 @@
+#ifndef VCZH_DOCUMENT_CPPDOC_AST_RANGE
+#define VCZH_DOCUMENT_CPPDOC_AST_RANGE
+
+#include "Ast.h"
+
+/***********************************************************************
+AstRangeIndex
+	Ranges of declarations, statements and expressions are either nested or disjoint
+	After sorting by (start, end descending), every item is followed by all items inside it
+	So the innermost item at an offset is an ancestor of the last item starting before the offset
+***********************************************************************/
+
+enum class AstRangeKind
+{
+	Declaration,
+	Stat,
+	Expr,
+};
+
+struct AstRangeItem
+{
+	AstRangeKind			kind = AstRangeKind::Declaration;
+	Object*					node = nullptr;		// Declaration*, Stat* or Expr* according to kind
+	vint					start = -1;
+	vint					end = -1;			// -1 if the node reaches the end of the input
+	vint					parent = -1;		// the index of the innermost item that contains this item, -1 for top level items
+};
+
+class AstRangeIndex : public Object
+{
+public:
+	List<AstRangeItem>		items;				// sorted by start, outer items come before inner items
+
+	// Collect all nodes with recorded ranges in a program, types are visited but not indexed
+	void					Build(Ptr<Program> program);
+	// Test if an item covers an offset
+	bool					Contains(vint index, vint offset)const;
+	// Find the innermost item that covers an offset, returns -1 if nothing covers it
+	vint					FindInnermost(vint offset)const;
+};
+
+#endif
\ No newline at end of file
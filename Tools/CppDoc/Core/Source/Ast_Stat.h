@@ -44,7 +44,7 @@ public:
 #undef CPPDOC_VISIT
 };
 
-#define IStatVisitor_ACCEPT void Accept(IStatVisitor* visitor)override
+#define IStatVisitor_ACCEPT CPPDOC_ALLOCATION_OPERATORS void Accept(IStatVisitor* visitor)override
 
 /***********************************************************************
 Statements
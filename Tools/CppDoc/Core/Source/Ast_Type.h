@@ -34,7 +34,7 @@ public:
 #undef CPPDOC_VISIT
 };
 
-#define ITypeVisitor_ACCEPT void Accept(ITypeVisitor* visitor)override
+#define ITypeVisitor_ACCEPT CPPDOC_ALLOCATION_OPERATORS void Accept(ITypeVisitor* visitor)override
 
 /***********************************************************************
 Preparation
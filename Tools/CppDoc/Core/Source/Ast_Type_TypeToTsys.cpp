@@ -8,6 +8,68 @@
 TypeToTsys
 ***********************************************************************/
 
+// Types are converted in multiple threads when translation units, partitions or documents are parsed concurrently
+static SpinLock functionTypeExpansionLock;
+static FunctionTypeExpansionCounters functionTypeExpansionStatistics;
+
+static void AddFunctionTypeExpansion(vint created, vint dropped)
+{
+	SPIN_LOCK(functionTypeExpansionLock)
+	{
+		functionTypeExpansionStatistics.ambiguousFunctions++;
+		functionTypeExpansionStatistics.createdCombinations += created;
+		functionTypeExpansionStatistics.droppedCombinations += dropped;
+	}
+}
+
+static void AddDeferredFunctionType()
+{
+	SPIN_LOCK(functionTypeExpansionLock)
+	{
+		functionTypeExpansionStatistics.deferredFunctions++;
+	}
+}
+
+// Count all combinations of candidates, saturated to avoid overflow
+static vint CountFunctionTypeCombinations(TypeTsysList* tsyses, vint count)
+{
+	const vint MaxCombinations = (vint)1 << 30;
+	vint combinations = 1;
+	for (vint i = 0; i < count; i++)
+	{
+		vint levelCount = tsyses[i].Count();
+		if (levelCount == 0) return 0;
+		combinations = combinations > MaxCombinations / levelCount ? MaxCombinations : combinations * levelCount;
+	}
+	return combinations;
+}
+
+bool TypeToTsysInternal(ParsingArguments& pa, Ptr<Type> t, TypeTsysList& tsys, TsysCallingConvention cc, bool memberOf);
+
+// Convert the return type and parameter types of a function type, returns false if the result should not be cached
+static bool FunctionTypeToCandidates(ParsingArguments& pa, FunctionType* self, Array<TypeTsysList>& tsyses)
+{
+	bool contextFree = true;
+	if (self->decoratorReturnType)
+	{
+		contextFree &= TypeToTsysInternal(pa, self->decoratorReturnType, tsyses[0], TsysCallingConvention::None, false);
+	}
+	else if (self->returnType)
+	{
+		contextFree &= TypeToTsysInternal(pa, self->returnType, tsyses[0], TsysCallingConvention::None, false);
+	}
+	else
+	{
+		tsyses[0].Add(pa.tsys->PrimitiveOf({ TsysPrimitiveType::Void,TsysBytes::_1 }));
+	}
+
+	for (vint i = 0; i < self->parameters.Count(); i++)
+	{
+		contextFree &= TypeToTsysInternal(pa, self->parameters[i]->type, tsyses[i + 1], TsysCallingConvention::None, false);
+	}
+	return contextFree;
+}
+
 class TypeToTsysVisitor : public Object, public virtual ITypeVisitor
 {
 public:
@@ -16,6 +78,7 @@ public:
 
 	TsysCallingConvention	cc = TsysCallingConvention::None;
 	bool					memberOf = false;
+	bool					contextFree = true;		// false if the result depends on pa, e.g. decltype, or could change later, e.g. a forward declaration is defined
 
 	TypeToTsysVisitor(ParsingArguments& _pa, TypeTsysList& _result, TsysCallingConvention _cc, bool _memberOf)
 		:pa(_pa)
@@ -135,77 +198,70 @@ public:
 		cc = oldCc;
 	}
 
-	void CreateFunctionType(TypeTsysList* tsyses, vint* tsysIndex, vint level, vint count, const TsysFunc& func)
+	void CreateFunctionType(TypeTsysList* tsyses, vint count, const TsysFunc& func)
 	{
-		if (level == count)
+		vint combinations = CountFunctionTypeCombinations(tsyses, count);
+		if (combinations == 0) return;
+
+		// enumerate combinations in the order of candidates, the last parameter changes first
+		Array<vint> tsysIndex(count);
+		Array<ITsys*> params(count - 1);
+		for (vint i = 0; i < count; i++)
 		{
-			Array<ITsys*> params(count - 1);
-			for (vint i = 0; i < count - 1; i++)
-			{
-				params[i] = tsyses[i + 1][tsysIndex[i + 1]];
-			}
-			result.Add(tsyses[0][tsysIndex[0]]->FunctionOf(params, func));
+			tsysIndex[i] = 0;
 		}
-		else
-		{
-			vint levelCount = tsyses[level].Count();
-			for (vint i = 0; i < levelCount; i++)
-			{
-				tsysIndex[level] = i;
-				CreateFunctionType(tsyses, tsysIndex, level + 1, count, func);
-			}
-		}
-	}
 
-	void Visit(FunctionType* self)override
-	{
-		TypeTsysList* tsyses = nullptr;
-		vint* tsysIndex = nullptr;
-		try
+		vint limit = pa.recovery ? pa.recovery->functionTypeExpansionLimit : -1;
+		vint created = 0;
+		while (true)
 		{
-			vint count = self->parameters.Count() + 1;
-			tsyses = new TypeTsysList[count];
-			if (self->decoratorReturnType)
-			{
-				TypeToTsys(pa, self->decoratorReturnType, tsyses[0]);
-			}
-			else if (self->returnType)
-			{
-				TypeToTsys(pa, self->returnType, tsyses[0]);
-			}
-			else
+			if (created == limit)
 			{
-				tsyses[0].Add(pa.tsys->PrimitiveOf({ TsysPrimitiveType::Void,TsysBytes::_1 }));
+				// a truncated result depends on the limit in pa, and every use of it must report the truncation
+				pa.recovery->DropFunctionTypes(combinations - created);
+				contextFree = false;
+				break;
 			}
 
-			for (vint i = 0; i < self->parameters.Count(); i++)
+			for (vint i = 0; i < count - 1; i++)
 			{
-				TypeToTsys(pa, self->parameters[i]->type, tsyses[i + 1]);
+				params[i] = tsyses[i + 1][tsysIndex[i + 1]];
 			}
+			result.Add(tsyses[0][tsysIndex[0]]->FunctionOf(params, func));
+			created++;
 
-			tsysIndex = new vint[count];
-			memset(tsysIndex, 0, sizeof(vint) * count);
-
-			TsysFunc func(cc, self->ellipsis);
-			if (func.callingConvention == TsysCallingConvention::None)
+			vint level = count - 1;
+			while (level >= 0)
 			{
-				func.callingConvention =
-					memberOf && !func.ellipsis
-					? TsysCallingConvention::ThisCall
-					: TsysCallingConvention::CDecl
-					;
+				if (++tsysIndex[level] < tsyses[level].Count()) break;
+				tsysIndex[level] = 0;
+				level--;
 			}
-			CreateFunctionType(tsyses, tsysIndex, 0, count, func);
+			if (level < 0) break;
+		}
 
-			delete[] tsyses;
-			delete[] tsysIndex;
+		if (combinations > 1)
+		{
+			AddFunctionTypeExpansion(created, combinations - created);
 		}
-		catch (...)
+	}
+
+	void Visit(FunctionType* self)override
+	{
+		vint count = self->parameters.Count() + 1;
+		Array<TypeTsysList> tsyses(count);
+		contextFree &= FunctionTypeToCandidates(pa, self, tsyses);
+
+		TsysFunc func(cc, self->ellipsis);
+		if (func.callingConvention == TsysCallingConvention::None)
 		{
-			delete[] tsyses;
-			delete[] tsysIndex;
-			throw;
+			func.callingConvention =
+				memberOf && !func.ellipsis
+				? TsysCallingConvention::ThisCall
+				: TsysCallingConvention::CDecl
+				;
 		}
+		CreateFunctionType(&tsyses[0], count, func);
 	}
 
 	void Visit(MemberType* self)override
@@ -214,8 +270,8 @@ public:
 		memberOf = true;
 
 		TypeTsysList types, classTypes;
-		TypeToTsys(pa, self->type, types, cc, memberOf);
-		TypeToTsys(pa, self->classType, classTypes);
+		contextFree &= TypeToTsysInternal(pa, self->type, types, cc, memberOf);
+		contextFree &= TypeToTsysInternal(pa, self->classType, classTypes, TsysCallingConvention::None, false);
 
 		for (vint i = 0; i < types.Count(); i++)
 		{
@@ -230,6 +286,7 @@ public:
 
 	void Visit(DeclType* self)override
 	{
+		contextFree = false;
 		if (self->expr)
 		{
 			ExprTsysList types;
@@ -271,6 +328,12 @@ public:
 		}
 		resolving->Calibrate();
 
+		// a forward declaration could be defined later, then the result changes
+		if (!resolving->IsFullyCalibrated())
+		{
+			contextFree = false;
+		}
+
 		for (vint i = 0; i < resolving->resolvedSymbols.Count(); i++)
 		{
 			auto symbol = resolving->resolvedSymbols[i];
@@ -299,10 +362,73 @@ public:
 	}
 };
 
-// Convert type AST to type system object
-void TypeToTsys(ParsingArguments& pa, Ptr<Type> t, TypeTsysList& tsys, TsysCallingConvention cc, bool memberOf)
+// Convert type AST to type system object, returns false if the result should not be cached
+bool TypeToTsysInternal(ParsingArguments& pa, Ptr<Type> t, TypeTsysList& tsys, TsysCallingConvention cc, bool memberOf)
 {
 	if (!t) throw NotConvertableException();
-	TypeToTsysVisitor visitor(pa, tsys, cc, memberOf);
+
+	vint key = (vint)cc * 2 + (memberOf ? 1 : 0);
+	auto cache = t->tsysCache.Obj();
+	if (TypeToTsysCacheEnabled && cache && cache->owner == pa.tsys.Obj() && cache->version == pa.tsys->GetVersion())
+	{
+		vint index = cache->results.Keys().IndexOf(key);
+		if (index != -1)
+		{
+			CopyFrom(tsys, *cache->results.Values()[index].Obj(), true);
+			return true;
+		}
+	}
+
+	auto types = MakePtr<TypeTsysList>();
+	TypeToTsysVisitor visitor(pa, *types.Obj(), cc, memberOf);
 	t->Accept(&visitor);
+	CopyFrom(tsys, *types.Obj(), true);
+
+	if (TypeToTsysCacheEnabled && visitor.contextFree)
+	{
+		if (!t->tsysCache)
+		{
+			t->tsysCache = MakePtr<TypeTsysCache>();
+		}
+		cache = t->tsysCache.Obj();
+		if (cache->owner != pa.tsys.Obj() || cache->version != pa.tsys->GetVersion())
+		{
+			cache->owner = pa.tsys.Obj();
+			cache->version = pa.tsys->GetVersion();
+			cache->results.Clear();
+		}
+		cache->results.Set(key, types);
+	}
+	return visitor.contextFree;
+}
+
+// Set to false to always convert type AST from scratch
+bool TypeToTsysCacheEnabled = true;
+
+// Convert the return type and parameter types of a function type, function types of combinations are not created
+vint TypeToFunctionTypeCandidates(ParsingArguments& pa, Ptr<FunctionType> t, Array<TypeTsysList>& candidates)
+{
+	FunctionTypeToCandidates(pa, t.Obj(), candidates);
+	vint combinations = CountFunctionTypeCombinations(&candidates[0], candidates.Count());
+	if (combinations > 1)
+	{
+		AddDeferredFunctionType();
+	}
+	return combinations;
+}
+
+FunctionTypeExpansionCounters GetFunctionTypeExpansionStatistics()
+{
+	FunctionTypeExpansionCounters counters;
+	SPIN_LOCK(functionTypeExpansionLock)
+	{
+		counters = functionTypeExpansionStatistics;
+	}
+	return counters;
+}
+
+// Convert type AST to type system object
+void TypeToTsys(ParsingArguments& pa, Ptr<Type> t, TypeTsysList& tsys, TsysCallingConvention cc, bool memberOf)
+{
+	TypeToTsysInternal(pa, t, tsys, cc, memberOf);
 }
\ No newline at end of file
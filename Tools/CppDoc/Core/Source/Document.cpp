@@ -0,0 +1,636 @@
+#include "Document.h"
+#include "Ast_Decl.h"
+#include "Scheduler.h"
+
+/***********************************************************************
+Helpers
+***********************************************************************/
+
+static bool IsDocumentSpace(wchar_t c)
+{
+	return c == L' ' || c == L'\t';
+}
+
+static bool IsNameHead(wchar_t c)
+{
+	return (L'a' <= c && c <= L'z') || (L'A' <= c && c <= L'Z') || c == L'_';
+}
+
+static bool IsNameBody(wchar_t c)
+{
+	return IsNameHead(c) || (L'0' <= c && c <= L'9');
+}
+
+static bool IsXmlNameBody(wchar_t c)
+{
+	return IsNameBody(c) || c == L'-' || c == L':' || c == L'.';
+}
+
+static bool IsSameText(const wchar_t* a, vint aLength, const wchar_t* b, vint bLength)
+{
+	return aLength == bLength && wcsncmp(a, b, aLength) == 0;
+}
+
+// <NAME { ATTRIBUTE = "VALUE" ...} [/]> or </NAME>, returns the index after > or -1 if it is not a tag
+// attribute is called with indices of each attribute name and value
+template<typename TCallback>
+static vint ScanTag(const wchar_t* line, vint count, vint i, bool& endTag, vint& name, vint& nameLength, bool& selfClosing, TCallback&& attribute)
+{
+	i++;
+	endTag = i < count && line[i] == L'/';
+	if (endTag) i++;
+
+	name = i;
+	if (i == count || !IsNameHead(line[i])) return -1;
+	while (i < count && IsXmlNameBody(line[i])) i++;
+	nameLength = i - name;
+
+	while (true)
+	{
+		vint spaces = i;
+		while (i < count && IsDocumentSpace(line[i])) i++;
+		if (i == count) return -1;
+
+		if (line[i] == L'>')
+		{
+			selfClosing = false;
+			return i + 1;
+		}
+		if (line[i] == L'/' && !endTag)
+		{
+			selfClosing = true;
+			return i + 1 < count && line[i + 1] == L'>' ? i + 2 : -1;
+		}
+
+		// an attribute is separated from the previous one by spaces
+		if (endTag || spaces == i || !IsNameHead(line[i])) return -1;
+		vint attributeName = i;
+		while (i < count && IsXmlNameBody(line[i])) i++;
+		vint attributeNameLength = i - attributeName;
+
+		while (i < count && IsDocumentSpace(line[i])) i++;
+		if (i == count || line[i] != L'=') return -1;
+		i++;
+		while (i < count && IsDocumentSpace(line[i])) i++;
+		if (i == count || (line[i] != L'"' && line[i] != L'\'')) return -1;
+
+		auto quote = line[i++];
+		vint value = i;
+		while (i < count && line[i] != quote) i++;
+		if (i == count) return -1;
+		attribute(attributeName, attributeNameLength, value, i - value);
+		i++;
+	}
+}
+
+/***********************************************************************
+DocumentParser
+***********************************************************************/
+
+enum class DocumentFrameKind
+{
+	BlockElement,
+	ListItem,
+	Paragraph,
+	InlineElement,
+	Strong,
+	Emphasis,
+};
+
+// an open construct, reading is the name of an element
+struct DocumentFrame
+{
+	DocumentFrameKind		kind = DocumentFrameKind::Paragraph;
+	const wchar_t*			reading = nullptr;
+	vint					start = -1;
+	vint					length = 0;
+};
+
+class DocumentParser : public Object
+{
+public:
+	List<DocumentEvent>&	events;
+	List<DocumentFrame>		frames;				// frames of block elements, list items, paragraphs, and inline frames from outer to inner
+	bool					codeBlock = false;
+	vint					codeIndentation = 0;	// spaces before the opening fence, removed from lines in the code block
+
+	DocumentParser(List<DocumentEvent>& _events)
+		:events(_events)
+	{
+	}
+
+	DocumentEvent& Add(DocumentEventKind kind, const wchar_t* reading = nullptr, vint start = -1, vint length = 0)
+	{
+		DocumentEvent e;
+		e.kind = kind;
+		e.reading = reading;
+		e.start = start;
+		e.length = length;
+		events.Add(e);
+		return events[events.Count() - 1];
+	}
+
+	bool IsTop(DocumentFrameKind kind)
+	{
+		return frames.Count() > 0 && frames[frames.Count() - 1].kind == kind;
+	}
+
+	void Push(DocumentFrameKind kind, DocumentEventKind eventKind, const wchar_t* reading = nullptr, vint start = -1, vint length = 0)
+	{
+		DocumentFrame frame;
+		frame.kind = kind;
+		frame.reading = reading;
+		frame.start = start;
+		frame.length = length;
+		frames.Add(frame);
+		Add(eventKind, reading, start, length);
+	}
+
+	void Pop()
+	{
+		auto frame = frames[frames.Count() - 1];
+		frames.RemoveAt(frames.Count() - 1);
+		switch (frame.kind)
+		{
+		case DocumentFrameKind::BlockElement:
+		case DocumentFrameKind::InlineElement:
+			Add(DocumentEventKind::ElementEnd, frame.reading, frame.start, frame.length);
+			break;
+		case DocumentFrameKind::ListItem:
+			Add(DocumentEventKind::ListItemEnd);
+			break;
+		case DocumentFrameKind::Paragraph:
+			Add(DocumentEventKind::ParagraphEnd);
+			break;
+		case DocumentFrameKind::Strong:
+			Add(DocumentEventKind::StrongEnd);
+			break;
+		case DocumentFrameKind::Emphasis:
+			Add(DocumentEventKind::EmphasisEnd);
+			break;
+		}
+	}
+
+	// Close the paragraph and everything in it, a list item is kept
+	void CloseParagraph()
+	{
+		while (frames.Count() > 0)
+		{
+			auto kind = frames[frames.Count() - 1].kind;
+			if (kind == DocumentFrameKind::BlockElement || kind == DocumentFrameKind::ListItem) break;
+			Pop();
+			if (kind == DocumentFrameKind::Paragraph) break;
+		}
+	}
+
+	void CloseListItem()
+	{
+		CloseParagraph();
+		if (IsTop(DocumentFrameKind::ListItem)) Pop();
+	}
+
+	// Inline content is in a paragraph unless it is in a list item
+	void EnsureParagraph()
+	{
+		if (frames.Count() == 0 || IsTop(DocumentFrameKind::BlockElement))
+		{
+			Push(DocumentFrameKind::Paragraph, DocumentEventKind::ParagraphBegin);
+		}
+	}
+
+	// Find the innermost inline frame of a kind in the current paragraph or list item
+	vint FindInline(DocumentFrameKind kind)
+	{
+		for (vint i = frames.Count() - 1; i >= 0; i--)
+		{
+			auto frameKind = frames[i].kind;
+			if (frameKind == kind) return i;
+			if (frameKind == DocumentFrameKind::BlockElement || frameKind == DocumentFrameKind::ListItem || frameKind == DocumentFrameKind::Paragraph) break;
+		}
+		return -1;
+	}
+
+	vint FindElement(const wchar_t* name, vint length)
+	{
+		for (vint i = frames.Count() - 1; i >= 0; i--)
+		{
+			auto& frame = frames[i];
+			if (frame.kind == DocumentFrameKind::BlockElement || frame.kind == DocumentFrameKind::InlineElement)
+			{
+				if (IsSameText(frame.reading, frame.length, name, length)) return i;
+			}
+		}
+		return -1;
+	}
+
+	void PopTo(vint index)
+	{
+		while (frames.Count() > index)
+		{
+			Pop();
+		}
+	}
+
+	// ** or * is text if it could not start or end here
+	void Toggle(DocumentFrameKind kind, DocumentEventKind eventKind, const wchar_t* line, vint count, vint lineStart, vint i, vint markLength, vint& text)
+	{
+		vint index = FindInline(kind);
+		if (index != -1)
+		{
+			if (i == 0 || IsDocumentSpace(line[i - 1])) return;
+			AddText(line, lineStart, text, i);
+			PopTo(index);
+		}
+		else
+		{
+			if (i + markLength == count || IsDocumentSpace(line[i + markLength])) return;
+			AddText(line, lineStart, text, i);
+			EnsureParagraph();
+			Push(kind, eventKind);
+		}
+		text = i + markLength;
+	}
+
+	// Returns the index after the tag, or -1 if it is not a tag or the end tag does not match any open element
+	vint ParseTag(const wchar_t* line, vint count, vint lineStart, vint i, bool block, vint& text)
+	{
+		bool endTag = false;
+		bool selfClosing = false;
+		vint name = -1;
+		vint nameLength = 0;
+		vint end = ScanTag(line, count, i, endTag, name, nameLength, selfClosing, [](vint, vint, vint, vint) {});
+		if (end == -1) return -1;
+
+		vint element = -1;
+		if (endTag)
+		{
+			element = FindElement(line + name, nameLength);
+			if (element == -1) return -1;
+		}
+
+		AddText(line, lineStart, text, i);
+		text = end;
+		if (endTag)
+		{
+			PopTo(element);
+			return end;
+		}
+
+		if (block)
+		{
+			CloseListItem();
+		}
+		else
+		{
+			EnsureParagraph();
+		}
+
+		Add(DocumentEventKind::ElementBegin, line + name, lineStart + name, nameLength);
+		ScanTag(line, count, i, endTag, name, nameLength, selfClosing, [&](vint attributeName, vint attributeNameLength, vint value, vint valueLength)
+		{
+			auto& e = Add(DocumentEventKind::Attribute, line + attributeName, lineStart + attributeName, attributeNameLength);
+			e.value = line + value;
+			e.valueLength = valueLength;
+		});
+
+		if (selfClosing)
+		{
+			Add(DocumentEventKind::ElementEnd, line + name, lineStart + name, nameLength);
+		}
+		else
+		{
+			DocumentFrame frame;
+			frame.kind = block ? DocumentFrameKind::BlockElement : DocumentFrameKind::InlineElement;
+			frame.reading = line + name;
+			frame.start = lineStart + name;
+			frame.length = nameLength;
+			frames.Add(frame);
+		}
+		return end;
+	}
+
+	void AddText(const wchar_t* line, vint lineStart, vint start, vint end)
+	{
+		if (start < end)
+		{
+			EnsureParagraph();
+			Add(DocumentEventKind::Text, line + start, lineStart + start, end - start);
+		}
+	}
+
+	void ParseInline(const wchar_t* line, vint count, vint lineStart, vint i, bool block)
+	{
+		// text from this index to the current character is not added yet
+		vint first = i;
+		vint text = i;
+		while (i < count)
+		{
+			switch (line[i])
+			{
+			case L'<':
+				{
+					vint end = ParseTag(line, count, lineStart, i, block && i == first, text);
+					if (end != -1)
+					{
+						i = end;
+						continue;
+					}
+				}
+				break;
+			case L'`':
+				{
+					vint end = i + 1;
+					while (end < count && line[end] != L'`') end++;
+					if (end < count)
+					{
+						AddText(line, lineStart, text, i);
+						EnsureParagraph();
+						Add(DocumentEventKind::Code, line + i + 1, lineStart + i + 1, end - i - 1);
+						i = end + 1;
+						text = i;
+						continue;
+					}
+				}
+				break;
+			case L'*':
+				{
+					bool strong = i + 1 < count && line[i + 1] == L'*';
+					vint markLength = strong ? 2 : 1;
+					if (strong)
+					{
+						Toggle(DocumentFrameKind::Strong, DocumentEventKind::StrongBegin, line, count, lineStart, i, markLength, text);
+					}
+					else
+					{
+						Toggle(DocumentFrameKind::Emphasis, DocumentEventKind::EmphasisBegin, line, count, lineStart, i, markLength, text);
+					}
+					i += markLength;
+					continue;
+				}
+			}
+			i++;
+		}
+		AddText(line, lineStart, text, count);
+	}
+
+	void ParseLine(const RegexToken& token)
+	{
+		// skip ///
+		auto line = token.reading + 3;
+		vint count = token.length - 3;
+		vint lineStart = token.start + 3;
+
+		vint i = 0;
+		while (i < count && IsDocumentSpace(line[i])) i++;
+		bool fence = count - i >= 3 && wcsncmp(line + i, L"```", 3) == 0;
+
+		if (codeBlock)
+		{
+			if (fence)
+			{
+				codeBlock = false;
+				Add(DocumentEventKind::CodeBlockEnd);
+			}
+			else
+			{
+				vint indentation = i < codeIndentation ? i : codeIndentation;
+				Add(DocumentEventKind::Text, line + indentation, lineStart + indentation, count - indentation);
+			}
+			return;
+		}
+
+		if (i == count)
+		{
+			CloseListItem();
+		}
+		else if (fence)
+		{
+			CloseListItem();
+			codeBlock = true;
+			codeIndentation = i;
+			vint info = i + 3;
+			while (info < count && IsDocumentSpace(line[info])) info++;
+			auto& e = Add(DocumentEventKind::CodeBlockBegin);
+			e.value = line + info;
+			e.valueLength = count - info;
+		}
+		else if ((line[i] == L'-' || line[i] == L'*') && i + 1 < count && IsDocumentSpace(line[i + 1]))
+		{
+			CloseListItem();
+			Push(DocumentFrameKind::ListItem, DocumentEventKind::ListItemBegin);
+			i += 2;
+			while (i < count && IsDocumentSpace(line[i])) i++;
+			ParseInline(line, count, lineStart, i, false);
+		}
+		else
+		{
+			ParseInline(line, count, lineStart, i, true);
+		}
+	}
+
+	void Finish()
+	{
+		if (codeBlock)
+		{
+			codeBlock = false;
+			Add(DocumentEventKind::CodeBlockEnd);
+		}
+		PopTo(0);
+	}
+};
+
+void ParseDocument(const List<RegexToken>& documents, const CppDocumentRange& range, List<DocumentEvent>& events)
+{
+	DocumentParser parser(events);
+	for (vint i = 0; i < range.count; i++)
+	{
+		parser.ParseLine(documents[range.start + i]);
+	}
+	parser.Finish();
+}
+
+/***********************************************************************
+CollectDocuments
+***********************************************************************/
+
+static void CollectDocument(Ptr<Declaration> decl, Symbol* scope, List<Ptr<DeclarationDocument>>& documents);
+
+static void CollectDocuments(List<Ptr<Declaration>>& decls, Symbol* scope, List<Ptr<DeclarationDocument>>& documents)
+{
+	for (vint i = 0; i < decls.Count(); i++)
+	{
+		CollectDocument(decls[i], scope, documents);
+	}
+}
+
+static void CollectDocument(Ptr<Declaration> decl, Symbol* scope, List<Ptr<DeclarationDocument>>& documents)
+{
+	// names in a namespace or a class are resolved from itself
+	Symbol* childScope = nullptr;
+	if (auto nsDecl = decl.Cast<NamespaceDeclaration>())
+	{
+		// a reopened namespace does not have a symbol
+		vint index = scope->children.Keys().IndexOf(nsDecl->name.name);
+		if (index != -1)
+		{
+			childScope = scope->children.GetByIndex(index)[0].Obj();
+		}
+	}
+	else if (auto classDecl = decl.Cast<ClassDeclaration>())
+	{
+		childScope = classDecl->symbol;
+	}
+
+	if (decl->document.count > 0)
+	{
+		auto document = MakePtr<DeclarationDocument>();
+		document->decl = decl.Obj();
+		document->scope = childScope ? childScope : scope;
+		documents.Add(document);
+	}
+
+	if (!childScope) return;
+	if (auto nsDecl = decl.Cast<NamespaceDeclaration>())
+	{
+		CollectDocuments(nsDecl->decls, childScope, documents);
+	}
+	else if (auto classDecl = decl.Cast<ClassDeclaration>())
+	{
+		for (vint i = 0; i < classDecl->decls.Count(); i++)
+		{
+			CollectDocument(classDecl->decls[i].f1, childScope, documents);
+		}
+	}
+}
+
+void CollectDocuments(const ParsingArguments& pa, Ptr<Program> program, List<Ptr<DeclarationDocument>>& documents)
+{
+	CollectDocuments(program->decls, pa.root.Obj(), documents);
+}
+
+/***********************************************************************
+ParseDocuments
+***********************************************************************/
+
+void ParseDocuments(const List<RegexToken>& tokens, List<Ptr<DeclarationDocument>>& documents, vint threadCount)
+{
+	CPPDOC_TRACE_SCOPE(L"ParseDocuments");
+
+	// documents are short, each task parses a few of them
+	const vint DocumentsPerTask = 64;
+	WorkStealingScheduler scheduler(threadCount);
+	for (vint i = 0; i < documents.Count(); i += DocumentsPerTask)
+	{
+		scheduler.Queue(i / DocumentsPerTask, [&, i](vint)
+		{
+			for (vint j = i; j < documents.Count() && j < i + DocumentsPerTask; j++)
+			{
+				auto document = documents[j];
+				ParseDocument(tokens, document->decl->document, document->events);
+			}
+		});
+	}
+	scheduler.Run();
+}
+
+/***********************************************************************
+ResolveDocuments
+***********************************************************************/
+
+Ptr<Resolving> DocumentReferenceCache::Resolve(const ParsingArguments& pa, Symbol* scope, const WString& name)
+{
+	Key key(scope, name);
+	vint index = results.Keys().IndexOf(key);
+	if (index != -1)
+	{
+		return results.Values()[index];
+	}
+
+	// names are not indexed or recorded
+	ParsingArguments rootPa(pa.root, pa.tsys, nullptr);
+	Ptr<Resolving> resolving;
+	auto reading = name.Buffer();
+	vint count = name.Length();
+	vint i = 0;
+	while (i < count && IsDocumentSpace(reading[i])) i++;
+
+	bool global = count - i >= 2 && reading[i] == L':' && reading[i + 1] == L':';
+	if (global) i += 2;
+
+	try
+	{
+		while (true)
+		{
+			while (i < count && IsDocumentSpace(reading[i])) i++;
+			vint start = i;
+			if (i == count || !IsNameHead(reading[i]))
+			{
+				resolving = nullptr;
+				break;
+			}
+			while (i < count && IsNameBody(reading[i])) i++;
+
+			CppName cppName;
+			cppName.tokenCount = 1;
+			cppName.name = name.Sub(start, i - start);
+
+			// the first name is searched from the scope, others are children of previous symbols
+			ResolveSymbolResult result;
+			if (!resolving)
+			{
+				ParsingArguments spa(rootPa, global ? pa.root.Obj() : scope);
+				result = ResolveSymbol(spa, cppName, global ? SearchPolicy::ChildSymbol : SearchPolicy::SymbolAccessableInScope);
+			}
+			else
+			{
+				for (vint j = 0; j < resolving->resolvedSymbols.Count(); j++)
+				{
+					ParsingArguments spa(rootPa, resolving->resolvedSymbols[j]);
+					result.Merge(ResolveSymbol(spa, cppName, SearchPolicy::ChildSymbol));
+				}
+			}
+
+			resolving = nullptr;
+			result.Merge(resolving, result.types);
+			result.Merge(resolving, result.values);
+			if (!resolving) break;
+
+			while (i < count && IsDocumentSpace(reading[i])) i++;
+			if (i == count) break;
+			if (count - i < 2 || reading[i] != L':' || reading[i + 1] != L':')
+			{
+				resolving = nullptr;
+				break;
+			}
+			i += 2;
+		}
+	}
+	catch (const NotConvertableException&)
+	{
+		resolving = nullptr;
+	}
+	catch (const IllegalExprException&)
+	{
+		resolving = nullptr;
+	}
+
+	results.Add(key, resolving);
+	return resolving;
+}
+
+void ResolveDocuments(const ParsingArguments& pa, List<Ptr<DeclarationDocument>>& documents, DocumentReferenceCache& cache)
+{
+	CPPDOC_TRACE_SCOPE(L"ResolveDocuments");
+	for (vint i = 0; i < documents.Count(); i++)
+	{
+		auto document = documents[i];
+		for (vint j = 0; j < document->events.Count(); j++)
+		{
+			auto& e = document->events[j];
+			if (e.kind == DocumentEventKind::Attribute && IsSameText(e.reading, e.length, L"cref", 4))
+			{
+				e.resolving = cache.Resolve(pa, document->scope, WString(e.value, e.valueLength));
+			}
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,80 @@
+#ifndef VCZH_DOCUMENT_CPPDOC_DOCUMENT
+#define VCZH_DOCUMENT_CPPDOC_DOCUMENT
+
+#include "Parser.h"
+
+/***********************************************************************
+Document
+	/// comments before a declaration are XML, text in elements is Markdown
+	A document is parsed in one pass to a flat list of events, text is not copied, every event points to the input
+	Events are always nested, unclosed elements are closed at the end of the document, unmatched tags are text
+	An element is a block if its start tag begins a line, otherwise it is inline and in a paragraph or a list item
+	Markdown:
+		a blank line ends a paragraph or a list item
+		- or * followed by a space at the beginning of a line starts a list item
+		``` at the beginning of a line starts or ends a code block, lines in between are Text without parsing
+		`CODE` is Code, **TEXT** is Strong, *TEXT* is Emphasis, they do not cross lines except Strong and Emphasis
+	Text never crosses lines, consecutive Text events in different lines are separated by a line break
+	Entities like &lt; are not decoded
+***********************************************************************/
+
+enum class DocumentEventKind
+{
+	ElementBegin,			// <NAME ...>, reading is NAME
+	Attribute,				// NAME="VALUE" in the last ElementBegin, reading is NAME, value is VALUE
+	ElementEnd,				// </NAME> or the end of <NAME .../>, reading is NAME
+	ParagraphBegin,
+	ParagraphEnd,
+	ListItemBegin,
+	ListItemEnd,
+	CodeBlockBegin,			// ```INFO, value is INFO
+	CodeBlockEnd,
+	StrongBegin,
+	StrongEnd,
+	EmphasisBegin,
+	EmphasisEnd,
+	Code,					// `CODE`, reading is CODE
+	Text,
+};
+
+struct DocumentEvent
+{
+	DocumentEventKind		kind = DocumentEventKind::Text;
+	const wchar_t*			reading = nullptr;
+	vint					start = -1;			// offset of reading in the input
+	vint					length = 0;
+	const wchar_t*			value = nullptr;
+	vint					valueLength = 0;
+	Ptr<Resolving>			resolving;			// symbols referred by a cref attribute, nullptr if it is not resolved
+};
+
+// documents of a declaration
+class DeclarationDocument : public Object
+{
+public:
+	Declaration*			decl = nullptr;
+	Symbol*					scope = nullptr;	// where names in cref attributes are resolved, a class or a namespace resolves from itself
+	List<DocumentEvent>		events;
+};
+
+// cref attributes resolved in each scope, shared by all documents in a program
+class DocumentReferenceCache : public Object
+{
+	using Key = Tuple<Symbol*, WString>;
+public:
+	Dictionary<Key, Ptr<Resolving>>	results;		// (scope, cref) -> symbols, nullptr if nothing is found
+
+	// Resolve NAME { :: NAME ...} or :: NAME { :: NAME ...} from a scope, returns nullptr for anything else
+	Ptr<Resolving>			Resolve(const ParsingArguments& pa, Symbol* scope, const WString& name);
+};
+
+// Parse consecutive DOCUMENT tokens
+extern void					ParseDocument(const List<RegexToken>& documents, const CppDocumentRange& range, List<DocumentEvent>& events);
+// Collect declarations with documents in namespaces and classes, a parent is collected before its children
+extern void					CollectDocuments(const ParsingArguments& pa, Ptr<Program> program, List<Ptr<DeclarationDocument>>& documents);
+// Parse documents of all declarations concurrently, use the number of processors when threadCount is 0
+extern void					ParseDocuments(const List<RegexToken>& tokens, List<Ptr<DeclarationDocument>>& documents, vint threadCount = 0);
+// Resolve cref attributes in parsed documents, symbols are not thread safe so this is not concurrent
+extern void					ResolveDocuments(const ParsingArguments& pa, List<Ptr<DeclarationDocument>>& documents, DocumentReferenceCache& cache);
+
+#endif
\ No newline at end of file
@@ -6,6 +6,15 @@
 #include "Ast.h"
 #include "Ast_Type.h"
 #include "Ast_Decl.h"
+#include "Ast_Range.h"
 #include "Parser.h"
+#include "ParallelParser.h"
+#include "Document.h"
+#include "IndexFile.h"
+#include "PrefixSnapshot.h"
+#include "Scheduler.h"
+#include "Statistics.h"
+#include "Allocations.h"
+#include "Trace.h"
 
 #endif
\ No newline at end of file
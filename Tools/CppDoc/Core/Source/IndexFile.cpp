@@ -0,0 +1,743 @@
+#include "IndexFile.h"
+#include "Ast_Type.h"
+#include "Ast_Decl.h"
+
+using namespace vl::stream;
+
+/***********************************************************************
+IndexFile
+***********************************************************************/
+
+IndexFile::IndexFile(const void* _buffer, vint _size, void* _mapping)
+	:buffer(reinterpret_cast<const vuint8_t*>(_buffer))
+	, size(_size)
+	, mapping(_mapping)
+{
+}
+
+IndexFile::~IndexFile()
+{
+	if (mapping)
+	{
+		UnmapBigFile(buffer, mapping);
+	}
+}
+
+template<typename T>
+static bool IsValidSection(const IndexFileSection& section, vint size)
+{
+	if (section.offset < 0 || section.count < 0) return false;
+	if (section.offset % (vint32_t)sizeof(vint32_t) != 0) return false;
+	return (vint64_t)section.offset + (vint64_t)section.count * (vint64_t)sizeof(T) <= (vint64_t)size;
+}
+
+static bool IsValidIndex(vint32_t index, const IndexFileSection& section)
+{
+	return 0 <= index && index < section.count;
+}
+
+static bool IsValidRange(vint32_t first, vint32_t count, const IndexFileSection& section)
+{
+	return first >= 0 && count >= 0 && (vint64_t)first + (vint64_t)count <= (vint64_t)section.count;
+}
+
+template<typename T>
+static const T* GetValidSection(const void* buffer, const IndexFileSection& section)
+{
+	return reinterpret_cast<const T*>(reinterpret_cast<const vuint8_t*>(buffer) + section.offset);
+}
+
+static bool IsValidIndexFile(const void* buffer, vint size)
+{
+	if (!buffer || size < (vint)sizeof(IndexFileHeader)) return false;
+
+	auto& header = *reinterpret_cast<const IndexFileHeader*>(buffer);
+	if (memcmp(header.magic, CPPDOC_INDEX_FILE_MAGIC, sizeof(header.magic)) != 0) return false;
+	if (header.version != CPPDOC_INDEX_FILE_VERSION) return false;
+	if (header.charSize != (vint32_t)sizeof(wchar_t)) return false;
+	if (header.fileSize != size) return false;
+
+	if (!IsValidSection<vint32_t>(header.files, size)) return false;
+	if (!IsValidSection<IndexFileSymbol>(header.symbols, size)) return false;
+	if (!IsValidSection<IndexFileDeclaration>(header.declarations, size)) return false;
+	if (!IsValidSection<IndexFileReference>(header.references, size)) return false;
+	if (!IsValidSection<vint32_t>(header.positions, size)) return false;
+	if (header.positions.count != header.references.count) return false;
+	if (!IsValidSection<IndexFileString>(header.strings, size)) return false;
+	if (!IsValidSection<wchar_t>(header.chars, size)) return false;
+
+	// every field that indexes another section is checked here, so that queries never read out of the buffer
+	auto chars = GetValidSection<wchar_t>(buffer, header.chars);
+	auto strings = GetValidSection<IndexFileString>(buffer, header.strings);
+	for (vint i = 0; i < header.strings.count; i++)
+	{
+		auto& string = strings[i];
+		if (!IsValidRange(string.offset, string.length, header.chars)) return false;
+		if (!IsValidIndex(string.offset + string.length, header.chars)) return false;
+		if (chars[string.offset + string.length] != 0) return false;
+	}
+
+	auto files = GetValidSection<vint32_t>(buffer, header.files);
+	for (vint i = 0; i < header.files.count; i++)
+	{
+		if (!IsValidIndex(files[i], header.strings)) return false;
+	}
+
+	// the root is always the first symbol, a parent is always written before its children
+	if (header.symbols.count == 0) return false;
+	auto symbols = GetValidSection<IndexFileSymbol>(buffer, header.symbols);
+	for (vint i = 0; i < header.symbols.count; i++)
+	{
+		auto& symbol = symbols[i];
+		if (i == 0 ? symbol.parent != -1 : (symbol.parent < 0 || symbol.parent >= i)) return false;
+		if (!IsValidIndex(symbol.name, header.strings)) return false;
+		if (symbol.signature != -1 && !IsValidIndex(symbol.signature, header.strings)) return false;
+		if (symbol.kind < IndexSymbolKind::Root || symbol.kind > IndexSymbolKind::Other) return false;
+		if (symbol.forwardRoot != -1 && !IsValidIndex(symbol.forwardRoot, header.symbols)) return false;
+		if (!IsValidRange(symbol.firstChild, symbol.childCount, header.symbols)) return false;
+		if (!IsValidRange(symbol.firstDeclaration, symbol.declarationCount, header.declarations)) return false;
+		if (!IsValidRange(symbol.firstReference, symbol.referenceCount, header.references)) return false;
+	}
+
+	auto declarations = GetValidSection<IndexFileDeclaration>(buffer, header.declarations);
+	for (vint i = 0; i < header.declarations.count; i++)
+	{
+		auto& decl = declarations[i];
+		if (!IsValidIndex(decl.symbol, header.symbols)) return false;
+		if (!IsValidIndex(decl.file, header.files)) return false;
+	}
+
+	auto references = GetValidSection<IndexFileReference>(buffer, header.references);
+	for (vint i = 0; i < header.references.count; i++)
+	{
+		auto& reference = references[i];
+		if (!IsValidIndex(reference.symbol, header.symbols)) return false;
+		if (!IsValidIndex(reference.file, header.files)) return false;
+	}
+
+	auto positions = GetValidSection<vint32_t>(buffer, header.positions);
+	for (vint i = 0; i < header.positions.count; i++)
+	{
+		if (!IsValidIndex(positions[i], header.references)) return false;
+	}
+	return true;
+}
+
+Ptr<IndexFile> IndexFile::Load(const void* _buffer, vint _size)
+{
+	if (!IsValidIndexFile(_buffer, _size)) return nullptr;
+	return new IndexFile(_buffer, _size, nullptr);
+}
+
+Ptr<IndexFile> IndexFile::Open(const FilePath& filePath)
+{
+	vint size = 0;
+	void* mapping = nullptr;
+	auto buffer = MapBigFile(filePath, size, mapping);
+	if (!buffer) return nullptr;
+
+	if (!IsValidIndexFile(buffer, size))
+	{
+		UnmapBigFile(buffer, mapping);
+		return nullptr;
+	}
+	return new IndexFile(buffer, size, mapping);
+}
+
+/***********************************************************************
+IndexFileBuilder
+***********************************************************************/
+
+static WString GetQualifiedName(Symbol* symbol)
+{
+	WString name;
+	for (auto current = symbol; current && current->parent; current = current->parent)
+	{
+		name = name == L"" ? current->name : current->name + L"::" + name;
+	}
+	return name;
+}
+
+// Print a type with resolved names, array lengths and expressions are ignored like IsSameResolvedType
+class SignatureVisitor : public Object, public virtual ITypeVisitor
+{
+public:
+	WString					result;
+
+	void Print(Ptr<Type> type)
+	{
+		if (type)
+		{
+			type->Accept(this);
+		}
+		else
+		{
+			result += L"?";
+		}
+	}
+
+	void PrintName(Ptr<Resolving> resolving, const CppName& name)
+	{
+		if (!resolving || resolving->resolvedSymbols.Count() == 0)
+		{
+			result += name.name;
+			return;
+		}
+
+		resolving->Calibrate();
+		for (vint i = 0; i < resolving->resolvedSymbols.Count(); i++)
+		{
+			if (i > 0) result += L"|";
+			result += GetQualifiedName(resolving->resolvedSymbols[i]);
+		}
+	}
+
+	void Visit(PrimitiveType* self)override
+	{
+		static const wchar_t* prefixes[] = { L"", L"signed ", L"unsigned " };
+		static const wchar_t* primitives[] = {
+			L"auto", L"void", L"bool",
+			L"char", L"wchar_t", L"char16_t", L"char32_t",
+			L"short", L"int", L"__int8", L"__int16", L"__int32", L"__int64", L"long", L"long int", L"long long",
+			L"float", L"double", L"long double",
+		};
+		result += prefixes[(vint)self->prefix];
+		result += primitives[(vint)self->primitive];
+	}
+
+	void Visit(ReferenceType* self)override
+	{
+		Print(self->type);
+		switch (self->reference)
+		{
+		case CppReferenceType::Ptr:		result += L"*"; break;
+		case CppReferenceType::LRef:	result += L"&"; break;
+		case CppReferenceType::RRef:	result += L"&&"; break;
+		}
+	}
+
+	void Visit(ArrayType* self)override
+	{
+		Print(self->type);
+		result += L"[]";
+	}
+
+	void Visit(CallingConventionType* self)override
+	{
+		result += L"cc" + itow((vint)self->callingConvention) + L" ";
+		Print(self->type);
+	}
+
+	void Visit(FunctionType* self)override
+	{
+		result += L"(";
+		for (vint i = 0; i < self->parameters.Count(); i++)
+		{
+			if (i > 0) result += L", ";
+			Print(self->parameters[i]->type);
+		}
+		if (self->ellipsis)
+		{
+			result += self->parameters.Count() > 0 ? L", ..." : L"...";
+		}
+		result += L")";
+		if (self->qualifierConst) result += L" const";
+		if (self->qualifierVolatile) result += L" volatile";
+		if (self->qualifierLRef) result += L" &";
+		if (self->qualifierRRef) result += L" &&";
+	}
+
+	void Visit(MemberType* self)override
+	{
+		Print(self->classType);
+		result += L"::";
+		Print(self->type);
+	}
+
+	void Visit(DeclType* self)override
+	{
+		result += L"decltype(?)";
+	}
+
+	void Visit(DecorateType* self)override
+	{
+		if (self->isConstExpr) result += L"constexpr ";
+		if (self->isConst) result += L"const ";
+		if (self->isVolatile) result += L"volatile ";
+		Print(self->type);
+	}
+
+	void Visit(RootType* self)override
+	{
+	}
+
+	void Visit(IdType* self)override
+	{
+		PrintName(self->resolving, self->name);
+	}
+
+	void Visit(ChildType* self)override
+	{
+		if (self->resolving && self->resolving->resolvedSymbols.Count() > 0)
+		{
+			PrintName(self->resolving, self->name);
+		}
+		else
+		{
+			Print(self->classType);
+			result += L"::" + self->name.name;
+		}
+	}
+
+	void Visit(GenericType* self)override
+	{
+		Print(self->type);
+		result += L"<";
+		for (vint i = 0; i < self->arguments.Count(); i++)
+		{
+			if (i > 0) result += L", ";
+			if (self->arguments[i].type)
+			{
+				Print(self->arguments[i].type);
+			}
+			else
+			{
+				result += L"?";
+			}
+		}
+		result += L">";
+	}
+
+	void Visit(VariadicTemplateArgumentType* self)override
+	{
+		Print(self->type);
+		result += L"...";
+	}
+};
+
+// Overloaded functions are matched by parameters and qualifiers, return types are ignored, returns an empty string for other symbols
+static WString GetSignature(Symbol* symbol)
+{
+	if (symbol->decls.Count() == 0) return WString::Empty;
+	auto decl = symbol->decls[0].Cast<ForwardFunctionDeclaration>();
+	if (!decl || !decl->type) return WString::Empty;
+
+	auto type = GetTypeWithoutMemberAndCC(decl->type);
+	if (!type.Cast<FunctionType>()) return WString::Empty;
+
+	SignatureVisitor visitor;
+	type->Accept(&visitor);
+	return visitor.result;
+}
+
+static IndexSymbolKind GetSymbolKind(Symbol* symbol)
+{
+	if (!symbol->parent) return IndexSymbolKind::Root;
+	if (symbol->stat) return IndexSymbolKind::Statement;
+	if (symbol->decls.Count() == 0) return IndexSymbolKind::Other;
+
+	auto decl = symbol->decls[0];
+	if (decl.Cast<NamespaceDeclaration>()) return IndexSymbolKind::Namespace;
+	if (decl.Cast<ForwardClassDeclaration>()) return IndexSymbolKind::Class;
+	if (decl.Cast<ForwardEnumDeclaration>()) return IndexSymbolKind::Enum;
+	if (decl.Cast<EnumItemDeclaration>()) return IndexSymbolKind::EnumItem;
+	if (decl.Cast<ForwardVariableDeclaration>()) return IndexSymbolKind::Variable;
+	if (decl.Cast<ForwardFunctionDeclaration>()) return IndexSymbolKind::Function;
+	if (decl.Cast<TypeAliasDeclaration>()) return IndexSymbolKind::TypeAlias;
+	return IndexSymbolKind::Other;
+}
+
+vint IndexFileBuilder::GetNode(vint parent, const WString& name, IndexSymbolKind kind, const WString& signature, Dictionary<SiblingKey, vint>& orders)
+{
+	// overloaded functions are matched by signatures, not by orders of declaration
+	// the n-th sibling with the same key in a translation unit is merged with the n-th one in other translation units
+	// so that forward declarations of the same function are still matched by orders
+	SiblingKey siblingKey(parent, name, (vint)kind, signature);
+	vint order = 0;
+	{
+		vint index = orders.Keys().IndexOf(siblingKey);
+		if (index != -1) order = orders.Values()[index];
+		orders.Set(siblingKey, order + 1);
+	}
+
+	NodeKey nodeKey(parent, name, (vint)kind, signature, order);
+	vint index = nodeIds.Keys().IndexOf(nodeKey);
+	if (index != -1) return nodeIds.Values()[index];
+
+	auto node = MakePtr<Node>();
+	node->parent = parent;
+	node->name = name;
+	node->kind = kind;
+	node->signature = signature;
+	vint id = nodes.Add(node);
+	nodes[parent]->children.Add(id);
+	nodeIds.Add(nodeKey, id);
+	return id;
+}
+
+IndexFileBuilder::IndexFileBuilder()
+{
+	nodes.Add(MakePtr<Node>());
+}
+
+IndexFileBuilder::~IndexFileBuilder()
+{
+}
+
+vint IndexFileBuilder::AddTranslationUnit(const WString& path, Symbol* root, IndexTable& index)
+{
+	vint file = files.Add(path);
+
+	List<Symbol*> symbols;
+	Dictionary<Symbol*, vint> symbolNodes;
+	Dictionary<SiblingKey, vint> orders;
+	symbols.Add(root);
+	symbolNodes.Add(root, 0);
+
+	for (vint i = 0; i < symbols.Count(); i++)
+	{
+		auto symbol = symbols[i];
+		vint nodeId = symbolNodes[symbol];
+		auto node = nodes[nodeId];
+
+		for (vint j = 0; j < symbol->children.Count(); j++)
+		{
+			auto& children = symbol->children.GetByIndex(j);
+			for (vint k = 0; k < children.Count(); k++)
+			{
+				auto child = children[k].Obj();
+				symbols.Add(child);
+				auto kind = GetSymbolKind(child);
+				auto signature = kind == IndexSymbolKind::Function ? GetSignature(child) : WString::Empty;
+				symbolNodes.Add(child, GetNode(nodeId, child->name, kind, signature, orders));
+			}
+		}
+
+		for (vint j = 0; j < symbol->decls.Count(); j++)
+		{
+			auto& name = symbol->decls[j]->name;
+			IndexFileDeclaration decl;
+			decl.symbol = -1;
+			decl.file = (vint32_t)file;
+			decl.start = name ? (vint32_t)name.nameTokens[0].start : -1;
+			decl.row = name ? (vint32_t)name.nameTokens[0].rowStart : -1;
+			decl.column = name ? (vint32_t)name.nameTokens[0].columnStart : -1;
+			node->declarations.Add(decl);
+		}
+	}
+
+	for (vint i = 0; i < symbols.Count(); i++)
+	{
+		if (auto forwardRoot = symbols[i]->forwardDeclarationRoot)
+		{
+			vint index = symbolNodes.Keys().IndexOf(forwardRoot);
+			auto node = nodes[symbolNodes[symbols[i]]];
+			if (index != -1 && node->forwardRoot == -1)
+			{
+				node->forwardRoot = symbolNodes.Values()[index];
+			}
+		}
+	}
+
+	for (vint i = 0; i < index.Count(); i++)
+	{
+		vint start = index.symbolStarts[i];
+		vint count = index.symbolCounts[i];
+		for (vint j = 0; j < count; j++)
+		{
+			vint symbolIndex = symbolNodes.Keys().IndexOf(index.symbols[start + j]);
+			if (symbolIndex == -1) continue;
+
+			IndexFileReference reference;
+			reference.symbol = -1;
+			reference.file = (vint32_t)file;
+			reference.start = (vint32_t)index.tokenStarts[i];
+			reference.length = (vint32_t)index.tokenLengths[i];
+			reference.row = (vint32_t)index.tokenRows[i];
+			reference.column = (vint32_t)index.tokenColumns[i];
+			reference.reason = index.reasons[i];
+			nodes[symbolNodes.Values()[symbolIndex]]->references.Add(reference);
+		}
+	}
+	return file;
+}
+
+void IndexFileBuilder::AddIndexFile(const IndexFile& file)
+{
+	vint firstFile = files.Count();
+	for (vint i = 0; i < file.GetFileCount(); i++)
+	{
+		files.Add(file.GetFile(i));
+	}
+
+	// symbols are in breadth-first order, so parents are always visited before children
+	Array<vint> symbolNodes(file.GetSymbolCount());
+	Dictionary<SiblingKey, vint> orders;
+	for (vint i = 0; i < file.GetSymbolCount(); i++)
+	{
+		auto& symbol = file.GetSymbol(i);
+		if (symbol.parent == -1)
+		{
+			symbolNodes[i] = 0;
+		}
+		else
+		{
+			auto signature = symbol.signature == -1 ? WString::Empty : WString(file.GetString(symbol.signature));
+			symbolNodes[i] = GetNode(symbolNodes[symbol.parent], file.GetString(symbol.name), symbol.kind, signature, orders);
+		}
+		auto node = nodes[symbolNodes[i]];
+
+		for (vint j = 0; j < symbol.declarationCount; j++)
+		{
+			auto decl = file.GetDeclaration(symbol.firstDeclaration + j);
+			decl.file += (vint32_t)firstFile;
+			node->declarations.Add(decl);
+		}
+
+		for (vint j = 0; j < symbol.referenceCount; j++)
+		{
+			auto reference = file.GetReference(symbol.firstReference + j);
+			reference.file += (vint32_t)firstFile;
+			node->references.Add(reference);
+		}
+	}
+
+	for (vint i = 0; i < file.GetSymbolCount(); i++)
+	{
+		auto& symbol = file.GetSymbol(i);
+		auto node = nodes[symbolNodes[i]];
+		if (symbol.forwardRoot != -1 && node->forwardRoot == -1)
+		{
+			node->forwardRoot = symbolNodes[symbol.forwardRoot];
+		}
+	}
+}
+
+class IndexFileWriter
+{
+public:
+	List<vint32_t>					files;
+	List<IndexFileSymbol>			symbols;
+	List<IndexFileDeclaration>		declarations;
+	List<IndexFileReference>		references;
+	List<vint32_t>					positions;
+
+	List<IndexFileString>			strings;
+	Dictionary<WString, vint>		stringIds;
+	List<wchar_t>					chars;
+
+	vint GetString(const WString& value)
+	{
+		vint index = stringIds.Keys().IndexOf(value);
+		if (index != -1) return stringIds.Values()[index];
+
+		IndexFileString record;
+		record.offset = (vint32_t)chars.Count();
+		record.length = (vint32_t)value.Length();
+		for (vint i = 0; i <= value.Length(); i++)
+		{
+			chars.Add(value.Buffer()[i]);
+		}
+
+		vint id = strings.Add(record);
+		stringIds.Add(value, id);
+		return id;
+	}
+
+	void AddReferences(vint symbol, List<IndexFileReference>& nodeReferences)
+	{
+		List<IndexFileReference> sorted;
+		CopyFrom(sorted, nodeReferences);
+		if (sorted.Count() > 0)
+		{
+			Sort<IndexFileReference>(&sorted[0], sorted.Count(), [](IndexFileReference a, IndexFileReference b)
+			{
+				if (a.file != b.file) return a.file < b.file ? -1 : 1;
+				if (a.start != b.start) return a.start < b.start ? -1 : 1;
+				if (a.reason != b.reason) return a.reason < b.reason ? -1 : 1;
+				return 0;
+			});
+		}
+
+		auto& record = symbols[symbol];
+		record.firstReference = (vint32_t)references.Count();
+		for (vint i = 0; i < sorted.Count(); i++)
+		{
+			// a name could be resolved more than once when its declaration is parsed again
+			auto reference = sorted[i];
+			if (i > 0)
+			{
+				auto& last = sorted[i - 1];
+				if (last.file == reference.file && last.start == reference.start && last.reason == reference.reason)
+				{
+					continue;
+				}
+			}
+
+			reference.symbol = (vint32_t)symbol;
+			references.Add(reference);
+			record.referenceCount++;
+		}
+	}
+
+	void SortPositions()
+	{
+		for (vint i = 0; i < references.Count(); i++)
+		{
+			positions.Add((vint32_t)i);
+		}
+		if (positions.Count() > 0)
+		{
+			auto& sortedReferences = references;
+			Sort<vint32_t>(&positions[0], positions.Count(), [&](vint32_t a, vint32_t b)
+			{
+				auto& ra = sortedReferences[a];
+				auto& rb = sortedReferences[b];
+				if (ra.file != rb.file) return ra.file < rb.file ? -1 : 1;
+				if (ra.row != rb.row) return ra.row < rb.row ? -1 : 1;
+				if (ra.column != rb.column) return ra.column < rb.column ? -1 : 1;
+				return a < b ? -1 : a > b ? 1 : 0;
+			});
+		}
+	}
+
+	template<typename T>
+	static void WriteSection(IStream& stream, List<T>& items)
+	{
+		if (items.Count() > 0)
+		{
+			stream.Write(&items[0], sizeof(T) * items.Count());
+		}
+	}
+
+	template<typename T>
+	static vint FillSection(IndexFileSection& section, vint offset, List<T>& items)
+	{
+		section.offset = (vint32_t)offset;
+		section.count = (vint32_t)items.Count();
+		offset += sizeof(T) * items.Count();
+		return (offset + sizeof(vint32_t) - 1) / sizeof(vint32_t) * sizeof(vint32_t);
+	}
+
+	void Write(IStream& stream)
+	{
+		IndexFileHeader header;
+		memset(&header, 0, sizeof(header));
+		memcpy(header.magic, CPPDOC_INDEX_FILE_MAGIC, sizeof(header.magic));
+		header.version = CPPDOC_INDEX_FILE_VERSION;
+		header.charSize = sizeof(wchar_t);
+
+		vint offset = sizeof(header);
+		offset = FillSection(header.files, offset, files);
+		offset = FillSection(header.symbols, offset, symbols);
+		offset = FillSection(header.declarations, offset, declarations);
+		offset = FillSection(header.references, offset, references);
+		offset = FillSection(header.positions, offset, positions);
+		offset = FillSection(header.strings, offset, strings);
+		offset = FillSection(header.chars, offset, chars);
+		header.fileSize = (vint32_t)offset;
+
+		stream.Write(&header, sizeof(header));
+		WriteSection(stream, files);
+		WriteSection(stream, symbols);
+		WriteSection(stream, declarations);
+		WriteSection(stream, references);
+		WriteSection(stream, positions);
+		WriteSection(stream, strings);
+		WriteSection(stream, chars);
+
+		// only chars could be unaligned
+		vint padding = header.fileSize - header.chars.offset - sizeof(wchar_t) * chars.Count();
+		if (padding > 0)
+		{
+			vuint8_t zeros[sizeof(vint32_t)] = { 0 };
+			stream.Write(zeros, padding);
+		}
+	}
+};
+
+void IndexFileBuilder::Write(IStream& stream)
+{
+	IndexFileWriter writer;
+	for (vint i = 0; i < files.Count(); i++)
+	{
+		writer.files.Add((vint32_t)writer.GetString(files[i]));
+	}
+
+	// children of a symbol are sorted by name and written contiguously in breadth-first order
+	List<vint> order;
+	Array<vint> symbolIds(nodes.Count());
+	Array<vint> firstChildren(nodes.Count());
+	order.Add(0);
+	symbolIds[0] = 0;
+	for (vint i = 0; i < order.Count(); i++)
+	{
+		auto node = nodes[order[i]];
+		firstChildren[order[i]] = order.Count();
+		List<vint> children;
+		CopyFrom(children, node->children);
+		if (children.Count() > 0)
+		{
+			auto& allNodes = nodes;
+			Sort<vint>(&children[0], children.Count(), [&](vint a, vint b)->vint
+			{
+				vint result = WString::Compare(allNodes[a]->name, allNodes[b]->name);
+				if (result != 0) return result;
+				return a < b ? -1 : a > b ? 1 : 0;
+			});
+		}
+
+		for (vint j = 0; j < children.Count(); j++)
+		{
+			symbolIds[children[j]] = order.Add(children[j]);
+		}
+	}
+
+	for (vint i = 0; i < order.Count(); i++)
+	{
+		auto node = nodes[order[i]];
+		IndexFileSymbol record;
+		record.parent = node->parent == -1 ? -1 : (vint32_t)symbolIds[node->parent];
+		record.name = (vint32_t)writer.GetString(node->name);
+		record.signature = node->signature == L"" ? -1 : (vint32_t)writer.GetString(node->signature);
+		record.kind = node->kind;
+		record.forwardRoot = node->forwardRoot == -1 ? -1 : (vint32_t)symbolIds[node->forwardRoot];
+		record.firstChild = (vint32_t)firstChildren[order[i]];
+		record.childCount = (vint32_t)node->children.Count();
+		record.firstDeclaration = (vint32_t)writer.declarations.Count();
+		record.declarationCount = (vint32_t)node->declarations.Count();
+		record.firstReference = 0;
+		record.referenceCount = 0;
+		writer.symbols.Add(record);
+
+		for (vint j = 0; j < node->declarations.Count(); j++)
+		{
+			auto decl = node->declarations[j];
+			decl.symbol = (vint32_t)i;
+			writer.declarations.Add(decl);
+		}
+		writer.AddReferences(i, node->references);
+	}
+
+	writer.SortPositions();
+	writer.Write(stream);
+}
+
+/***********************************************************************
+WriteIndexFile
+***********************************************************************/
+
+void WriteIndexFile(IStream& stream, Symbol* root, IndexTable& index, const WString& path)
+{
+	IndexFileBuilder builder;
+	builder.AddTranslationUnit(path, root, index);
+	builder.Write(stream);
+}
+
+bool WriteIndexFile(const FilePath& filePath, Symbol* root, IndexTable& index, const WString& path)
+{
+	FileStream stream(filePath.GetFullPath(), FileStream::WriteOnly);
+	if (!stream.IsAvailable()) return false;
+	WriteIndexFile(stream, root, index, path);
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,231 @@
+#ifndef VCZH_DOCUMENT_CPPDOC_INDEXFILE
+#define VCZH_DOCUMENT_CPPDOC_INDEXFILE
+
+#include "Parser.h"
+
+/***********************************************************************
+Index File Format
+	Header
+	Files			: paths of translation units, as indices in Strings
+	Symbols			: symbols in breadth-first order, children of a symbol are contiguous
+	Declarations	: grouped by symbol
+	References		: grouped by symbol, sorted by file and position
+	Positions		: indices of references, sorted by file and position
+	Strings			: offset and length of each string in Chars
+	Chars			: null-terminated wchar_t strings
+	All integers are 32 bits, every section is an array of fixed size records
+***********************************************************************/
+
+#define CPPDOC_INDEX_FILE_MAGIC		"CPPDOCIX"
+#define CPPDOC_INDEX_FILE_VERSION	4
+#define CPPDOC_INDEX_TOOL_VERSION	1	// increase it when the same input is indexed differently, to invalidate cached index files
+
+enum class IndexSymbolKind : vint32_t
+{
+	Root,
+	Namespace,
+	Class,
+	Enum,
+	EnumItem,
+	Variable,
+	Function,
+	TypeAlias,
+	Statement,
+	Other,
+};
+
+struct IndexFileSection
+{
+	vint32_t				offset;
+	vint32_t				count;
+};
+
+struct IndexFileHeader
+{
+	char					magic[8];
+	vint32_t				version;
+	vint32_t				charSize;		// sizeof(wchar_t) of the writer
+	vint32_t				fileSize;
+	IndexFileSection		files;
+	IndexFileSection		symbols;
+	IndexFileSection		declarations;
+	IndexFileSection		references;
+	IndexFileSection		positions;
+	IndexFileSection		strings;
+	IndexFileSection		chars;
+};
+
+struct IndexFileSymbol
+{
+	vint32_t				parent;			// -1 for the root
+	vint32_t				name;			// index in strings, children of a symbol are sorted by name
+	vint32_t				signature;		// index in strings, parameters and qualifiers of a function, -1 for other symbols
+	IndexSymbolKind			kind;
+	vint32_t				forwardRoot;	// -1 if this is not a forward declaration
+	vint32_t				firstChild;
+	vint32_t				childCount;
+	vint32_t				firstDeclaration;
+	vint32_t				declarationCount;
+	vint32_t				firstReference;
+	vint32_t				referenceCount;
+};
+
+struct IndexFileDeclaration
+{
+	vint32_t				symbol;
+	vint32_t				file;
+	vint32_t				start;			// -1 if the declaration has no name
+	vint32_t				row;
+	vint32_t				column;
+};
+
+struct IndexFileReference
+{
+	vint32_t				symbol;
+	vint32_t				file;
+	vint32_t				start;
+	vint32_t				length;
+	vint32_t				row;
+	vint32_t				column;
+	IndexReason				reason;
+};
+
+struct IndexFileString
+{
+	vint32_t				offset;			// index in chars
+	vint32_t				length;
+};
+
+/***********************************************************************
+IndexFile
+***********************************************************************/
+
+// A read-only view of an index file, nothing is copied out of the buffer
+class IndexFile : public Object
+{
+protected:
+	const vuint8_t*			buffer = nullptr;
+	vint					size = 0;
+	void*					mapping = nullptr;	// returned by MapBigFile, released in the destructor
+
+	IndexFile(const void* _buffer, vint _size, void* _mapping);
+
+	template<typename T>
+	const T* GetSection(const IndexFileSection& section)const
+	{
+		return reinterpret_cast<const T*>(buffer + section.offset);
+	}
+public:
+	~IndexFile();
+
+	// Returns nullptr if the buffer is not a valid index file, the buffer must be alive until the IndexFile is deleted
+	// Every index in records is checked against the size of the section it points to
+	static Ptr<IndexFile>			Load(const void* _buffer, vint _size);
+	// Returns nullptr if the file cannot be mapped or is not a valid index file
+	static Ptr<IndexFile>			Open(const FilePath& filePath);
+
+	const IndexFileHeader&			GetHeader()const { return *reinterpret_cast<const IndexFileHeader*>(buffer); }
+	vint							GetFileCount()const { return GetHeader().files.count; }
+	vint							GetSymbolCount()const { return GetHeader().symbols.count; }
+	vint							GetDeclarationCount()const { return GetHeader().declarations.count; }
+	vint							GetReferenceCount()const { return GetHeader().references.count; }
+	vint							GetStringCount()const { return GetHeader().strings.count; }
+
+	const wchar_t*					GetFile(vint index)const { return GetString(GetSection<vint32_t>(GetHeader().files)[index]); }
+	const IndexFileSymbol&			GetSymbol(vint index)const { return GetSection<IndexFileSymbol>(GetHeader().symbols)[index]; }
+	const IndexFileDeclaration&		GetDeclaration(vint index)const { return GetSection<IndexFileDeclaration>(GetHeader().declarations)[index]; }
+	const IndexFileReference&		GetReference(vint index)const { return GetSection<IndexFileReference>(GetHeader().references)[index]; }
+	vint							GetPosition(vint index)const { return GetSection<vint32_t>(GetHeader().positions)[index]; }
+	const wchar_t*					GetString(vint index)const { return GetSection<wchar_t>(GetHeader().chars) + GetSection<IndexFileString>(GetHeader().strings)[index].offset; }
+	vint							GetStringLength(vint index)const { return GetSection<IndexFileString>(GetHeader().strings)[index].length; }
+
+	// IndexFile_Query.cpp, row and column are 0-based
+
+	// Find all children of a symbol with the specified name, returns the first child and fills the number of children
+	vint							FindChildSymbols(vint parent, const WString& name, vint& count)const;
+	// Find all symbols of a qualified name like "a::b::C" from the root
+	void							FindSymbols(const WString& qualifiedName, List<vint>& symbols)const;
+	// Find a translation unit by its path, returns -1 if it does not exist
+	vint							FindFile(const WString& path)const;
+	// Find all references of names that cover the position, returns the first index in positions and fills the number of references
+	vint							FindPositions(vint file, vint row, vint column, vint& count)const;
+	// Find declarations of all symbols referenced at the position, forward declarations are redirected to their roots
+	void							FindDefinitions(vint file, vint row, vint column, List<vint>& declarations)const;
+};
+
+/***********************************************************************
+IndexFileBuilder
+***********************************************************************/
+
+// Merges translation units into one index file
+// Symbols with the same parent, name, kind and signature are merged, a signature is only for functions
+// Symbols with the same key in a translation unit, like forward declarations of a function, are matched by their orders of declaration
+class IndexFileBuilder : public Object
+{
+protected:
+	class Node : public Object
+	{
+	public:
+		vint								parent = -1;
+		WString								name;
+		IndexSymbolKind						kind = IndexSymbolKind::Root;
+		WString								signature;		// empty for symbols other than functions
+		vint								forwardRoot = -1;
+		List<vint>							children;
+		List<IndexFileDeclaration>			declarations;	// symbol is filled when writing
+		List<IndexFileReference>			references;		// symbol is filled when writing
+	};
+
+	using NodeKey = Tuple<vint, WString, vint, WString, vint>;		// parent, name, kind, signature, order in siblings with the same key
+	using SiblingKey = Tuple<vint, WString, vint, WString>;
+
+	List<WString>							files;
+	List<Ptr<Node>>							nodes;
+	Dictionary<NodeKey, vint>				nodeIds;
+
+	vint									GetNode(vint parent, const WString& name, IndexSymbolKind kind, const WString& signature, Dictionary<SiblingKey, vint>& orders);
+public:
+	IndexFileBuilder();
+	~IndexFileBuilder();
+
+	// Add all symbols under root and all references in index, returns the index of the file
+	vint									AddTranslationUnit(const WString& path, Symbol* root, IndexTable& index);
+	// Add all translation units in an index file
+	void									AddIndexFile(const IndexFile& file);
+	void									Write(vl::stream::IStream& stream);
+};
+
+/***********************************************************************
+IndexFileCache
+	Index files of translation units are stored in a folder, named by a hash of the format and tool versions, the path and the content
+	An index file is written to a temporary file and renamed, so a crash or a concurrent writer never leaves a torn file
+	Scope: only whole translation units are cached, declarations at namespace scope are not cached separately
+	Editing any declaration parses the whole translation unit again, only inputs with unchanged content are reused
+	Keys of declarations could be made from their tokens and names they look up (ParsingPartition::lookups)
+	But a cached declaration must still add its symbols to the tree for later declarations, which index files cannot restore
+***********************************************************************/
+
+class IndexFileCache : public Object
+{
+protected:
+	FilePath						folder;
+
+	FilePath						GetCachePath(const WString& key);
+public:
+	// The folder is created if it does not exist
+	IndexFileCache(const FilePath& _folder);
+	~IndexFileCache();
+
+	static WString					GetKey(const WString& path, const wchar_t* content, vint length);
+	// Returns nullptr if there is no valid index file for the key
+	Ptr<IndexFile>					Open(const WString& key, const WString& path);
+	// Returns false if the index file cannot be written, the existing one for the key is not changed
+	bool							Save(const WString& key, const void* buffer, vint size);
+};
+
+// Write all symbols under root and all references in index as the only translation unit
+extern void							WriteIndexFile(vl::stream::IStream& stream, Symbol* root, IndexTable& index, const WString& path = WString::Empty);
+// Returns false if the file cannot be opened
+extern bool							WriteIndexFile(const FilePath& filePath, Symbol* root, IndexTable& index, const WString& path = WString::Empty);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,85 @@
+#include "IndexFile.h"
+
+using namespace vl::stream;
+
+/***********************************************************************
+IndexFileCache
+***********************************************************************/
+
+FilePath IndexFileCache::GetCachePath(const WString& key)
+{
+	return folder / (key + L".idx");
+}
+
+IndexFileCache::IndexFileCache(const FilePath& _folder)
+	:folder(_folder)
+{
+	Folder cacheFolder(folder);
+	if (!cacheFolder.Exists())
+	{
+		cacheFolder.Create(true);
+	}
+}
+
+IndexFileCache::~IndexFileCache()
+{
+}
+
+WString IndexFileCache::GetKey(const WString& path, const wchar_t* content, vint length)
+{
+	// 64 bits FNV-1a
+	vuint64_t hash = 14695981039346656037ULL;
+	auto hashBytes = [&](const void* data, vint size)
+	{
+		auto bytes = (const vuint8_t*)data;
+		for (vint i = 0; i < size; i++)
+		{
+			hash ^= bytes[i];
+			hash *= 1099511628211ULL;
+		}
+	};
+
+	vint32_t header[] = { CPPDOC_INDEX_FILE_VERSION, CPPDOC_INDEX_TOOL_VERSION, (vint32_t)sizeof(wchar_t) };
+	hashBytes(header, sizeof(header));
+	hashBytes(path.Buffer(), sizeof(wchar_t) * (path.Length() + 1));
+	hashBytes(content, sizeof(wchar_t) * length);
+	return u64tow(hash);
+}
+
+Ptr<IndexFile> IndexFileCache::Open(const WString& key, const WString& path)
+{
+	auto cachePath = GetCachePath(key);
+	if (!cachePath.IsFile()) return nullptr;
+
+	// a broken or truncated file is rejected by IndexFile::Open, the path is checked in case of a hash collision
+	auto file = IndexFile::Open(cachePath);
+	if (!file || file->GetFileCount() != 1 || path != file->GetFile(0))
+	{
+		return nullptr;
+	}
+	return file;
+}
+
+bool IndexFileCache::Save(const WString& key, const void* buffer, vint size)
+{
+	// the temporary name is unique in all threads and processes writing the folder
+	static volatile vint counter = 0;
+	FilePath tempPath = folder / (key + L"." + itow(GetProcessIdentifier()) + L"." + itow(INCRC(&counter)) + L".tmp");
+	{
+		FileStream stream(tempPath.GetFullPath(), FileStream::WriteOnly);
+		if (!stream.IsAvailable()) return false;
+		if (stream.Write(const_cast<void*>(buffer), size) != size)
+		{
+			stream.Close();
+			File(tempPath).Delete();
+			return false;
+		}
+	}
+
+	if (!MoveFileOver(tempPath, GetCachePath(key)))
+	{
+		File(tempPath).Delete();
+		return false;
+	}
+	return true;
+}
\ No newline at end of file
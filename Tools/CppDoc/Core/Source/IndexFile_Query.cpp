@@ -0,0 +1,165 @@
+#include "IndexFile.h"
+
+/***********************************************************************
+FindChildSymbols
+***********************************************************************/
+
+vint IndexFile::FindChildSymbols(vint parent, const WString& name, vint& count)const
+{
+	count = 0;
+	auto& symbol = GetSymbol(parent);
+
+	// IndexFileBuilder::Write sorts children by WString::Compare on names, the binary search relies on this order
+	vint start = symbol.firstChild;
+	vint end = symbol.firstChild + symbol.childCount;
+	while (start < end)
+	{
+		vint middle = (start + end) / 2;
+		if (WString(GetString(GetSymbol(middle).name), false) < name)
+		{
+			start = middle + 1;
+		}
+		else
+		{
+			end = middle;
+		}
+	}
+
+	end = symbol.firstChild + symbol.childCount;
+	while (start + count < end && WString(GetString(GetSymbol(start + count).name), false) == name)
+	{
+		count++;
+	}
+	return start;
+}
+
+/***********************************************************************
+FindSymbols
+***********************************************************************/
+
+void IndexFile::FindSymbols(const WString& qualifiedName, List<vint>& symbols)const
+{
+	symbols.Clear();
+	symbols.Add(0);
+
+	vint reading = 0;
+	while (reading < qualifiedName.Length() && symbols.Count() > 0)
+	{
+		vint length = 0;
+		while (reading + length < qualifiedName.Length() && qualifiedName[reading + length] != L':')
+		{
+			length++;
+		}
+
+		auto name = qualifiedName.Sub(reading, length);
+		reading += length;
+		while (reading < qualifiedName.Length() && qualifiedName[reading] == L':')
+		{
+			reading++;
+		}
+		if (name.Length() == 0) continue;
+
+		List<vint> children;
+		for (vint i = 0; i < symbols.Count(); i++)
+		{
+			vint count = 0;
+			vint first = FindChildSymbols(symbols[i], name, count);
+			for (vint j = 0; j < count; j++)
+			{
+				children.Add(first + j);
+			}
+		}
+		CopyFrom(symbols, children);
+	}
+}
+
+/***********************************************************************
+FindFile
+***********************************************************************/
+
+vint IndexFile::FindFile(const WString& path)const
+{
+	for (vint i = 0; i < GetFileCount(); i++)
+	{
+		if (path == GetFile(i))
+		{
+			return i;
+		}
+	}
+	return -1;
+}
+
+/***********************************************************************
+FindPositions
+***********************************************************************/
+
+vint IndexFile::FindPositions(vint file, vint row, vint column, vint& count)const
+{
+	count = 0;
+
+	// find the first position after (file, row, column)
+	vint start = 0;
+	vint end = GetReferenceCount();
+	while (start < end)
+	{
+		vint middle = (start + end) / 2;
+		auto& reference = GetReference(GetPosition(middle));
+		if (reference.file < file || (reference.file == file && (reference.row < row || (reference.row == row && reference.column <= column))))
+		{
+			start = middle + 1;
+		}
+		else
+		{
+			end = middle;
+		}
+	}
+
+	// names don't overlap, so only the last name starting before (row, column) could cover it
+	if (start == 0) return 0;
+	auto& last = GetReference(GetPosition(start - 1));
+	if (last.file != file || last.row != row || column >= last.column + last.length) return start;
+
+	while (start > 0)
+	{
+		auto& reference = GetReference(GetPosition(start - 1));
+		if (reference.row != last.row || reference.column != last.column) break;
+		start--;
+		count++;
+	}
+	return start;
+}
+
+/***********************************************************************
+FindDefinitions
+***********************************************************************/
+
+void IndexFile::FindDefinitions(vint file, vint row, vint column, List<vint>& declarations)const
+{
+	declarations.Clear();
+
+	vint count = 0;
+	vint first = FindPositions(file, row, column, count);
+
+	SortedList<vint> symbols;
+	for (vint i = 0; i < count; i++)
+	{
+		vint symbol = GetReference(GetPosition(first + i)).symbol;
+		if (GetSymbol(symbol).forwardRoot != -1)
+		{
+			symbol = GetSymbol(symbol).forwardRoot;
+		}
+		if (!symbols.Contains(symbol))
+		{
+			symbols.Add(symbol);
+		}
+	}
+
+	for (vint i = 0; i < symbols.Count(); i++)
+	{
+		auto& symbol = GetSymbol(symbols[i]);
+		for (vint j = 0; j < symbol.declarationCount; j++)
+		{
+			declarations.Add(symbol.firstDeclaration + j);
+		}
+	}
+}
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "Lexer.h"
+#include "Statistics.h"
 
 /***********************************************************************
 CreateCppLexer
@@ -8,7 +9,7 @@ Ptr<RegexLexer> CreateCppLexer()
 {
 	List<WString> tokens;
 #define DEFINE_REGEX_TOKEN(NAME, REGEX) if ((vint)CppTokens::NAME != tokens.Add(REGEX)) { throw 0; }
-#define DEFINE_KEYWORD_TOKEN(NAME, KEYWORD) DEFINE_REGEX_TOKEN(NAME, L#KEYWORD)
+#define DEFINE_KEYWORD_TOKEN(NAME, KEYWORD) DEFINE_REGEX_TOKEN(NAME, L_(#KEYWORD))
 	CPP_ALL_TOKENS(DEFINE_KEYWORD_TOKEN, DEFINE_REGEX_TOKEN)
 #undef DEFINE_KEYWORD_TOKEN
 #undef DEFINE_REGEX_TOKEN
@@ -32,6 +33,10 @@ Ptr<CppTokenCursor> CppTokenCursor::Next()
 	if (!next)
 	{
 		next = reader->CreateNextToken();
+		if (next)
+		{
+			next->previousEnd = token.start + token.length;
+		}
 	}
 	return next;
 }
@@ -42,17 +47,33 @@ CppTokenReader
 
 Ptr<CppTokenCursor> CppTokenReader::CreateNextToken()
 {
+	CppDocumentRange document;
 	while (tokenEnumerator->Next())
 	{
 		auto token = tokenEnumerator->Current();
+		CPPDOC_COUNT(tokensLexed);
 		switch((CppTokens)token.token)
 		{
 		case CppTokens::SPACE:
+			continue;
 		case CppTokens::COMMENT1:
 		case CppTokens::COMMENT2:
+			// a comment separates documents from the next token
+			document = {};
+			continue;
+		case CppTokens::DOCUMENT:
+			if (document.count == 0)
+			{
+				document.start = documents.Count();
+			}
+			document.count++;
+			documents.Add(token);
 			continue;
 		}
-		return new CppTokenCursor(this, token);
+		CPPDOC_COUNT(cursorAllocations);
+		auto cursor = new CppTokenCursor(this, token);
+		cursor->document = document;
+		return cursor;
 	}
 	return nullptr;
 }
@@ -77,4 +98,9 @@ Ptr<CppTokenCursor> CppTokenReader::GetFirstToken()
 	}
 	gotFirstToken = true;
 	return CreateNextToken();
+}
+
+const List<RegexToken>& CppTokenReader::GetDocuments()
+{
+	return documents;
 }
\ No newline at end of file
@@ -30,6 +30,13 @@ Reader
 class CppTokenCursor;
 class CppTokenReader;
 
+// consecutive DOCUMENT tokens before a token, only separated by spaces
+struct CppDocumentRange
+{
+	vint						start = -1;		// index of the first token in CppTokenReader::GetDocuments(), -1 if there is no document
+	vint						count = 0;
+};
+
 class CppTokenCursor
 {
 	friend class CppTokenReader;
@@ -40,6 +47,8 @@ private:
 	CppTokenCursor(CppTokenReader* _reader, RegexToken _token);
 public:
 	RegexToken					token;
+	vint						previousEnd = -1;	// the end of the previous token, -1 for the first token
+	CppDocumentRange			document;			// the document block before this token
 
 	Ptr<CppTokenCursor>			Next();
 };
@@ -52,6 +61,7 @@ protected:
 	Ptr<RegexLexer>				lexer;
 	Ptr<RegexTokens>			tokens;
 	IEnumerator<RegexToken>*	tokenEnumerator;
+	List<RegexToken>			documents;
 
 	Ptr<CppTokenCursor>			CreateNextToken();
 public:
@@ -59,6 +69,7 @@ public:
 	~CppTokenReader();
 
 	Ptr<CppTokenCursor>			GetFirstToken();
+	const List<RegexToken>&		GetDocuments();		// DOCUMENT tokens that have been read, sorted by position
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,500 @@
+#include "ParallelParser.h"
+#include "Ast_Decl.h"
+#include "Scheduler.h"
+
+/***********************************************************************
+Helpers
+***********************************************************************/
+
+static bool IsNamespace(Symbol* symbol)
+{
+	return symbol->decls.Count() > 0 && symbol->decls[0].Cast<NamespaceDeclaration>();
+}
+
+// The only namespace with the name in the scope, nullptr if there is not
+static Symbol* FindNamespace(Symbol* scope, const WString& name)
+{
+	vint index = scope->children.Keys().IndexOf(name);
+	if (index == -1) return nullptr;
+	auto& symbols = scope->children.GetByIndex(index);
+	return symbols.Count() == 1 && IsNamespace(symbols[0].Obj()) ? symbols[0].Obj() : nullptr;
+}
+
+// The namespace in the merged root with the same full name as a namespace in a partition, nullptr if there is not
+static Symbol* FindMergedNamespace(Symbol* symbol, Symbol* partitionRoot, Symbol* mergedRoot)
+{
+	if (symbol == partitionRoot) return mergedRoot;
+	auto parent = FindMergedNamespace(symbol->parent, partitionRoot, mergedRoot);
+	return parent ? FindNamespace(parent, symbol->name) : nullptr;
+}
+
+// Symbols of the same category could be connected by ConnectForwards, 0 for symbols that could not be declared again
+// Functions are not connected across partitions, because overloads are compared by types resolved in different roots
+static vint GetForwardCategory(Symbol* symbol, vint& roots)
+{
+	auto decl = symbol->decls[0];
+	if (decl.Cast<ClassDeclaration>() || decl.Cast<EnumDeclaration>() || decl.Cast<VariableDeclaration>()) roots++;
+
+	if (decl.Cast<ForwardClassDeclaration>()) return 1;
+	if (decl.Cast<ForwardEnumDeclaration>()) return 2;
+	if (decl.Cast<ForwardFunctionDeclaration>()) return 0;
+	if (decl.Cast<ForwardVariableDeclaration>()) return 3;
+	return 0;
+}
+
+// Test if a name declared in a namespace of a partition is also declared in the same namespace of the merged root
+static bool IsDeclarationConflicted(Symbol* from, Symbol* to)
+{
+	for (vint i = 0; i < from->children.Count(); i++)
+	{
+		vint index = to->children.Keys().IndexOf(from->children.Keys()[i]);
+		if (index == -1) continue;
+
+		auto& fromSymbols = from->children.GetByIndex(i);
+		auto& toSymbols = to->children.GetByIndex(index);
+		if (IsNamespace(fromSymbols[0].Obj()))
+		{
+			if (toSymbols.Count() != 1 || !IsNamespace(toSymbols[0].Obj())) return true;
+			if (IsDeclarationConflicted(fromSymbols[0].Obj(), toSymbols[0].Obj())) return true;
+		}
+		else
+		{
+			// only forward declarations and one definition could be connected
+			vint roots = 0;
+			vint category = GetForwardCategory(fromSymbols[0].Obj(), roots);
+			if (category == 0) return true;
+			for (vint j = 1; j < fromSymbols.Count(); j++)
+			{
+				if (GetForwardCategory(fromSymbols[j].Obj(), roots) != category) return true;
+			}
+			for (vint j = 0; j < toSymbols.Count(); j++)
+			{
+				if (GetForwardCategory(toSymbols[j].Obj(), roots) != category) return true;
+			}
+			if (roots > 1) return true;
+		}
+	}
+	return false;
+}
+
+// namespace NAME { :: NAME ...} {, the cursor is moved after { only if it matches
+static bool SkipNamespaceHead(Ptr<CppTokenCursor>& cursor)
+{
+	auto current = cursor;
+	if (!TestToken(current, CppTokens::DECL_NAMESPACE)) return false;
+	while (TestToken(current, CppTokens::ID))
+	{
+		if (TestToken(current, CppTokens::LBRACE))
+		{
+			cursor = current;
+			return true;
+		}
+		if (!TestToken(current, CppTokens::COLON, CppTokens::COLON)) return false;
+	}
+	return false;
+}
+
+/***********************************************************************
+ParallelParser (Split)
+***********************************************************************/
+
+bool ParallelParser::Scan(Ptr<CppTokenCursor> cursor)
+{
+	List<vint> blocks;
+	while (cursor)
+	{
+		Unit unit;
+		unit.start = cursor;
+		unit.parent = blocks.Count() == 0 ? -1 : blocks[blocks.Count() - 1];
+
+		if (blocks.Count() > 0 && TestToken(cursor, CppTokens::RBRACE))
+		{
+			unit.kind = UnitKind::NamespaceEnd;
+			blocks.RemoveAt(blocks.Count() - 1);
+		}
+		else if (SkipNamespaceHead(cursor))
+		{
+			unit.kind = UnitKind::NamespaceBegin;
+			blocks.Add(units.Count());
+		}
+		else
+		{
+			SkipDeclaration(cursor);
+		}
+
+		unit.end = cursor;
+		units.Add(unit);
+	}
+
+	// a namespace is not closed
+	return blocks.Count() == 0;
+}
+
+void ParallelParser::Split()
+{
+	// each partition begins at the first unit after its share of characters, the last unit is not counted
+	vint start = units[0].start->token.start;
+	vint characters = units[units.Count() - 1].start->token.start - start;
+	vint first = 0;
+	for (vint i = 1; i <= units.Count(); i++)
+	{
+		if (i == units.Count() || (partitions.Count() + 1 < partitionCount && units[i].start->token.start - start >= characters * (partitions.Count() + 1) / partitionCount))
+		{
+			auto partition = MakePtr<Partition>();
+			partition->first = first;
+			partition->last = i;
+			partitions.Add(partition);
+			first = i;
+		}
+	}
+}
+
+/***********************************************************************
+ParallelParser (Parse)
+***********************************************************************/
+
+void ParallelParser::ParseUnits(const ParsingArguments& pa, vint first, vint last, Dictionary<vint, Symbol*>& unitNamespaces)
+{
+	for (vint i = first; i < last; i++)
+	{
+		auto& unit = units[i];
+		auto parsedUnit = MakePtr<ParsedUnit>();
+		parsedUnits[i] = parsedUnit;
+
+		ParsingArguments unitPa(pa, unit.parent == -1 ? pa.root.Obj() : unitNamespaces[unit.parent]);
+		auto cursor = unit.start;
+		switch (unit.kind)
+		{
+		case UnitKind::NamespaceBegin:
+			{
+				Ptr<NamespaceDeclaration> topDecl;
+				cursor = cursor->Next();
+				unitNamespaces.Set(i, ParseNamespaceHead(unitPa, cursor, topDecl, parsedUnit->body));
+				parsedUnit->decls.Add(topDecl);
+			}
+			break;
+		case UnitKind::NamespaceEnd:
+			break;
+		default:
+			do
+			{
+				CPPDOC_TRACE_SCOPE(L"ParseDeclaration");
+#ifdef CPPDOC_TRACE
+				vint declCount = parsedUnit->decls.Count();
+#endif
+				ParseNamespaceMember(unitPa, cursor, parsedUnit->decls);
+				CPPDOC_TRACE_DETAIL(declCount < parsedUnit->decls.Count() ? parsedUnit->decls[declCount]->name.name : WString::Empty);
+
+				if (unit.end && (!cursor || cursor->token.start > unit.end->token.start))
+				{
+					// the declaration is not what SkipDeclaration finds
+					throw StopParsingException(cursor);
+				}
+			} while (cursor != unit.end);
+		}
+	}
+}
+
+void ParallelParser::ParsePartition(Ptr<Partition> partition, const ParsingArguments& pa)
+{
+	CPPDOC_TRACE_SCOPE(L"ParsePartition");
+	CPPDOC_TRACE_DETAIL(itow(partition->first) + L"-" + itow(partition->last));
+
+	auto& partitionPa = partition->pa;
+	partitionPa = ParsingArguments(MakePtr<Symbol>(), ITsysAlloc::Create(), nullptr);
+	partitionPa.partition = MakePtr<ParsingPartition>();
+	if (pa.index)
+	{
+		partitionPa.index = MakePtr<IndexTable>();
+	}
+	if (pa.recovery)
+	{
+		partitionPa.recovery = MakePtr<ParsingRecovery>();
+		for (vint i = 0; i < (vint)ParsingBudget::Count; i++)
+		{
+			partitionPa.recovery->limits[i] = pa.recovery->limits[i];
+		}
+		partitionPa.recovery->skipSyntaxErrors = pa.recovery->skipSyntaxErrors;
+		partitionPa.recovery->functionTypeExpansionLimit = pa.recovery->functionTypeExpansionLimit;
+	}
+
+	try
+	{
+		// namespaces beginning before the partition are created again, they will be merged with the real ones
+		List<vint> blocks;
+		for (vint block = units[partition->first].parent; block != -1; block = units[block].parent)
+		{
+			blocks.Insert(0, block);
+		}
+		for (vint i = 0; i < blocks.Count(); i++)
+		{
+			auto& unit = units[blocks[i]];
+			ParsingArguments unitPa(partitionPa, unit.parent == -1 ? partitionPa.root.Obj() : partition->namespaces[unit.parent]);
+			Ptr<NamespaceDeclaration> topDecl, contextDecl;
+			auto cursor = unit.start->Next();
+			partition->namespaces.Add(blocks[i], ParseNamespaceHead(unitPa, cursor, topDecl, contextDecl));
+
+			for (auto decl = topDecl; decl; decl = decl == contextDecl ? nullptr : decl->decls[0].Cast<NamespaceDeclaration>())
+			{
+				partition->reopened.Add(decl.Obj());
+			}
+		}
+
+		ParseUnits(partitionPa, partition->first, partition->last, partition->namespaces);
+	}
+	catch (...)
+	{
+		// anything not expected is left to ParseUnits on the merged root
+		partition->failed = true;
+	}
+	if (partitionPa.recovery) partitionPa.recovery->Stop();
+}
+
+/***********************************************************************
+ParallelParser (Merge)
+***********************************************************************/
+
+bool ParallelParser::IsConflicted(Ptr<Partition> partition, const ParsingArguments& pa)
+{
+	auto partitionRoot = partition->pa.root.Obj();
+	auto& lookups = partition->pa.partition->lookups;
+	for (vint i = 0; i < lookups.Count(); i++)
+	{
+		auto& name = lookups.Keys()[i];
+		auto& scopes = lookups.GetByIndex(i);
+		for (vint j = 0; j < scopes.Count(); j++)
+		{
+			// a name searched in the partition could find more symbols in the merged root
+			auto scope = FindMergedNamespace(scopes[j], partitionRoot, pa.root.Obj());
+			if (scope && (scope->usingNss.Count() > 0 || scope->children.Keys().Contains(name)))
+			{
+				return true;
+			}
+		}
+	}
+	return IsDeclarationConflicted(partitionRoot, pa.root.Obj());
+}
+
+Symbol* ParallelParser::GetMergedSymbol(Symbol* symbol)
+{
+	vint index = mergedNamespaces.Keys().IndexOf(symbol);
+	return index == -1 ? symbol : mergedNamespaces.Values()[index];
+}
+
+void ParallelParser::MergeNamespace(Ptr<Partition> partition, Symbol* from, Symbol* to, List<Symbol*>& reopened, List<Symbol*>& moved)
+{
+	for (vint i = 0; i < from->children.Count(); i++)
+	{
+		auto& name = from->children.Keys()[i];
+		auto& symbols = from->children.GetByIndex(i);
+		for (vint j = 0; j < symbols.Count(); j++)
+		{
+			auto symbol = symbols[j];
+			auto existing = IsNamespace(symbol.Obj()) ? FindNamespace(to, name) : nullptr;
+			if (existing)
+			{
+				// a reopened namespace in ParseDeclaration only adds the declaration to the symbol
+				mergedNamespaces.Add(symbol.Obj(), existing);
+				for (vint k = 0; k < symbol->decls.Count(); k++)
+				{
+					auto decl = symbol->decls[k];
+					if (!partition->reopened.Contains(decl.Obj()))
+					{
+						decl->symbol = nullptr;
+						existing->decls.Add(decl);
+					}
+				}
+				if (symbol->usingNss.Count() > 0)
+				{
+					CopyFrom(existing->usingNss, symbol->usingNss, true);
+					existing->IncreaseOperatorVersion();
+				}
+				reopened.Add(existing);
+				MergeNamespace(partition, symbol.Obj(), existing, reopened, moved);
+			}
+			else
+			{
+				bool connect = !IsNamespace(symbol.Obj()) && to->children.Keys().Contains(name);
+				to->Add(symbol);
+				moved.Add(symbol.Obj());
+				if (connect)
+				{
+					ConnectForwardDeclarations(to, symbol.Obj());
+				}
+			}
+		}
+	}
+}
+
+void ParallelParser::FixMovedSymbol(Symbol* symbol)
+{
+	// types are created again by the allocator of the merged root
+	symbol->resolvedTypes = nullptr;
+	symbol->conversionTable = nullptr;
+	symbol->overloadArityTable = nullptr;
+	for (vint i = 0; i < symbol->usingNss.Count(); i++)
+	{
+		symbol->usingNss[i] = GetMergedSymbol(symbol->usingNss[i]);
+	}
+
+	for (vint i = 0; i < symbol->children.Count(); i++)
+	{
+		auto& children = symbol->children.GetByIndex(i);
+		for (vint j = 0; j < children.Count(); j++)
+		{
+			FixMovedSymbol(children[j].Obj());
+		}
+	}
+}
+
+void ParallelParser::Merge(Ptr<Partition> partition, const ParsingArguments& pa)
+{
+	CPPDOC_TRACE_SCOPE(L"MergePartition");
+	CPPDOC_TRACE_DETAIL(itow(partition->first) + L"-" + itow(partition->last));
+
+	List<Symbol*> reopened, moved;
+	auto& partitionPa = partition->pa;
+	MergeNamespace(partition, partitionPa.root.Obj(), pa.root.Obj(), reopened, moved);
+	CopyFrom(pa.root->usingNss, partitionPa.root->usingNss, true);
+	reopened.Add(pa.root.Obj());
+
+	for (vint i = 0; i < reopened.Count(); i++)
+	{
+		auto& usingNss = reopened[i]->usingNss;
+		for (vint j = 0; j < usingNss.Count(); j++)
+		{
+			usingNss[j] = GetMergedSymbol(usingNss[j]);
+		}
+	}
+	for (vint i = 0; i < moved.Count(); i++)
+	{
+		FixMovedSymbol(moved[i]);
+	}
+
+	for (vint i = 0; i < partition->namespaces.Count(); i++)
+	{
+		namespaces.Set(partition->namespaces.Keys()[i], GetMergedSymbol(partition->namespaces.Values()[i]));
+	}
+	if (pa.index)
+	{
+		pa.index->Append(*partitionPa.index.Obj(), mergedNamespaces);
+	}
+	if (pa.recovery)
+	{
+		CopyFrom(pa.recovery->diagnostics, partitionPa.recovery->diagnostics, true);
+	}
+
+	// only the root and types are kept
+	partitionPa.index = nullptr;
+	partitionPa.recovery = nullptr;
+	partitionPa.partition = nullptr;
+	partitionPa.operatorCache = nullptr;
+}
+
+Ptr<Program> ParallelParser::BuildProgram()
+{
+	auto program = MakePtr<Program>();
+	List<Ptr<NamespaceDeclaration>> bodies;
+	for (vint i = 0; i < units.Count(); i++)
+	{
+		auto& unit = units[i];
+		auto parsedUnit = parsedUnits[i];
+		auto& output = bodies.Count() == 0 ? program->decls : bodies[bodies.Count() - 1]->decls;
+		switch (unit.kind)
+		{
+		case UnitKind::NamespaceBegin:
+			CopyFrom(output, parsedUnit->decls, true);
+			bodies.Add(parsedUnit->body);
+			break;
+		case UnitKind::NamespaceEnd:
+			bodies.RemoveAt(bodies.Count() - 1);
+			break;
+		default:
+			CopyFrom(output, parsedUnit->decls, true);
+		}
+	}
+	return program;
+}
+
+/***********************************************************************
+ParallelParser
+***********************************************************************/
+
+ParallelParser::ParallelParser(vint _partitionCount, vint _threadCount)
+	:partitionCount(_partitionCount)
+	, threadCount(_threadCount)
+{
+}
+
+ParallelParser::~ParallelParser()
+{
+}
+
+Ptr<Program> ParallelParser::Parse(const ParsingArguments& pa, Ptr<CppTokenCursor>& cursor)
+{
+	CPPDOC_TRACE_SCOPE(L"ParallelParser::Parse");
+	units.Clear();
+	partitions.Clear();
+	namespaces.Clear();
+	mergedNamespaces.Clear();
+	parsedPartitions = 0;
+	mergedPartitions = 0;
+
+	// the recorder is not notified in order if partitions are parsed concurrently
+	if (!pa.recorder && partitionCount > 1 && cursor && Scan(cursor))
+	{
+		Split();
+	}
+	if (partitions.Count() < 2)
+	{
+		units.Clear();
+		partitions.Clear();
+		return ParseProgram(pa, cursor);
+	}
+
+	parsedUnits.Resize(units.Count());
+	{
+		WorkStealingScheduler scheduler(threadCount);
+		for (vint i = 0; i < partitions.Count(); i++)
+		{
+			auto partition = partitions[i];
+			scheduler.Queue(i, [this, partition, &pa](vint)
+			{
+				ParsePartition(partition, pa);
+			});
+		}
+		scheduler.Run();
+	}
+	parsedPartitions = partitions.Count();
+
+	try
+	{
+		CPPDOC_TRACE_SCOPE(L"MergePartitions");
+		for (vint i = 0; i < partitions.Count(); i++)
+		{
+			auto partition = partitions[i];
+			if (!partition->failed && !IsConflicted(partition, pa))
+			{
+				Merge(partition, pa);
+				mergedPartitions++;
+			}
+			else
+			{
+				// a partition depending on previous partitions is parsed again on the merged root
+				partitions[i] = nullptr;
+				ParseUnits(pa, partition->first, partition->last, namespaces);
+			}
+		}
+	}
+	catch (...)
+	{
+		if (pa.recovery) pa.recovery->Stop();
+		throw;
+	}
+	if (pa.recovery) pa.recovery->Stop();
+
+	auto program = BuildProgram();
+	parsedUnits.Resize(0);
+	cursor = nullptr;
+	return program;
+}
\ No newline at end of file
@@ -0,0 +1,90 @@
+#ifndef VCZH_DOCUMENT_CPPDOC_PARALLELPARSER
+#define VCZH_DOCUMENT_CPPDOC_PARALLELPARSER
+
+#include "Parser.h"
+
+/***********************************************************************
+ParallelParser (experimental)
+	Split a program at declarations in namespaces, parse partitions concurrently, and merge them in order
+	Declarations are found by SkipDeclaration, a namespace could begin and end in different partitions
+	Each partition is parsed from an empty root with its own types and index table, names searched in namespaces are recorded
+	A partition is merged if none of its recorded names is declared by previous partitions, otherwise it is parsed again on the merged root
+	Namespaces are merged like reopened namespaces in ParseDeclaration, forward declarations are connected like ConnectForwards
+	Merged namespaces replace namespaces of partitions in the index table, but resolved names in the AST could still refer to the latter
+	Types and namespaces of merged partitions are kept by the parser, it must be deleted after the program
+
+	Limitation:
+	There is no resolution fix-up pass, names resolved in a partition are not resolved again against the merged root
+	A partition using any name declared by previous partitions is parsed again sequentially after all partitions are parsed
+	So on code where later declarations depend on earlier ones, which is most real code, this is slower than ParseProgram
+	e.g. Benchmark -p 4 on members:2000 takes 205ms against 148ms of ParseProgram, because the last partition is parsed twice
+***********************************************************************/
+
+class ParallelParser : public Object
+{
+protected:
+	enum class UnitKind
+	{
+		Declaration,
+		NamespaceBegin,				// namespace NAME { :: NAME ...} {
+		NamespaceEnd,				// }
+	};
+
+	struct Unit
+	{
+		UnitKind					kind = UnitKind::Declaration;
+		Ptr<CppTokenCursor>			start;
+		Ptr<CppTokenCursor>			end;			// the token after the unit, nullptr for the end of the input
+		vint						parent = -1;	// the NamespaceBegin unit of the namespace containing this unit, -1 for the global namespace
+	};
+
+	class ParsedUnit : public Object
+	{
+	public:
+		List<Ptr<Declaration>>		decls;			// declarations, or the namespace of a NamespaceBegin unit
+		Ptr<NamespaceDeclaration>	body;			// the innermost namespace of a NamespaceBegin unit, containing following units
+	};
+
+	class Partition : public Object
+	{
+	public:
+		vint						first = 0;		// units in [first, last)
+		vint						last = 0;
+		ParsingArguments			pa;
+		Dictionary<vint, Symbol*>	namespaces;		// NamespaceBegin unit -> namespace in pa.root
+		SortedList<Declaration*>	reopened;		// namespaces created for NamespaceBegin units before this partition
+		bool						failed = false;
+	};
+
+	vint							partitionCount;
+	vint							threadCount;
+	List<Unit>						units;
+	Array<Ptr<ParsedUnit>>			parsedUnits;
+	List<Ptr<Partition>>			partitions;			// merged partitions are kept
+	Dictionary<vint, Symbol*>		namespaces;			// NamespaceBegin unit -> namespace in the merged root
+	Dictionary<Symbol*, Symbol*>	mergedNamespaces;	// namespace in a partition -> the same namespace in the merged root
+
+	bool							Scan(Ptr<CppTokenCursor> cursor);
+	void							Split();
+	void							ParseUnits(const ParsingArguments& pa, vint first, vint last, Dictionary<vint, Symbol*>& unitNamespaces);
+	void							ParsePartition(Ptr<Partition> partition, const ParsingArguments& pa);
+	bool							IsConflicted(Ptr<Partition> partition, const ParsingArguments& pa);
+	Symbol*							GetMergedSymbol(Symbol* symbol);
+	void							MergeNamespace(Ptr<Partition> partition, Symbol* from, Symbol* to, List<Symbol*>& reopened, List<Symbol*>& moved);
+	void							FixMovedSymbol(Symbol* symbol);
+	void							Merge(Ptr<Partition> partition, const ParsingArguments& pa);
+	Ptr<Program>					BuildProgram();
+public:
+	vint							parsedPartitions = 0;	// partitions parsed concurrently in the last Parse
+	vint							mergedPartitions = 0;	// partitions merged without being parsed again in the last Parse
+
+	// Use the number of processors when threadCount is 0
+	ParallelParser(vint _partitionCount, vint _threadCount = 0);
+	~ParallelParser();
+
+	// Same as ParseProgram, which is called instead if there is a recorder or the program could not be split
+	// Throw StopParsingException if a declaration is different from what SkipDeclaration finds, even if ParseProgram succeeds
+	Ptr<Program>					Parse(const ParsingArguments& pa, Ptr<CppTokenCursor>& cursor);
+};
+
+#endif
\ No newline at end of file
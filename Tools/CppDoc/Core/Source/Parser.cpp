@@ -1,13 +1,61 @@
 #include "Parser.h"
+#include "Ast_Decl.h"
 
 /***********************************************************************
 Symbol
 ***********************************************************************/
 
+CPPDOC_ALLOCATION_DEFINE(L"Symbol", Symbol)
+
 void Symbol::Add(Ptr<Symbol> child)
 {
 	child->parent = this;
 	children.Add(child->name, child);
+	conversionTable = nullptr;
+	if (overloadArityTable)
+	{
+		overloadArityTable->overloadSets.Remove(child->name);
+	}
+
+	auto current = this;
+	while (current)
+	{
+		current->descendantVersion++;
+		current = current->parent;
+	}
+
+	// operators, constructors and conversion functions, or a moved scope containing any of them
+	auto& name = child->name;
+	if (child->operatorVersion > 0 || name == L"$__ctor" || name == L"$__type" || (name.Length() > 9 && name.Left(9) == L"operator "))
+	{
+		IncreaseOperatorVersion();
+	}
+}
+
+void Symbol::IncreaseOperatorVersion()
+{
+	auto current = this;
+	while (current)
+	{
+		current->operatorVersion++;
+		current = current->parent;
+	}
+}
+
+/***********************************************************************
+ParsingPartition
+***********************************************************************/
+
+void ParsingPartition::Lookup(Symbol* scope, const WString& name)
+{
+	if (scope->parent && !(scope->decls.Count() > 0 && scope->decls[0].Cast<NamespaceDeclaration>()))
+	{
+		return;
+	}
+	if (!lookups.Contains(name, scope))
+	{
+		lookups.Add(name, scope);
+	}
 }
 
 /***********************************************************************
@@ -23,6 +71,7 @@ ParsingArguments::ParsingArguments(Ptr<Symbol> _root, Ptr<ITsysAlloc> _tsys, Ptr
 	, context(_root.Obj())
 	, tsys(_tsys)
 	, recorder(_recorder)
+	, operatorCache(MakePtr<OperatorResolvingCache>())
 {
 }
 
@@ -30,20 +79,167 @@ ParsingArguments::ParsingArguments(const ParsingArguments& pa, Symbol* _context)
 	:root(pa.root)
 	, context(_context)
 	, tsys(pa.tsys)
+	, index(pa.index)
 	, recorder(pa.recorder)
+	, operatorCache(pa.operatorCache)
+	, recovery(pa.recovery)
+	, partition(pa.partition)
 {
 }
 
+/***********************************************************************
+ParsingRecovery
+***********************************************************************/
+
+// Wall time is measured once every ClockInterval checks
+static const vint ClockInterval = 64;
+
+ParsingRecovery::ParsingRecovery()
+{
+	for (vint i = 0; i < (vint)ParsingBudget::Count; i++)
+	{
+		used[i] = 0;
+		limits[i] = -1;
+	}
+}
+
+void ParsingRecovery::Exceed(ParsingBudget budget)
+{
+	throw ParsingBudgetExceededException{ budget };
+}
+
+void ParsingRecovery::Start(const ParsingArguments& pa)
+{
+	started = true;
+	for (vint i = 0; i < (vint)ParsingBudget::Count; i++)
+	{
+		used[i] = 0;
+	}
+	droppedFunctionTypes = 0;
+	startMicroseconds = limits[(vint)ParsingBudget::Microseconds] == -1 ? 0 : GetMicroseconds();
+	startTsys = pa.tsys->Count();
+	clockCountdown = ClockInterval;
+}
+
+void ParsingRecovery::Stop()
+{
+	started = false;
+}
+
+void ParsingRecovery::Consume(const ParsingArguments& pa, ParsingBudget budget, vint amount)
+{
+	if (!started) return;
+
+	auto& usedBudget = used[(vint)budget];
+	usedBudget += amount;
+	if (limits[(vint)budget] != -1 && usedBudget > limits[(vint)budget])
+	{
+		Exceed(budget);
+	}
+
+	if (limits[(vint)ParsingBudget::Tsys] != -1)
+	{
+		auto& usedTsys = used[(vint)ParsingBudget::Tsys];
+		usedTsys = pa.tsys->Count() - startTsys;
+		if (usedTsys > limits[(vint)ParsingBudget::Tsys])
+		{
+			Exceed(ParsingBudget::Tsys);
+		}
+	}
+
+	if (limits[(vint)ParsingBudget::Microseconds] != -1 && --clockCountdown == 0)
+	{
+		clockCountdown = ClockInterval;
+		auto& usedMicroseconds = used[(vint)ParsingBudget::Microseconds];
+		usedMicroseconds = GetMicroseconds() - startMicroseconds;
+		if (usedMicroseconds > limits[(vint)ParsingBudget::Microseconds])
+		{
+			Exceed(ParsingBudget::Microseconds);
+		}
+	}
+}
+
+void ParsingRecovery::Abandon(ParsingBudget budget, Ptr<CppTokenCursor> start)
+{
+	ParsingDiagnostic diagnostic;
+	diagnostic.budget = budget;
+	diagnostic.used = used[(vint)budget];
+	if (start)
+	{
+		diagnostic.start = start->token.start;
+		diagnostic.row = start->token.rowStart;
+		diagnostic.column = start->token.columnStart;
+	}
+	diagnostics.Add(diagnostic);
+}
+
+void ParsingRecovery::AbandonSyntaxError(Ptr<CppTokenCursor> position, Ptr<CppTokenCursor> start)
+{
+	ParsingDiagnostic diagnostic;
+	diagnostic.kind = ParsingDiagnosticKind::SyntaxError;
+	if (start)
+	{
+		diagnostic.start = start->token.start;
+		diagnostic.row = start->token.rowStart;
+		diagnostic.column = start->token.columnStart;
+	}
+	if (position)
+	{
+		diagnostic.errorStart = position->token.start;
+		diagnostic.errorRow = position->token.rowStart;
+		diagnostic.errorColumn = position->token.columnStart;
+	}
+	diagnostics.Add(diagnostic);
+}
+
+void ParsingRecovery::DropFunctionTypes(vint count)
+{
+	droppedFunctionTypes += count;
+}
+
+void ParsingRecovery::Complete(Ptr<CppTokenCursor> start)
+{
+	if (droppedFunctionTypes == 0) return;
+
+	ParsingDiagnostic diagnostic;
+	diagnostic.kind = ParsingDiagnosticKind::FunctionTypesTruncated;
+	diagnostic.used = droppedFunctionTypes;
+	if (start)
+	{
+		diagnostic.start = start->token.start;
+		diagnostic.row = start->token.rowStart;
+		diagnostic.column = start->token.columnStart;
+	}
+	diagnostics.Add(diagnostic);
+	droppedFunctionTypes = 0;
+}
+
 /***********************************************************************
 ParsingArguments
 ***********************************************************************/
 
 Ptr<Program> ParseProgram(const ParsingArguments& pa, Ptr<CppTokenCursor>& cursor)
 {
+	CPPDOC_TRACE_SCOPE(L"ParseProgram");
 	auto program = MakePtr<Program>();
-	while (cursor)
+	try
+	{
+		while (cursor)
+		{
+			CPPDOC_TRACE_SCOPE(L"ParseDeclaration");
+#ifdef CPPDOC_TRACE
+			vint declCount = program->decls.Count();
+#endif
+			ParseNamespaceMember(pa, cursor, program->decls);
+			CPPDOC_TRACE_DETAIL(declCount < program->decls.Count() ? program->decls[declCount]->name.name : WString::Empty);
+		}
+	}
+	catch (...)
 	{
-		ParseDeclaration(pa, cursor, program->decls);
+		// budgets only apply when parsing declarations
+		if (pa.recovery) pa.recovery->Stop();
+		throw;
 	}
+	if (pa.recovery) pa.recovery->Stop();
 	return program;
 }
\ No newline at end of file
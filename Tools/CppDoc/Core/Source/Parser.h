@@ -4,11 +4,41 @@
 #include "Lexer.h"
 #include "Ast.h"
 #include "TypeSystem.h"
+#include "Statistics.h"
+#include "Trace.h"
 
 /***********************************************************************
 Symbol
 ***********************************************************************/
 
+class FunctionType;
+
+// user-defined conversions of a class, resolved against a specific ITsysAlloc
+class ClassConversionTable : public Object
+{
+public:
+	ITsysAlloc*								tsys = nullptr;
+	vint									tsysVersion = 0;	// the version of tsys when the table is built
+	List<Tuple<Ptr<FunctionType>, ITsys*>>	typeOps;		// non-explicit operator TYPE() before the first explicit one, one item per resolved target type
+	List<ITsys*>							ctorSources;	// single-argument constructors before the first explicit one, one item per resolved parameter type
+};
+
+// functions of a scope bucketed by the number of parameters, one overload set per name
+class OverloadArityTable : public Object
+{
+public:
+	class OverloadSet : public Object
+	{
+	public:
+		Group<vint, Symbol*>				fixedArity;		// functions without ellipsis, keyed by the number of parameters
+		vint								maxDefaultParameterCount = 0;	// among fixedArity
+		List<Symbol*>						ellipsis;		// functions with ellipsis
+		List<Symbol*>						others;			// anything that is not a function, e.g. a variable of a class with operator()
+	};
+
+	Dictionary<WString, Ptr<OverloadSet>>	overloadSets;	// built when a name is called, removed when a symbol of the name is added
+};
+
 class Symbol : public Object
 {
 	using SymbolGroup = Group<WString, Ptr<Symbol>>;
@@ -21,6 +51,8 @@ public:
 	SymbolGroup				children;
 
 	Ptr<TypeTsysList>		resolvedTypes;	// only for Forward(Variable|Function)Declaration of which has a pending type
+	Ptr<ClassConversionTable>	conversionTable;	// only for ClassDeclaration, built when testing user-defined conversions
+	Ptr<OverloadArityTable>	overloadArityTable;	// built when calling functions of this scope by name
 
 	bool					isForwardDeclaration = false;
 	Symbol*					forwardDeclarationRoot = nullptr;
@@ -30,8 +62,12 @@ public:
 	SymbolPtrList			specializations;
 
 	SymbolPtrList			usingNss;
+	vint					descendantVersion = 0;	// increased when any symbol is added to this scope or its descendants
+	vint					operatorVersion = 0;	// increased when anything that changes operator resolving is added to this scope or its descendants
 
+	CPPDOC_ALLOCATION_OPERATORS
 	void					Add(Ptr<Symbol> child);
+	void					IncreaseOperatorVersion();
 
 	Symbol* CreateDeclSymbol(Ptr<Declaration> _decl, Symbol* _specializationRoot = nullptr)
 	{
@@ -84,6 +120,38 @@ public:
 	virtual void			ExpectValueButType(CppName& name, Ptr<Resolving> resolving) = 0;
 };
 
+enum class IndexReason
+{
+	Resolved,
+	ExpectValueButType,
+};
+
+// all resolved names in a parsing session, one column per field, stored in the order of being resolved
+class IndexTable : public Object
+{
+	using AtomMap = Dictionary<WString, vint>;
+public:
+	List<WString>			atoms;			// name of each atom
+	AtomMap					atomIds;		// name -> index in atoms
+
+	List<vint>				tokenStarts;	// offset of the first name token
+	List<vint>				tokenLengths;	// length of the first name token
+	List<vint>				tokenRows;		// row of the first name token
+	List<vint>				tokenColumns;	// column of the first name token
+	List<vint>				nameAtoms;		// index in atoms
+	List<IndexReason>		reasons;
+	List<vint>				symbolStarts;	// index of the first resolved symbol in symbols
+	List<vint>				symbolCounts;	// number of resolved symbols
+	List<Symbol*>			symbols;		// resolved symbols of all names
+
+	vint					Count()const { return nameAtoms.Count(); }
+	vint					GetAtom(const WString& name);
+	void					Add(const CppName& name, const Resolving* resolving, IndexReason reason);
+	void					Truncate(vint count);	// keep the first count items, atoms are not removed
+	void					Append(const IndexTable& table, const Dictionary<Symbol*, Symbol*>& replacedSymbols);	// append all items, replacing resolved symbols in the dictionary
+	void					Clear();
+};
+
 enum class DeclaratorRestriction
 {
 	Zero,
@@ -98,29 +166,126 @@ enum class InitializerRestriction
 	Optional,
 };
 
+// user-defined operator resolving results, shared by all ParsingArguments derived from the same root
+class OperatorResolvingCache : public Object
+{
+	using Key = Tuple<WString, ExprTsysItem, ExprTsysItem, Symbol*>;
+	using Value = Tuple<bool, Ptr<ExprTsysList>>;
+public:
+	vint					symbolVersion = 0;		// root->operatorVersion when results were filled
+	Dictionary<Key, Value>	results;				// (operator name, left operand, right operand, context) -> (any operator found, result types)
+};
+
+enum class ParsingBudget
+{
+	Rewinds,				// StopParsingException caught to try another way of parsing
+	OverloadCandidates,		// functions examined by overload resolution
+	Tsys,					// types created in ITsysAlloc
+	Microseconds,			// wall time
+	Count,
+};
+
+struct ParsingBudgetExceededException
+{
+	ParsingBudget			budget;
+};
+
+enum class ParsingDiagnosticKind
+{
+	BudgetExceeded,
+	SyntaxError,
+	FunctionTypesTruncated,
+};
+
+// a declaration at namespace scope that is abandoned, or parsed with function types truncated
+struct ParsingDiagnostic
+{
+	ParsingDiagnosticKind	kind = ParsingDiagnosticKind::BudgetExceeded;
+	ParsingBudget			budget = ParsingBudget::Count;	// the exceeded budget, only for BudgetExceeded
+	vint64_t				used = 0;		// the exceeded budget consumed by the declaration, or function types not created for FunctionTypesTruncated
+	vint					start = -1;		// offset of the first token of the declaration
+	vint					row = -1;
+	vint					column = -1;
+	vint					errorStart = -1;	// offset of the token causing the syntax error, -1 for the end of the input
+	vint					errorRow = -1;
+	vint					errorColumn = -1;
+};
+
+// budgets of each declaration at namespace scope, shared by all ParsingArguments derived from the same root
+// a declaration exceeding any budget is skipped to its end, parsing continues from the next declaration
+// when skipSyntaxErrors is true, a declaration with a syntax error is also skipped instead of failing the whole program
+// when functionTypeExpansionLimit is not -1, a function type with ambiguous return or parameter types creates at most that many function types
+class ParsingRecovery : public Object
+{
+protected:
+	bool					started = false;
+	vint64_t				used[(vint)ParsingBudget::Count];
+	vint64_t				droppedFunctionTypes = 0;
+	vint64_t				startMicroseconds = 0;
+	vint					startTsys = 0;
+	vint					clockCountdown = 0;	// the clock is read when it becomes 0
+
+	void					Exceed(ParsingBudget budget);
+public:
+	vint64_t				limits[(vint)ParsingBudget::Count];	// -1 for no limit
+	bool					skipSyntaxErrors = false;
+	vint					functionTypeExpansionLimit = -1;
+	List<ParsingDiagnostic>	diagnostics;
+
+	ParsingRecovery();
+
+	void					Start(const ParsingArguments& pa);
+	void					Stop();
+	void					Consume(const ParsingArguments& pa, ParsingBudget budget, vint amount);	// check budgets and throw ParsingBudgetExceededException if any is exceeded
+	void					Abandon(ParsingBudget budget, Ptr<CppTokenCursor> start);				// record a diagnostic for the declaration beginning at start
+	void					AbandonSyntaxError(Ptr<CppTokenCursor> position, Ptr<CppTokenCursor> start);	// position is where StopParsingException is thrown
+	void					DropFunctionTypes(vint count);											// count function types not created because of functionTypeExpansionLimit
+	void					Complete(Ptr<CppTokenCursor> start);									// record a diagnostic if function types are dropped in the declaration beginning at start
+};
+
+// names looked up in namespaces when parsing a partition of a program, see ParallelParser
+class ParsingPartition : public Object
+{
+public:
+	Group<WString, Symbol*>	lookups;		// name -> namespaces or the root searched for the name
+
+	void					Lookup(Symbol* scope, const WString& name);	// scopes other than namespaces and the root are ignored
+};
+
 struct ParsingArguments
 {
 	Ptr<Symbol>				root;
 	Symbol*					context = nullptr;
 	Ptr<ITsysAlloc>			tsys;
+	Ptr<IndexTable>			index;
 	Ptr<IIndexRecorder>		recorder;
+	Ptr<OperatorResolvingCache>	operatorCache;
+	Ptr<ParsingRecovery>	recovery;		// nullptr if declarations are never abandoned
+	Ptr<ParsingPartition>	partition;		// nullptr unless parsing a partition of a program
 
 	ParsingArguments();
 	ParsingArguments(Ptr<Symbol> _root, Ptr<ITsysAlloc> _tsys, Ptr<IIndexRecorder> _recorder);
 	ParsingArguments(const ParsingArguments& pa, Symbol* _context);
 };
 
+// Consume a budget of the declaration being parsed, amount could be 0 for only checking wall time and types
+inline void ConsumeBudget(const ParsingArguments& pa, ParsingBudget budget, vint amount = 1)
+{
+	if (pa.recovery) pa.recovery->Consume(pa, budget, amount);
+}
+
 struct StopParsingException
 {
 	Ptr<CppTokenCursor>		position;
 
-	StopParsingException() {}
-	StopParsingException(Ptr<CppTokenCursor> _position) :position(_position) {}
+	StopParsingException() { CPPDOC_COUNT(stopParsingThrows); }
+	StopParsingException(Ptr<CppTokenCursor> _position) :position(_position) { CPPDOC_COUNT(stopParsingThrows); }
 };
 
 class FunctionType;
 class ClassDeclaration;
 class VariableDeclaration;
+class NamespaceDeclaration;
 
 // Parser_ResolveSymbol.cpp
 enum class SearchPolicy
@@ -141,6 +306,9 @@ struct ResolveSymbolResult
 extern ResolveSymbolResult			ResolveSymbol(const ParsingArguments& pa, CppName& name, SearchPolicy policy, ResolveSymbolResult input = {});
 extern ResolveSymbolResult			ResolveChildSymbol(const ParsingArguments& pa, Ptr<Type> classType, CppName& name, ResolveSymbolResult input = {});
 
+// Parser_Index.cpp
+extern void							IndexResolving(const ParsingArguments& pa, CppName& name, const Ptr<Resolving>& resolving, IndexReason reason);
+
 // Parser_Misc.cpp
 extern bool							SkipSpecifiers(Ptr<CppTokenCursor>& cursor);
 extern bool							ParseCppName(CppName& name, Ptr<CppTokenCursor>& cursor, bool forceSpecialMethod = false);
@@ -189,6 +357,10 @@ extern Ptr<Type>					ParseType(const ParsingArguments& pa, Ptr<CppTokenCursor>&
 
 // Parser_Declaration.cpp
 extern void							ParseDeclaration(const ParsingArguments& pa, Ptr<CppTokenCursor>& cursor, List<Ptr<Declaration>>& output);
+extern void							SkipDeclaration(Ptr<CppTokenCursor>& cursor);
+extern void							ParseNamespaceMember(const ParsingArguments& pa, Ptr<CppTokenCursor>& cursor, List<Ptr<Declaration>>& output);
+extern Symbol*						ParseNamespaceHead(const ParsingArguments& pa, Ptr<CppTokenCursor>& cursor, Ptr<NamespaceDeclaration>& topDecl, Ptr<NamespaceDeclaration>& contextDecl);
+extern void							ConnectForwardDeclarations(Symbol* scope, Symbol* symbol);
 extern void							BuildVariables(List<Ptr<Declarator>>& declarators, List<Ptr<VariableDeclaration>>& varDecls);
 extern void							BuildSymbols(const ParsingArguments& pa, List<Ptr<VariableDeclaration>>& varDecls);
 extern void							BuildVariablesAndSymbols(const ParsingArguments& pa, List<Ptr<Declarator>>& declarators, List<Ptr<VariableDeclaration>>& varDecls);
@@ -314,4 +486,31 @@ __forceinline void SkipToken(Ptr<CppTokenCursor>& cursor)
 	}
 }
 
+// Get the start of the next token, -1 if there is no more token
+__forceinline vint GetRangeStart(Ptr<CppTokenCursor>& cursor)
+{
+	return cursor ? cursor->token.start : -1;
+}
+
+// Record DOCUMENT tokens before the first token of a declaration, if the declaration does not have them
+template<typename T>
+__forceinline void FillDocument(T* decl, Ptr<CppTokenCursor>& start)
+{
+	if (decl && start && decl->document.start == -1)
+	{
+		decl->document = start->document;
+	}
+}
+
+// Record the range from start to the last consumed token, if the node does not have one
+template<typename T>
+__forceinline void FillRange(T* node, vint start, Ptr<CppTokenCursor>& cursor)
+{
+	if (node && node->range.start == -1)
+	{
+		node->range.start = start;
+		node->range.end = cursor ? cursor->previousEnd : -1;
+	}
+}
+
 #endif
\ No newline at end of file
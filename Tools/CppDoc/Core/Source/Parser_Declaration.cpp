@@ -51,7 +51,7 @@ void SearchForwards(Symbol* scope, Symbol* symbol, Ptr<CppTokenCursor> cursor, S
 	{
 		auto& sibling = siblings[i];
 		bool sameCategory = ForwardPolicy<TForward>::IsSameCategory(symbol, sibling.Obj());
-		if (sibling->decls[0].Cast<typename TForward::ForwardRootType>())
+		if (sibling->decls[0].template Cast<typename TForward::ForwardRootType>())
 		{
 			if (sameCategory)
 			{
@@ -95,6 +95,27 @@ void ConnectForwards(Symbol* scope, Symbol* symbol, Ptr<CppTokenCursor> cursor)
 	}
 }
 
+void ConnectForwardDeclarations(Symbol* scope, Symbol* symbol)
+{
+	auto decl = symbol->decls[0];
+	if (decl.Cast<ForwardClassDeclaration>())
+	{
+		ConnectForwards<ForwardClassDeclaration>(scope, symbol, nullptr);
+	}
+	else if (decl.Cast<ForwardEnumDeclaration>())
+	{
+		ConnectForwards<ForwardEnumDeclaration>(scope, symbol, nullptr);
+	}
+	else if (decl.Cast<ForwardFunctionDeclaration>())
+	{
+		ConnectForwards<ForwardFunctionDeclaration>(scope, symbol, nullptr);
+	}
+	else if (decl.Cast<ForwardVariableDeclaration>())
+	{
+		ConnectForwards<ForwardVariableDeclaration>(scope, symbol, nullptr);
+	}
+}
+
 /***********************************************************************
 ParseDeclaration
 ***********************************************************************/
@@ -118,74 +139,82 @@ bool IsPendingType(Ptr<Type> type)
 	return false;
 }
 
-void ParseDeclaration(const ParsingArguments& pa, Ptr<CppTokenCursor>& cursor, List<Ptr<Declaration>>& output)
+Symbol* ParseNamespaceHead(const ParsingArguments& pa, Ptr<CppTokenCursor>& cursor, Ptr<NamespaceDeclaration>& topDecl, Ptr<NamespaceDeclaration>& contextDecl)
 {
-	while (SkipSpecifiers(cursor));
-
-	bool decoratorFriend = TestToken(cursor, CppTokens::DECL_FRIEND);
+	// NAME { :: NAME ...} {
+	auto contextSymbol = pa.context;
 
-	if (TestToken(cursor, CppTokens::DECL_NAMESPACE))
+	while (cursor)
 	{
-		// namespace NAME { :: NAME ...} { DECLARATION ...}
-		auto contextSymbol = pa.context;
-		Ptr<NamespaceDeclaration> topDecl;
-		Ptr<NamespaceDeclaration> contextDecl;
+		// create AST
+		auto decl = MakePtr<NamespaceDeclaration>();
+		if (!topDecl)
+		{
+			topDecl = decl;
+		}
+		if (contextDecl)
+		{
+			contextDecl->decls.Add(decl);
+		}
+		contextDecl = decl;
 
-		while (cursor)
+		if (ParseCppName(decl->name, cursor))
 		{
-			// create AST
-			auto decl = MakePtr<NamespaceDeclaration>();
-			if (!topDecl)
+			// ensure all other overloadings are namespaces, and merge the scope with them
+			vint index = contextSymbol->children.Keys().IndexOf(decl->name.name);
+			if (index == -1)
 			{
-				topDecl = decl;
+				contextSymbol = contextSymbol->CreateDeclSymbol(decl);
 			}
-			if (contextDecl)
-			{
-				contextDecl->decls.Add(decl);
-			}
-			contextDecl = decl;
-
-			if (ParseCppName(decl->name, cursor))
+			else
 			{
-				// ensure all other overloadings are namespaces, and merge the scope with them
-				vint index = contextSymbol->children.Keys().IndexOf(decl->name.name);
-				if (index == -1)
+				auto& symbols = contextSymbol->children.GetByIndex(index);
+				if (symbols.Count() == 1 && symbols[0]->decls[0].Cast<NamespaceDeclaration>())
 				{
-					contextSymbol = contextSymbol->CreateDeclSymbol(decl);
+					contextSymbol = symbols[0].Obj();
+					contextSymbol->decls.Add(decl);
 				}
 				else
 				{
-					auto& symbols = contextSymbol->children.GetByIndex(index);
-					if (symbols.Count() == 1 && symbols[0]->decls[0].Cast<NamespaceDeclaration>())
-					{
-						contextSymbol = symbols[0].Obj();
-						contextSymbol->decls.Add(decl);
-					}
-					else
-					{
-						throw StopParsingException(cursor);
-					}
+					throw StopParsingException(cursor);
 				}
 			}
-			else
-			{
-				throw StopParsingException(cursor);
-			}
+		}
+		else
+		{
+			throw StopParsingException(cursor);
+		}
 
-			if (TestToken(cursor, CppTokens::LBRACE))
-			{
-				break;
-			}
-			else
-			{
-				RequireToken(cursor, CppTokens::COLON, CppTokens::COLON);
-			}
+		if (TestToken(cursor, CppTokens::LBRACE))
+		{
+			break;
+		}
+		else
+		{
+			RequireToken(cursor, CppTokens::COLON, CppTokens::COLON);
 		}
+	}
+
+	return contextSymbol;
+}
+
+static void ParseDeclarationInternal(const ParsingArguments& pa, Ptr<CppTokenCursor>& cursor, List<Ptr<Declaration>>& output)
+{
+	while (SkipSpecifiers(cursor));
+
+	bool decoratorFriend = TestToken(cursor, CppTokens::DECL_FRIEND);
+
+	if (TestToken(cursor, CppTokens::DECL_NAMESPACE))
+	{
+		// namespace NAME { :: NAME ...} { DECLARATION ...}
+		Ptr<NamespaceDeclaration> topDecl;
+		Ptr<NamespaceDeclaration> contextDecl;
+		auto contextSymbol = ParseNamespaceHead(pa, cursor, topDecl, contextDecl);
 
 		ParsingArguments newPa(pa, contextSymbol);
 		while (!TestToken(cursor, CppTokens::RBRACE))
 		{
-			ParseDeclaration(newPa, cursor, contextDecl->decls);
+			ParseNamespaceMember(newPa, cursor, contextDecl->decls);
 		}
 
 		output.Add(topDecl);
@@ -405,6 +434,7 @@ void ParseDeclaration(const ParsingArguments& pa, Ptr<CppTokenCursor>& cursor, L
 				if (pa.context && !(pa.context->usingNss.Contains(symbol)))
 				{
 					pa.context->usingNss.Add(symbol);
+					pa.context->IncreaseOperatorVersion();
 				}
 			}
 			else
@@ -552,10 +582,12 @@ void ParseDeclaration(const ParsingArguments& pa, Ptr<CppTokenCursor>& cursor, L
 				NAME->decoratorInline = decoratorInline;\
 				NAME->decoratorForceInline = decoratorForceInline;\
 				NAME->decoratorAbstract = decoratorAbstract;\
-				NAME->needResolveTypeFromStatement = needResolveTypeFromStatement\
+				NAME->needResolveTypeFromStatement = needResolveTypeFromStatement;\
+				NAME->defaultParameterCount = defaultParameterCount\
 
 				bool hasStat = TestToken(cursor, CppTokens::LBRACE, false);
 				bool needResolveTypeFromStatement = false;
+				vint defaultParameterCount = 0;
 				if (auto funcType = GetTypeWithoutMemberAndCC(declarator->type).Cast<FunctionType>())
 				{
 					needResolveTypeFromStatement = IsPendingType(funcType->returnType) && (!funcType->decoratorReturnType || IsPendingType(funcType->decoratorReturnType));
@@ -563,6 +595,15 @@ void ParseDeclaration(const ParsingArguments& pa, Ptr<CppTokenCursor>& cursor, L
 					{
 						throw StopParsingException(cursor);
 					}
+
+					for (vint i = 0; i < funcType->parameters.Count(); i++)
+					{
+						if (funcType->parameters[i]->initializer)
+						{
+							defaultParameterCount = funcType->parameters.Count() - i;
+							break;
+						}
+					}
 				}
 
 				auto context = containingClassForMember ? containingClassForMember->symbol : pa.context;
@@ -572,6 +613,8 @@ void ParseDeclaration(const ParsingArguments& pa, Ptr<CppTokenCursor>& cursor, L
 					auto decl = MakePtr<FunctionDeclaration>();
 					FILL_FUNCTION(decl);
 					{
+						CPPDOC_TRACE_SCOPE(L"ParseStat");
+						CPPDOC_TRACE_DETAIL(decl->name.name);
 						ParsingArguments statPa(pa, context);
 						decl->statement = ParseStat(statPa, cursor);
 					}
@@ -665,6 +708,202 @@ void ParseDeclaration(const ParsingArguments& pa, Ptr<CppTokenCursor>& cursor, L
 	}
 }
 
+void ParseDeclaration(const ParsingArguments& pa, Ptr<CppTokenCursor>& cursor, List<Ptr<Declaration>>& output)
+{
+	// all declarations produced by one call share the same range and document, e.g. "int a, b;"
+	auto startCursor = cursor;
+	vint start = GetRangeStart(cursor);
+	vint first = output.Count();
+	ParseDeclarationInternal(pa, cursor, output);
+	for (vint i = first; i < output.Count(); i++)
+	{
+		FillRange(output[i].Obj(), start, cursor);
+		FillDocument(output[i].Obj(), startCursor);
+	}
+}
+
+/***********************************************************************
+SkipDeclaration
+***********************************************************************/
+
+void SkipDeclaration(Ptr<CppTokenCursor>& cursor)
+{
+	// only tokens at depth 0 decide where the declaration ends, brackets are not checked for matching
+	vint depth = 0;
+	bool skipped = false;
+	bool bodyBrace = false;			// the opened brace at depth 0 ends the declaration, e.g. a function body or a namespace
+	bool blockDeclaration = false;	// namespace NAME { or extern "C" {
+	bool classKey = false;			// class, struct, union or enum before any parenthesis
+	bool parenthesis = false;		// a parenthesis, e.g. function parameters
+	bool assignment = false;		// = after a name, e.g. an initializer
+	bool arrow = false;				// -> after a parenthesis, e.g. a trailing return type
+	bool ctorInit = false;			// : after a parenthesis, e.g. a constructor initializer list
+	Ptr<CppTokenCursor> previous;
+
+	while (cursor)
+	{
+		auto token = (CppTokens)cursor->token.token;
+		auto previousToken = previous ? (CppTokens)previous->token.token : CppTokens::SPACE;
+
+		if (depth == 0)
+		{
+			switch (token)
+			{
+			case CppTokens::SEMICOLON:
+				cursor = cursor->Next();
+				return;
+			case CppTokens::RBRACE:
+			case CppTokens::RPARENTHESIS:
+			case CppTokens::RBRACKET:
+				// closing the enclosing scope, it is skipped only when it is the first token
+				if (!skipped) cursor = cursor->Next();
+				return;
+			case CppTokens::DECL_TEMPLATE:
+				// template<...> is skipped, so that class in template arguments is not a class key
+				previous = cursor;
+				cursor = cursor->Next();
+				if (TestToken(cursor, CppTokens::LT))
+				{
+					vint angles = 1;
+					vint parentheses = 0;
+					while (cursor && angles > 0)
+					{
+						switch ((CppTokens)cursor->token.token)
+						{
+						case CppTokens::LPARENTHESIS: parentheses++; break;
+						case CppTokens::RPARENTHESIS: parentheses--; break;
+						case CppTokens::LT: if (parentheses == 0) angles++; break;
+						case CppTokens::GT: if (parentheses == 0) angles--; break;
+						default:;
+						}
+						previous = cursor;
+						cursor = cursor->Next();
+					}
+				}
+				skipped = true;
+				continue;
+			case CppTokens::DECL_NAMESPACE:
+				blockDeclaration = true;
+				break;
+			case CppTokens::STRING:
+				if (previousToken == CppTokens::DECL_EXTERN) blockDeclaration = true;
+				break;
+			case CppTokens::DECL_CLASS:
+			case CppTokens::DECL_STRUCT:
+			case CppTokens::DECL_UNION:
+			case CppTokens::DECL_ENUM:
+				if (!parenthesis) classKey = true;
+				break;
+			case CppTokens::EQ:
+				if (previousToken == CppTokens::ID || previousToken == CppTokens::RBRACKET) assignment = true;
+				break;
+			case CppTokens::GT:
+				if (parenthesis && previousToken == CppTokens::SUB) arrow = true;
+				break;
+			case CppTokens::COLON:
+				if (previousToken == CppTokens::RPARENTHESIS) ctorInit = true;
+				break;
+			case CppTokens::LPARENTHESIS:
+				parenthesis = true;
+				break;
+			case CppTokens::LBRACE:
+				if (blockDeclaration)
+				{
+					bodyBrace = true;
+				}
+				else if (assignment || classKey || !parenthesis)
+				{
+					bodyBrace = false;
+				}
+				else if (previousToken == CppTokens::ID || previousToken == CppTokens::GT)
+				{
+					// NAME { is a member initializer or a trailing return type
+					bodyBrace = arrow && !ctorInit;
+				}
+				else
+				{
+					bodyBrace = true;
+				}
+				break;
+			default:;
+			}
+		}
+
+		switch (token)
+		{
+		case CppTokens::LBRACE:
+		case CppTokens::LPARENTHESIS:
+		case CppTokens::LBRACKET:
+			depth++;
+			break;
+		case CppTokens::RBRACE:
+		case CppTokens::RPARENTHESIS:
+		case CppTokens::RBRACKET:
+			if (depth > 0 && --depth == 0 && token == CppTokens::RBRACE && bodyBrace)
+			{
+				cursor = cursor->Next();
+				return;
+			}
+			break;
+		default:;
+		}
+
+		skipped = true;
+		previous = cursor;
+		cursor = cursor->Next();
+	}
+}
+
+/***********************************************************************
+ParseNamespaceMember
+***********************************************************************/
+
+void ParseNamespaceMember(const ParsingArguments& pa, Ptr<CppTokenCursor>& cursor, List<Ptr<Declaration>>& output)
+{
+	if (!pa.recovery)
+	{
+		ParseDeclaration(pa, cursor, output);
+		return;
+	}
+
+	auto start = cursor;
+	vint first = output.Count();
+	pa.recovery->Start(pa);
+	try
+	{
+		ParseDeclaration(pa, cursor, output);
+		pa.recovery->Complete(start);
+	}
+	catch (const ParsingBudgetExceededException& e)
+	{
+		pa.recovery->Abandon(e.budget, start);
+		cursor = start;
+		SkipDeclaration(cursor);
+
+		// declarations created before the budget is exceeded are kept with the range of skipped tokens
+		for (vint i = first; i < output.Count(); i++)
+		{
+			FillRange(output[i].Obj(), GetRangeStart(start), cursor);
+			FillDocument(output[i].Obj(), start);
+		}
+	}
+	catch (const StopParsingException& e)
+	{
+		// nothing could be skipped at the end of the input, the enclosing declaration handles it
+		if (!pa.recovery->skipSyntaxErrors || !start) throw;
+
+		pa.recovery->AbandonSyntaxError(e.position, start);
+		cursor = start;
+		SkipDeclaration(cursor);
+
+		for (vint i = first; i < output.Count(); i++)
+		{
+			FillRange(output[i].Obj(), GetRangeStart(start), cursor);
+			FillDocument(output[i].Obj(), start);
+		}
+	}
+}
+
 /***********************************************************************
 BuildVariables
 ***********************************************************************/
@@ -338,6 +338,8 @@ Ptr<Type> ParseTypeBeforeDeclarator(const ParsingArguments& pa, Ptr<Type> baseli
 			}
 			catch (const StopParsingException&)
 			{
+				CPPDOC_COUNT_REWIND();
+				ConsumeBudget(pa, ParsingBudget::Rewinds);
 				cursor = oldCursor;
 				classType = nullptr;
 			}
@@ -445,6 +447,8 @@ bool ParseSingleDeclarator_Function(const ParsingArguments& pa, Ptr<Declarator>
 			}
 			catch (const StopParsingException&)
 			{
+				CPPDOC_COUNT_REWIND();
+				ConsumeBudget(pa, ParsingBudget::Rewinds);
 				cursor = oldCursor;
 			}
 		}
@@ -686,6 +690,8 @@ Ptr<Declarator> ParseSingleDeclarator(const ParsingArguments& pa, Ptr<Type> base
 			}
 			catch (const StopParsingException&)
 			{
+				CPPDOC_COUNT_REWIND();
+				ConsumeBudget(pa, ParsingBudget::Rewinds);
 				cursor = oldCursor;
 				goto READY_FOR_ARRAY_OR_FUNCTION;
 			}
@@ -818,6 +824,8 @@ void ParseDeclaratorWithInitializer(const ParsingArguments& pa, Ptr<Type> typeRe
 				}
 				catch (const StopParsingException&)
 				{
+					CPPDOC_COUNT_REWIND();
+					ConsumeBudget(pa, ParsingBudget::Rewinds);
 					if (isFunction)
 					{
 						// { could be the beginning of a statement
@@ -861,6 +869,8 @@ void ParseDeclarator(const ParsingArguments& pa, const ParsingDeclaratorArgument
 			}
 			catch (const StopParsingException&)
 			{
+				CPPDOC_COUNT_REWIND();
+				ConsumeBudget(pa, ParsingBudget::Rewinds);
 				// ignore it if we failed
 				goto TRY_NORMAL_DECLARATOR;
 			}
@@ -95,10 +95,7 @@ Ptr<IdExpr> ParseIdExpr(const ParsingArguments& pa, Ptr<CppTokenCursor>& cursor)
 			auto type = MakePtr<IdExpr>();
 			type->name = cppName;
 			type->resolving = rsr.values;
-			if (pa.recorder)
-			{
-				pa.recorder->Index(type->name, type->resolving);
-			}
+			IndexResolving(pa, type->name, type->resolving, IndexReason::Resolved);
 			return type;
 		}
 	}
@@ -121,9 +118,9 @@ Ptr<ChildExpr> TryParseChildExpr(const ParsingArguments& pa, Ptr<Type> classType
 			type->classType = classType;
 			type->name = cppName;
 			type->resolving = rsr.values;
-			if (pa.recorder && type->resolving)
+			if (type->resolving)
 			{
-				pa.recorder->Index(type->name, type->resolving);
+				IndexResolving(pa, type->name, type->resolving, IndexReason::Resolved);
 			}
 			return type;
 		}
@@ -225,6 +222,8 @@ Ptr<Expr> ParsePrimitiveExpr(const ParsingArguments& pa, Ptr<CppTokenCursor>& cu
 					}
 					catch (const StopParsingException&)
 					{
+						CPPDOC_COUNT_REWIND();
+						ConsumeBudget(pa, ParsingBudget::Rewinds);
 						cursor = oldCursor;
 					}
 				}
@@ -276,6 +275,8 @@ Ptr<Expr> ParsePrimitiveExpr(const ParsingArguments& pa, Ptr<CppTokenCursor>& cu
 			}
 			catch (const StopParsingException&)
 			{
+				CPPDOC_COUNT_REWIND();
+				ConsumeBudget(pa, ParsingBudget::Rewinds);
 				cursor = oldCursor;
 				goto GIVE_UP_CHILD_SYMBOL;
 			}
@@ -306,7 +307,9 @@ ParsePostfixUnaryExpr
 
 Ptr<Expr> ParsePostfixUnaryExpr(const ParsingArguments& pa, Ptr<CppTokenCursor>& cursor)
 {
+	vint start = GetRangeStart(cursor);
 	auto expr = ParsePrimitiveExpr(pa, cursor);
+	FillRange(expr.Obj(), start, cursor);
 	while (true)
 	{
 		if (!TestToken(cursor, CppTokens::DOT, CppTokens::MUL, false) && TestToken(cursor, CppTokens::DOT))
@@ -318,6 +321,7 @@ Ptr<Expr> ParsePostfixUnaryExpr(const ParsingArguments& pa, Ptr<CppTokenCursor>&
 			{
 				throw StopParsingException(cursor);
 			}
+			FillRange(newExpr.Obj(), start, cursor);
 			expr = newExpr;
 		}
 		else if (!TestToken(cursor, CppTokens::SUB, CppTokens::GT, CppTokens::MUL, false) && TestToken(cursor, CppTokens::SUB, CppTokens::GT))
@@ -329,6 +333,7 @@ Ptr<Expr> ParsePostfixUnaryExpr(const ParsingArguments& pa, Ptr<CppTokenCursor>&
 			{
 				throw StopParsingException(cursor);
 			}
+			FillRange(newExpr.Obj(), start, cursor);
 			expr = newExpr;
 		}
 		else if (TestToken(cursor, CppTokens::LBRACKET))
@@ -337,6 +342,7 @@ Ptr<Expr> ParsePostfixUnaryExpr(const ParsingArguments& pa, Ptr<CppTokenCursor>&
 			newExpr->expr = expr;
 			newExpr->index = ParseExpr(pa, true, cursor);
 			RequireToken(cursor, CppTokens::RBRACKET);
+			FillRange(newExpr.Obj(), start, cursor);
 			expr = newExpr;
 		}
 		else if (TestToken(cursor, CppTokens::LPARENTHESIS))
@@ -358,6 +364,7 @@ Ptr<Expr> ParsePostfixUnaryExpr(const ParsingArguments& pa, Ptr<CppTokenCursor>&
 					}
 				}
 			}
+			FillRange(newExpr.Obj(), start, cursor);
 			expr = newExpr;
 		}
 		else if (TestToken(cursor, CppTokens::ADD, CppTokens::ADD, false) || TestToken(cursor, CppTokens::SUB, CppTokens::SUB, false))
@@ -366,6 +373,7 @@ Ptr<Expr> ParsePostfixUnaryExpr(const ParsingArguments& pa, Ptr<CppTokenCursor>&
 			FillOperatorAndSkip(newExpr->opName, cursor, 2);
 			FillOperator(newExpr->opName, newExpr->op);
 			newExpr->operand = expr;
+			FillRange(newExpr.Obj(), start, cursor);
 			expr = newExpr;
 		}
 		else
@@ -382,6 +390,7 @@ ParsePrefixUnaryExpr
 
 Ptr<Expr> ParsePrefixUnaryExpr(const ParsingArguments& pa, Ptr<CppTokenCursor>& cursor)
 {
+	vint start = GetRangeStart(cursor);
 	if (TestToken(cursor, CppTokens::EXPR_SIZEOF))
 	{
 		auto newExpr = MakePtr<SizeofExpr>();
@@ -391,13 +400,17 @@ Ptr<Expr> ParsePrefixUnaryExpr(const ParsingArguments& pa, Ptr<CppTokenCursor>&
 			RequireToken(cursor, CppTokens::LPARENTHESIS);
 			newExpr->type = ParseType(pa, cursor);
 			RequireToken(cursor, CppTokens::RPARENTHESIS);
+			FillRange(newExpr.Obj(), start, cursor);
 			return newExpr;
 		}
 		catch (const StopParsingException&)
 		{
+			CPPDOC_COUNT_REWIND();
+			ConsumeBudget(pa, ParsingBudget::Rewinds);
 			cursor = oldCursor;
 		}
 		newExpr->expr = ParsePrefixUnaryExpr(pa, cursor);
+		FillRange(newExpr.Obj(), start, cursor);
 		return newExpr;
 	}
 	else if (TestToken(cursor, CppTokens::ADD, CppTokens::ADD, false) || TestToken(cursor, CppTokens::SUB, CppTokens::SUB, false))
@@ -406,6 +419,7 @@ Ptr<Expr> ParsePrefixUnaryExpr(const ParsingArguments& pa, Ptr<CppTokenCursor>&
 		FillOperatorAndSkip(newExpr->opName, cursor, 2);
 		FillOperator(newExpr->opName, newExpr->op);
 		newExpr->operand = ParsePrefixUnaryExpr(pa, cursor);
+		FillRange(newExpr.Obj(), start, cursor);
 		return newExpr;
 	}
 	else if (
@@ -420,6 +434,7 @@ Ptr<Expr> ParsePrefixUnaryExpr(const ParsingArguments& pa, Ptr<CppTokenCursor>&
 		FillOperatorAndSkip(newExpr->opName, cursor, 1);
 		FillOperator(newExpr->opName, newExpr->op);
 		newExpr->operand = ParsePrefixUnaryExpr(pa, cursor);
+		FillRange(newExpr.Obj(), start, cursor);
 		return newExpr;
 	}
 	else if (TestToken(cursor, CppTokens::NEW))
@@ -466,6 +481,7 @@ Ptr<Expr> ParsePrefixUnaryExpr(const ParsingArguments& pa, Ptr<CppTokenCursor>&
 			newExpr->arguments.Add(ParseExpr(pa, true, cursor));
 			RequireToken(cursor, CppTokens::RBRACKET);
 		}
+		FillRange(newExpr.Obj(), start, cursor);
 		return newExpr;
 	}
 	else if (TestToken(cursor, CppTokens::DELETE))
@@ -476,6 +492,7 @@ Ptr<Expr> ParsePrefixUnaryExpr(const ParsingArguments& pa, Ptr<CppTokenCursor>&
 			RequireToken(cursor, CppTokens::RBRACKET);
 		}
 		newExpr->expr = ParsePrefixUnaryExpr(pa, cursor);
+		FillRange(newExpr.Obj(), start, cursor);
 		return newExpr;
 	}
 	else
@@ -490,6 +507,8 @@ Ptr<Expr> ParsePrefixUnaryExpr(const ParsingArguments& pa, Ptr<CppTokenCursor>&
 		}
 		catch (const StopParsingException&)
 		{
+			CPPDOC_COUNT_REWIND();
+			ConsumeBudget(pa, ParsingBudget::Rewinds);
 			cursor = oldCursor;
 		}
 
@@ -499,6 +518,7 @@ Ptr<Expr> ParsePrefixUnaryExpr(const ParsingArguments& pa, Ptr<CppTokenCursor>&
 			newExpr->castType = CppCastType::CCast;
 			newExpr->type = type;
 			newExpr->expr = ParsePrefixUnaryExpr(pa, cursor);
+			FillRange(newExpr.Obj(), start, cursor);
 			return newExpr;
 		}
 		else
@@ -512,6 +532,18 @@ Ptr<Expr> ParsePrefixUnaryExpr(const ParsingArguments& pa, Ptr<CppTokenCursor>&
 ParseBinaryExpr
 ***********************************************************************/
 
+static void FillBinaryExprRange(Expr* expr)
+{
+	auto binary = dynamic_cast<BinaryExpr*>(expr);
+	if (binary && binary->range.start == -1)
+	{
+		FillBinaryExprRange(binary->left.Obj());
+		FillBinaryExprRange(binary->right.Obj());
+		binary->range.start = binary->left->range.start;
+		binary->range.end = binary->right->range.end;
+	}
+}
+
 Ptr<Expr> ParseBinaryExpr(const ParsingArguments& pa, Ptr<CppTokenCursor>& cursor)
 {
 	List<Ptr<BinaryExpr>> binaryStack;
@@ -616,10 +648,11 @@ Ptr<Expr> ParseBinaryExpr(const ParsingArguments& pa, Ptr<CppTokenCursor>& curso
 			break;
 		}
 
+		// binary operators are left associative, so operators with the same precedence are also popped
 		while (binaryStack.Count() > 0)
 		{
 			auto last = binaryStack[binaryStack.Count() - 1];
-			if (last->precedence < precedence)
+			if (last->precedence <= precedence)
 			{
 				popped = last;
 				binaryStack.RemoveAt(binaryStack.Count() - 1);
@@ -634,7 +667,8 @@ Ptr<Expr> ParseBinaryExpr(const ParsingArguments& pa, Ptr<CppTokenCursor>& curso
 		newExpr->opName = opName;
 		FillOperator(newExpr->opName, newExpr->op);
 		newExpr->precedence = precedence;
-		newExpr->left = popped;
+		// the left operand is the right operand of the last remaining operator, which is the last popped operator if any
+		newExpr->left = binaryStack.Count() > 0 ? binaryStack[binaryStack.Count() - 1]->right : popped;
 		newExpr->right = ParsePrefixUnaryExpr(pa, cursor);
 
 		if (binaryStack.Count() > 0)
@@ -643,7 +677,14 @@ Ptr<Expr> ParseBinaryExpr(const ParsingArguments& pa, Ptr<CppTokenCursor>& curso
 		}
 		binaryStack.Add(newExpr);
 	}
-	return binaryStack.Count() > 0 ? Ptr<Expr>(binaryStack[0]) : popped;
+
+	// right operands could be replaced by later operators, so ranges are only available after the whole expression is parsed
+	if (binaryStack.Count() > 0)
+	{
+		FillBinaryExprRange(binaryStack[0].Obj());
+		return binaryStack[0];
+	}
+	return popped;
 }
 
 /***********************************************************************
@@ -652,6 +693,7 @@ ParseIfExpr
 
 Ptr<Expr> ParseIfExpr(const ParsingArguments& pa, Ptr<CppTokenCursor>& cursor)
 {
+	vint start = GetRangeStart(cursor);
 	auto expr = ParseBinaryExpr(pa, cursor);
 	if (TestToken(cursor, CppTokens::QUESTIONMARK))
 	{
@@ -660,6 +702,7 @@ Ptr<Expr> ParseIfExpr(const ParsingArguments& pa, Ptr<CppTokenCursor>& cursor)
 		newExpr->left = ParseIfExpr(pa, cursor);
 		RequireToken(cursor, CppTokens::COLON);
 		newExpr->right = ParseIfExpr(pa, cursor);
+		FillRange(newExpr.Obj(), start, cursor);
 		return newExpr;
 	}
 	else
@@ -674,6 +717,7 @@ ParseAssignExpr
 
 Ptr<Expr> ParseAssignExpr(const ParsingArguments& pa, Ptr<CppTokenCursor>& cursor)
 {
+	vint start = GetRangeStart(cursor);
 	auto expr = ParseIfExpr(pa, cursor);
 	if (TestToken(cursor, CppTokens::EQ, false))
 	{
@@ -683,6 +727,7 @@ Ptr<Expr> ParseAssignExpr(const ParsingArguments& pa, Ptr<CppTokenCursor>& curso
 		newExpr->precedence = 16;
 		newExpr->left = expr;
 		newExpr->right = ParseAssignExpr(pa, cursor);
+		FillRange(newExpr.Obj(), start, cursor);
 		return newExpr;
 	}
 	else if (
@@ -701,6 +746,7 @@ Ptr<Expr> ParseAssignExpr(const ParsingArguments& pa, Ptr<CppTokenCursor>& curso
 		newExpr->precedence = 16;
 		newExpr->left = expr;
 		newExpr->right = ParseAssignExpr(pa, cursor);
+		FillRange(newExpr.Obj(), start, cursor);
 		return newExpr;
 	}
 	else if (
@@ -713,6 +759,7 @@ Ptr<Expr> ParseAssignExpr(const ParsingArguments& pa, Ptr<CppTokenCursor>& curso
 		newExpr->precedence = 16;
 		newExpr->left = expr;
 		newExpr->right = ParseAssignExpr(pa, cursor);
+		FillRange(newExpr.Obj(), start, cursor);
 		return newExpr;
 	}
 	else
@@ -727,6 +774,7 @@ ParseThrowExpr
 
 Ptr<Expr> ParseThrowExpr(const ParsingArguments& pa, Ptr<CppTokenCursor>& cursor)
 {
+	vint start = GetRangeStart(cursor);
 	if (TestToken(cursor, CppTokens::THROW))
 	{
 		auto newExpr = MakePtr<ThrowExpr>();
@@ -734,6 +782,7 @@ Ptr<Expr> ParseThrowExpr(const ParsingArguments& pa, Ptr<CppTokenCursor>& cursor
 		{
 			newExpr->expr = ParseAssignExpr(pa, cursor);
 		}
+		FillRange(newExpr.Obj(), start, cursor);
 		return newExpr;
 	}
 	else
@@ -748,6 +797,7 @@ ParseExpr
 
 Ptr<Expr> ParseExpr(const ParsingArguments& pa, bool allowComma, Ptr<CppTokenCursor>& cursor)
 {
+	vint start = GetRangeStart(cursor);
 	auto expr = ParseThrowExpr(pa, cursor);
 	while (allowComma)
 	{
@@ -759,6 +809,7 @@ Ptr<Expr> ParseExpr(const ParsingArguments& pa, bool allowComma, Ptr<CppTokenCur
 			newExpr->precedence = 18;
 			newExpr->left = expr;
 			newExpr->right = ParseThrowExpr(pa, cursor);
+			FillRange(newExpr.Obj(), start, cursor);
 			expr = newExpr;
 		}
 		else
@@ -0,0 +1,128 @@
+#include "Parser.h"
+
+/***********************************************************************
+IndexTable
+***********************************************************************/
+
+vint IndexTable::GetAtom(const WString& name)
+{
+	vint index = atomIds.Keys().IndexOf(name);
+	if (index != -1)
+	{
+		return atomIds.Values()[index];
+	}
+
+	vint atom = atoms.Add(name);
+	atomIds.Add(name, atom);
+	return atom;
+}
+
+void IndexTable::Add(const CppName& name, const Resolving* resolving, IndexReason reason)
+{
+	auto& token = name.nameTokens[0];
+	tokenStarts.Add(token.start);
+	tokenLengths.Add(token.length);
+	tokenRows.Add(token.rowStart);
+	tokenColumns.Add(token.columnStart);
+	nameAtoms.Add(GetAtom(name.name));
+	reasons.Add(reason);
+	symbolStarts.Add(symbols.Count());
+
+	if (resolving)
+	{
+		auto& resolvedSymbols = resolving->resolvedSymbols;
+		symbolCounts.Add(resolvedSymbols.Count());
+		for (vint i = 0; i < resolvedSymbols.Count(); i++)
+		{
+			symbols.Add(resolvedSymbols[i]);
+		}
+	}
+	else
+	{
+		symbolCounts.Add(0);
+	}
+}
+
+void IndexTable::Truncate(vint count)
+{
+	if (count >= Count()) return;
+	symbols.RemoveRange(symbolStarts[count], symbols.Count() - symbolStarts[count]);
+
+	vint removed = Count() - count;
+	tokenStarts.RemoveRange(count, removed);
+	tokenLengths.RemoveRange(count, removed);
+	tokenRows.RemoveRange(count, removed);
+	tokenColumns.RemoveRange(count, removed);
+	nameAtoms.RemoveRange(count, removed);
+	reasons.RemoveRange(count, removed);
+	symbolStarts.RemoveRange(count, removed);
+	symbolCounts.RemoveRange(count, removed);
+}
+
+void IndexTable::Append(const IndexTable& table, const Dictionary<Symbol*, Symbol*>& replacedSymbols)
+{
+	Array<vint> atomMap(table.atoms.Count());
+	for (vint i = 0; i < table.atoms.Count(); i++)
+	{
+		atomMap[i] = GetAtom(table.atoms[i]);
+	}
+
+	for (vint i = 0; i < table.Count(); i++)
+	{
+		tokenStarts.Add(table.tokenStarts[i]);
+		tokenLengths.Add(table.tokenLengths[i]);
+		tokenRows.Add(table.tokenRows[i]);
+		tokenColumns.Add(table.tokenColumns[i]);
+		nameAtoms.Add(atomMap[table.nameAtoms[i]]);
+		reasons.Add(table.reasons[i]);
+		symbolStarts.Add(symbols.Count());
+		symbolCounts.Add(table.symbolCounts[i]);
+
+		for (vint j = 0; j < table.symbolCounts[i]; j++)
+		{
+			auto symbol = table.symbols[table.symbolStarts[i] + j];
+			vint index = replacedSymbols.Keys().IndexOf(symbol);
+			symbols.Add(index == -1 ? symbol : replacedSymbols.Values()[index]);
+		}
+	}
+}
+
+void IndexTable::Clear()
+{
+	atoms.Clear();
+	atomIds.Clear();
+	tokenStarts.Clear();
+	tokenLengths.Clear();
+	tokenRows.Clear();
+	tokenColumns.Clear();
+	nameAtoms.Clear();
+	reasons.Clear();
+	symbolStarts.Clear();
+	symbolCounts.Clear();
+	symbols.Clear();
+}
+
+/***********************************************************************
+IndexResolving
+***********************************************************************/
+
+void IndexResolving(const ParsingArguments& pa, CppName& name, const Ptr<Resolving>& resolving, IndexReason reason)
+{
+	if (pa.index)
+	{
+		pa.index->Add(name, resolving.Obj(), reason);
+	}
+
+	if (pa.recorder)
+	{
+		switch (reason)
+		{
+		case IndexReason::Resolved:
+			pa.recorder->Index(name, resolving);
+			break;
+		case IndexReason::ExpectValueButType:
+			pa.recorder->ExpectValueButType(name, resolving);
+			break;
+		}
+	}
+}
\ No newline at end of file
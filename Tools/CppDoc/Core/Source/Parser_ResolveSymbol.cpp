@@ -17,11 +17,7 @@ void ResolveSymbolResult::Merge(Ptr<Resolving>& to, Ptr<Resolving> from)
 
 	for (vint i = 0; i < from->resolvedSymbols.Count(); i++)
 	{
-		auto symbol = from->resolvedSymbols[i];
-		if (!to->resolvedSymbols.Contains(symbol))
-		{
-			to->resolvedSymbols.Add(symbol);
-		}
+		to->resolvedSymbols.Add(from->resolvedSymbols[i]);
 	}
 }
 
@@ -145,10 +141,7 @@ void AddSymbolToResolve(Ptr<Resolving>& resolving, Symbol* symbol)
 		resolving = new Resolving;
 	}
 
-	if (!resolving->resolvedSymbols.Contains(symbol))
-	{
-		resolving->resolvedSymbols.Add(symbol);
-	}
+	resolving->resolvedSymbols.Add(symbol);
 }
 
 /***********************************************************************
@@ -169,6 +162,8 @@ void ResolveSymbolInternal(const ParsingArguments& pa, SearchPolicy policy, Reso
 
 	while (scope)
 	{
+		CPPDOC_COUNT(resolveSymbolScopes);
+		if (pa.partition) pa.partition->Lookup(scope, rsa.name.name);
 		vint index = scope->children.Keys().IndexOf(rsa.name.name);
 		if (index != -1)
 		{
@@ -247,6 +242,10 @@ ResolveSymbol
 
 ResolveSymbolResult ResolveSymbol(const ParsingArguments& pa, CppName& name, SearchPolicy policy, ResolveSymbolResult input)
 {
+	CPPDOC_COUNT(resolveSymbolCalls);
+	ConsumeBudget(pa, ParsingBudget::Tsys, 0);
+	CPPDOC_TRACE_SCOPE(L"ResolveSymbol");
+	CPPDOC_TRACE_DETAIL(name.name);
 	PREPARE_RSA;
 	ResolveSymbolInternal(pa, policy, rsa);
 	return rsa.result;
@@ -354,6 +353,10 @@ ResolveChildSymbol
 
 ResolveSymbolResult ResolveChildSymbol(const ParsingArguments& pa, Ptr<Type> classType, CppName& name, ResolveSymbolResult input)
 {
+	CPPDOC_COUNT(resolveSymbolCalls);
+	ConsumeBudget(pa, ParsingBudget::Tsys, 0);
+	CPPDOC_TRACE_SCOPE(L"ResolveChildSymbol");
+	CPPDOC_TRACE_DETAIL(name.name);
 	PREPARE_RSA;
 	ResolveChildSymbolInternal(pa, classType, SearchPolicy::ChildSymbol, rsa);
 	return rsa.result;
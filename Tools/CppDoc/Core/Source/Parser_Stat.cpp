@@ -17,6 +17,8 @@ void ParseVariableOrExpression(const ParsingArguments& pa, Ptr<CppTokenCursor>&
 	}
 	catch (const StopParsingException&)
 	{
+		CPPDOC_COUNT_REWIND();
+		ConsumeBudget(pa, ParsingBudget::Rewinds);
 		cursor = oldCursor;
 	}
 
@@ -30,7 +32,7 @@ void ParseVariableOrExpression(const ParsingArguments& pa, Ptr<CppTokenCursor>&
 	}
 }
 
-Ptr<Stat> ParseStat(const ParsingArguments& pa, Ptr<CppTokenCursor>& cursor)
+static Ptr<Stat> ParseStatInternal(const ParsingArguments& pa, Ptr<CppTokenCursor>& cursor)
 {
 	if (TestToken(cursor, CppTokens::SEMICOLON))
 	{
@@ -127,6 +129,8 @@ Ptr<Stat> ParseStat(const ParsingArguments& pa, Ptr<CppTokenCursor>& cursor)
 			}
 			catch (const StopParsingException&)
 			{
+				CPPDOC_COUNT_REWIND();
+				ConsumeBudget(pa, ParsingBudget::Rewinds);
 				cursor = oldCursor;
 				goto FOR_EACH_FAILED;
 			}
@@ -158,6 +162,8 @@ Ptr<Stat> ParseStat(const ParsingArguments& pa, Ptr<CppTokenCursor>& cursor)
 				}
 				catch (const StopParsingException&)
 				{
+					CPPDOC_COUNT_REWIND();
+					ConsumeBudget(pa, ParsingBudget::Rewinds);
 					cursor = oldCursor;
 				}
 
@@ -203,6 +209,8 @@ Ptr<Stat> ParseStat(const ParsingArguments& pa, Ptr<CppTokenCursor>& cursor)
 			}
 			catch (const StopParsingException&)
 			{
+				CPPDOC_COUNT_REWIND();
+				ConsumeBudget(pa, ParsingBudget::Rewinds);
 				cursor = oldCursor;
 			}
 		}
@@ -341,6 +349,8 @@ Ptr<Stat> ParseStat(const ParsingArguments& pa, Ptr<CppTokenCursor>& cursor)
 			}
 			catch (const StopParsingException&)
 			{
+				CPPDOC_COUNT_REWIND();
+				ConsumeBudget(pa, ParsingBudget::Rewinds);
 				cursor = oldCursor;
 			}
 		}
@@ -351,4 +361,12 @@ Ptr<Stat> ParseStat(const ParsingArguments& pa, Ptr<CppTokenCursor>& cursor)
 			return stat;
 		}
 	}
+}
+
+Ptr<Stat> ParseStat(const ParsingArguments& pa, Ptr<CppTokenCursor>& cursor)
+{
+	vint start = GetRangeStart(cursor);
+	auto stat = ParseStatInternal(pa, cursor);
+	FillRange(stat.Obj(), start, cursor);
+	return stat;
 }
\ No newline at end of file
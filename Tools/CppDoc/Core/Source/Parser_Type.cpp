@@ -64,10 +64,7 @@ Ptr<IdType> ParseIdType(const ParsingArguments& pa, Ptr<CppTokenCursor>& cursor)
 			auto type = MakePtr<IdType>();
 			type->name = cppName;
 			type->resolving = resolving;
-			if (pa.recorder)
-			{
-				pa.recorder->Index(type->name, type->resolving);
-			}
+			IndexResolving(pa, type->name, type->resolving, IndexReason::Resolved);
 			return type;
 		}
 	}
@@ -91,9 +88,9 @@ Ptr<ChildType> TryParseChildType(const ParsingArguments& pa, Ptr<Type> classType
 			type->typenameType = typenameType;
 			type->name = cppName;
 			type->resolving = resolving;
-			if (pa.recorder && type->resolving)
+			if (type->resolving)
 			{
-				pa.recorder->Index(type->name, type->resolving);
+				IndexResolving(pa, type->name, type->resolving, IndexReason::Resolved);
 			}
 			return type;
 		}
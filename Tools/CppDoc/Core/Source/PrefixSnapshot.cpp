@@ -0,0 +1,181 @@
+#include "PrefixSnapshot.h"
+
+/***********************************************************************
+PrefixSnapshot
+***********************************************************************/
+
+void PrefixSnapshot::Save(Symbol* symbol)
+{
+	SymbolState state;
+	state.symbol = symbol;
+	state.descendantVersion = symbol->descendantVersion;
+	state.declCount = symbol->decls.Count();
+	state.forwardDeclarationCount = symbol->forwardDeclarations.Count();
+	state.specializationCount = symbol->specializations.Count();
+	state.usingNsCount = symbol->usingNss.Count();
+	state.forwardDeclarationRoot = symbol->forwardDeclarationRoot;
+	state.resolvedTypes = symbol->resolvedTypes != nullptr;
+	states.Add(state);
+	symbols.Add(symbol);
+
+	for (vint i = 0; i < symbol->children.Count(); i++)
+	{
+		auto& children = symbol->children.GetByIndex(i);
+		for (vint j = 0; j < children.Count(); j++)
+		{
+			Save(children[j].Obj());
+		}
+	}
+}
+
+void PrefixSnapshot::RemoveSymbol(Symbol* symbol)
+{
+	// types of a removed symbol stay in the allocator, but they could not be found again by the symbol
+	tsys->RemoveDecl(symbol);
+	for (vint i = 0; i < symbol->children.Count(); i++)
+	{
+		auto& children = symbol->children.GetByIndex(i);
+		for (vint j = 0; j < children.Count(); j++)
+		{
+			RemoveSymbol(children[j].Obj());
+		}
+	}
+}
+
+PrefixSnapshot::PrefixSnapshot(Ptr<RegexLexer> lexer, const WString& _prefix)
+	:prefix(_prefix)
+	, root(new Symbol)
+	, tsys(ITsysAlloc::Create())
+	, index(new IndexTable)
+{
+	{
+		CppTokenReader reader(lexer, prefix);
+		auto cursor = reader.GetFirstToken();
+
+		ParsingArguments pa(root, tsys, nullptr);
+		pa.index = index;
+		program = ParseProgram(pa, cursor);
+	}
+
+	indexCount = index->Count();
+	Save(root.Obj());
+}
+
+PrefixSnapshot::~PrefixSnapshot()
+{
+	if (forked)
+	{
+		Restore();
+	}
+}
+
+const WString& PrefixSnapshot::GetPrefix()
+{
+	return prefix;
+}
+
+Ptr<Program> PrefixSnapshot::GetProgram()
+{
+	return program;
+}
+
+bool PrefixSnapshot::Fork(Ptr<CppTokenCursor>& cursor, ParsingArguments& pa)
+{
+	CHECK_ERROR(!forked, L"PrefixSnapshot::Fork(Ptr<CppTokenCursor>&, ParsingArguments&)#Restore() should be called before forking again.");
+	if (!cursor || prefix.Length() == 0) return false;
+
+	// tokens point to the input, find the input from the first token
+	auto input = cursor->token.reading - cursor->token.start;
+	if (wcsncmp(input, prefix.Buffer(), prefix.Length()) != 0) return false;
+
+	auto current = cursor;
+	while (current && current->token.start < prefix.Length())
+	{
+		if (current->token.start + current->token.length > prefix.Length())
+		{
+			return false;
+		}
+		current = current->Next();
+	}
+
+	cursor = current;
+	pa = ParsingArguments(root, tsys, nullptr);
+	pa.index = index;
+	tsys->Mark();
+	forked = true;
+	return true;
+}
+
+void PrefixSnapshot::Restore()
+{
+	if (!forked) return;
+	forked = false;
+	index->Truncate(indexCount);
+
+	// types created during the fork are destroyed, so the allocator does not grow with the number of inputs
+	// results cached on AST nodes and class symbols of the prefix could refer to them, they become out of date
+	// the operator cache is not shared, every fork creates a new one in its ParsingArguments
+	tsys->Release();
+
+	for (vint i = 0; i < states.Count(); i++)
+	{
+		auto& state = states[i];
+		auto symbol = state.symbol;
+
+		// descendantVersion only increases when a symbol is added to this scope or its descendants
+		if (symbol->descendantVersion != state.descendantVersion)
+		{
+			List<Ptr<Symbol>> added;
+			for (vint j = 0; j < symbol->children.Count(); j++)
+			{
+				auto& children = symbol->children.GetByIndex(j);
+				for (vint k = 0; k < children.Count(); k++)
+				{
+					if (!symbols.Contains(children[k].Obj()))
+					{
+						added.Add(children[k]);
+					}
+				}
+			}
+
+			if (added.Count() > 0)
+			{
+				for (vint j = 0; j < added.Count(); j++)
+				{
+					RemoveSymbol(added[j].Obj());
+					symbol->children.Remove(added[j]->name, added[j].Obj());
+				}
+				symbol->conversionTable = nullptr;
+				symbol->overloadArityTable = nullptr;
+			}
+
+			// keep versions increasing, so that caches filled during the last fork are not mistaken as up to date
+			symbol->descendantVersion++;
+			symbol->operatorVersion++;
+			state.descendantVersion = symbol->descendantVersion;
+		}
+
+		if (symbol->decls.Count() > state.declCount)
+		{
+			symbol->decls.RemoveRange(state.declCount, symbol->decls.Count() - state.declCount);
+		}
+		if (symbol->forwardDeclarations.Count() > state.forwardDeclarationCount)
+		{
+			symbol->forwardDeclarations.RemoveRange(state.forwardDeclarationCount, symbol->forwardDeclarations.Count() - state.forwardDeclarationCount);
+		}
+		if (symbol->specializations.Count() > state.specializationCount)
+		{
+			symbol->specializations.RemoveRange(state.specializationCount, symbol->specializations.Count() - state.specializationCount);
+		}
+		if (symbol->usingNss.Count() > state.usingNsCount)
+		{
+			symbol->usingNss.RemoveRange(state.usingNsCount, symbol->usingNss.Count() - state.usingNsCount);
+		}
+		symbol->forwardDeclarationRoot = state.forwardDeclarationRoot;
+		if (!state.resolvedTypes)
+		{
+			// types resolved after forking could refer to removed symbols
+			symbol->resolvedTypes = nullptr;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,56 @@
+#ifndef VCZH_DOCUMENT_CPPDOC_PREFIXSNAPSHOT
+#define VCZH_DOCUMENT_CPPDOC_PREFIXSNAPSHOT
+
+#include "Parser.h"
+
+/***********************************************************************
+PrefixSnapshot
+	Parse a common prefix of inputs once, and parse the rest of each input on top of it
+	Everything created after the prefix is removed by Restore(), so the snapshot could be reused by the next input
+	A snapshot could only be used by one thread at a time
+***********************************************************************/
+
+class PrefixSnapshot : public Object
+{
+protected:
+	struct SymbolState
+	{
+		Symbol*					symbol = nullptr;
+		vint					descendantVersion = 0;
+		vint					declCount = 0;
+		vint					forwardDeclarationCount = 0;
+		vint					specializationCount = 0;
+		vint					usingNsCount = 0;
+		Symbol*					forwardDeclarationRoot = nullptr;
+		bool					resolvedTypes = false;
+	};
+
+	WString						prefix;
+	Ptr<Symbol>					root;
+	Ptr<ITsysAlloc>				tsys;
+	Ptr<IndexTable>				index;
+	Ptr<Program>				program;
+	vint						indexCount = 0;
+	List<SymbolState>			states;
+	SortedList<Symbol*>			symbols;		// all symbols created by the prefix
+	bool						forked = false;
+
+	void						Save(Symbol* symbol);
+	void						RemoveSymbol(Symbol* symbol);
+public:
+	// Throw StopParsingException if the prefix could not be parsed
+	PrefixSnapshot(Ptr<RegexLexer> lexer, const WString& _prefix);
+	~PrefixSnapshot();
+
+	const WString&				GetPrefix();
+	Ptr<Program>				GetProgram();
+
+	// Skip the prefix in the cursor and prepare arguments to parse the rest of the input
+	// Returns false and keeps the cursor unchanged, if the input does not begin with the prefix, or the prefix does not end at a token boundary
+	bool						Fork(Ptr<CppTokenCursor>& cursor, ParsingArguments& pa);
+	// Remove all symbols, types and index items created after Fork(), results from the forked ParsingArguments become invalid
+	// Results of TypeToTsys, ExprToTsys and conversion tables cached during the fork become out of date
+	void						Restore();
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,140 @@
+#include "Scheduler.h"
+
+/***********************************************************************
+WorkStealingScheduler
+***********************************************************************/
+
+bool WorkStealingScheduler::TakeTask(vint worker, Task& task)
+{
+	auto w = workers[worker];
+	SPIN_LOCK(w->lock)
+	{
+		vint count = w->tasks.Count();
+		if (count > w->stolen)
+		{
+			task = w->tasks[count - 1];
+			w->tasks.RemoveAt(count - 1);
+			if (w->tasks.Count() == w->stolen)
+			{
+				w->tasks.Clear();
+				w->stolen = 0;
+			}
+			return true;
+		}
+	}
+	return false;
+}
+
+bool WorkStealingScheduler::StealTask(vint worker, Task& task)
+{
+	for (vint i = 1; i < workers.Count(); i++)
+	{
+		auto w = workers[(worker + i) % workers.Count()];
+		if (!w->lock.TryEnter()) continue;
+
+		bool succeeded = false;
+		if (w->tasks.Count() > w->stolen)
+		{
+			// stealing from the front takes the oldest task, which is usually the biggest one
+			task = w->tasks[w->stolen];
+			w->tasks[w->stolen] = {};
+			if (++w->stolen == w->tasks.Count())
+			{
+				w->tasks.Clear();
+				w->stolen = 0;
+			}
+			succeeded = true;
+		}
+		w->lock.Leave();
+		if (succeeded) return true;
+	}
+	return false;
+}
+
+void WorkStealingScheduler::RunWorker(vint worker)
+{
+	while (true)
+	{
+		Task task;
+		if (TakeTask(worker, task) || StealTask(worker, task))
+		{
+			try
+			{
+				task(worker);
+			}
+			catch (...)
+			{
+				INCRC(&failedTasks);
+			}
+			DECRC(&pendingTasks);
+		}
+		else if (pendingTasks == 0)
+		{
+			break;
+		}
+		else
+		{
+			// running tasks could still queue more tasks
+			Thread::Sleep(1);
+		}
+	}
+}
+
+WorkStealingScheduler::WorkStealingScheduler(vint workerCount)
+{
+	if (workerCount <= 0)
+	{
+		workerCount = Thread::GetCPUCount();
+	}
+	if (workerCount <= 0)
+	{
+		workerCount = 1;
+	}
+
+	workers.Resize(workerCount);
+	for (vint i = 0; i < workerCount; i++)
+	{
+		workers[i] = new Worker;
+	}
+}
+
+WorkStealingScheduler::~WorkStealingScheduler()
+{
+}
+
+vint WorkStealingScheduler::GetWorkerCount()
+{
+	return workers.Count();
+}
+
+vint WorkStealingScheduler::GetFailedTaskCount()
+{
+	return failedTasks;
+}
+
+void WorkStealingScheduler::Queue(vint worker, const Task& task)
+{
+	INCRC(&pendingTasks);
+	auto w = workers[worker % workers.Count()];
+	SPIN_LOCK(w->lock)
+	{
+		w->tasks.Add(task);
+	}
+}
+
+void WorkStealingScheduler::Run()
+{
+	List<Thread*> threads;
+	for (vint i = 1; i < workers.Count(); i++)
+	{
+		threads.Add(Thread::CreateAndStart([=]() { RunWorker(i); }, false));
+	}
+
+	RunWorker(0);
+
+	for (vint i = 0; i < threads.Count(); i++)
+	{
+		threads[i]->Wait();
+		delete threads[i];
+	}
+}
\ No newline at end of file
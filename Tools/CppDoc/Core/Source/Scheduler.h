@@ -0,0 +1,49 @@
+#ifndef VCZH_DOCUMENT_CPPDOC_SCHEDULER
+#define VCZH_DOCUMENT_CPPDOC_SCHEDULER
+
+#include "Utility.h"
+
+/***********************************************************************
+WorkStealingScheduler
+	Every worker owns a queue of tasks
+	A worker takes tasks from the back of its own queue, and steals tasks from the front of other queues when its own queue is empty
+	Tasks could queue more tasks while running, Run() returns when all tasks are finished
+***********************************************************************/
+
+class WorkStealingScheduler : public Object
+{
+public:
+	// The argument is the index of the worker that runs the task
+	using Task = Func<void(vint)>;
+
+protected:
+	class Worker : public Object
+	{
+	public:
+		SpinLock					lock;
+		List<Task>					tasks;
+		vint						stolen = 0;		// tasks before this index have been stolen
+	};
+
+	Array<Ptr<Worker>>				workers;
+	volatile vint					pendingTasks = 0;
+	volatile vint					failedTasks = 0;
+
+	bool							TakeTask(vint worker, Task& task);
+	bool							StealTask(vint worker, Task& task);
+	void							RunWorker(vint worker);
+public:
+	// Use the number of processors when workerCount is 0
+	WorkStealingScheduler(vint workerCount = 0);
+	~WorkStealingScheduler();
+
+	vint							GetWorkerCount();
+	// Get the number of tasks that threw exceptions, tasks are expected to handle their own errors
+	vint							GetFailedTaskCount();
+	// Queue a task to a worker, it could be called before or during Run()
+	void							Queue(vint worker, const Task& task);
+	// Run all tasks, the calling thread becomes the first worker
+	void							Run();
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,153 @@
+#include "Statistics.h"
+
+using namespace vl::stream;
+
+CppStatistics CppStatisticsCounters;
+
+/***********************************************************************
+CppRewindSite
+***********************************************************************/
+
+static SpinLock rewindSiteLock;
+static CppRewindSite* firstRewindSite = nullptr;
+
+CppRewindSite::CppRewindSite(const char* _file, vint _line)
+	:file(_file)
+	, line(_line)
+{
+	SPIN_LOCK(rewindSiteLock)
+	{
+		next = firstRewindSite;
+		firstRewindSite = this;
+	}
+}
+
+// Sites that have been reached, the most reached one comes first
+static void GetRewindSites(List<CppRewindSite*>& sites)
+{
+	SPIN_LOCK(rewindSiteLock)
+	{
+		for (auto site = firstRewindSite; site; site = site->next)
+		{
+			if (site->count > 0)
+			{
+				sites.Add(site);
+			}
+		}
+	}
+
+	if (sites.Count() > 0)
+	{
+		Sort<CppRewindSite*>(&sites[0], sites.Count(), [](CppRewindSite* a, CppRewindSite* b)->vint
+		{
+			if (a->count != b->count) return a->count > b->count ? -1 : 1;
+			if (a->line != b->line) return a->line < b->line ? -1 : 1;
+			return strcmp(a->file, b->file);
+		});
+	}
+}
+
+// __FILE__ could be a full path
+static WString GetRewindSiteName(CppRewindSite* site)
+{
+	auto file = site->file;
+	for (auto reading = site->file; *reading; reading++)
+	{
+		if (*reading == '/' || *reading == '\\')
+		{
+			file = reading + 1;
+		}
+	}
+	return atow(file) + L":" + itow(site->line);
+}
+
+static const wchar_t* tsysTypeNames[] =
+{
+#define CPPDOC_TSYS_TYPE(NAME) L_(#NAME),
+	TSYS_TYPE_LIST(CPPDOC_TSYS_TYPE)
+#undef CPPDOC_TSYS_TYPE
+};
+static const vint TsysTypeCount = (vint)(sizeof(tsysTypeNames) / sizeof(*tsysTypeNames));
+
+/***********************************************************************
+Statistics
+***********************************************************************/
+
+bool IsStatisticsEnabled()
+{
+#ifdef CPPDOC_STATISTICS
+	return true;
+#else
+	return false;
+#endif
+}
+
+void ResetStatistics()
+{
+	CppStatisticsCounters = CppStatistics();
+	SPIN_LOCK(rewindSiteLock)
+	{
+		for (auto site = firstRewindSite; site; site = site->next)
+		{
+			site->count = 0;
+		}
+	}
+}
+
+void WriteStatisticsTable(TextWriter& writer)
+{
+	auto writeRow = [&](const WString& name, vint64_t value)
+	{
+		auto text = i64tow(value);
+		writer.WriteString(text);
+		for (vint i = text.Length(); i < 12; i++)
+		{
+			writer.WriteChar(L' ');
+		}
+		writer.WriteLine(L"  " + name);
+	};
+
+#define CPPDOC_COUNTER(NAME, DESCRIPTION) writeRow(DESCRIPTION, CppStatisticsCounters.NAME);
+	CPPDOC_STATISTICS_COUNTERS(CPPDOC_COUNTER)
+#undef CPPDOC_COUNTER
+
+	for (vint i = 0; i < TsysTypeCount; i++)
+	{
+		writeRow(L"ITsys_" + WString(tsysTypeNames[i]) + L" created", CppStatisticsCounters.tsysNodes[i]);
+	}
+
+	List<CppRewindSite*> sites;
+	GetRewindSites(sites);
+	for (vint i = 0; i < sites.Count(); i++)
+	{
+		writeRow(L"rewinds at " + GetRewindSiteName(sites[i]), sites[i]->count);
+	}
+}
+
+WString GetStatisticsJson(const WString& indentation)
+{
+	return GenerateToStream([&](StreamWriter& writer)
+	{
+		writer.WriteLine(L"{");
+#define CPPDOC_COUNTER(NAME, DESCRIPTION) writer.WriteLine(indentation + L"\t\"" L_(#NAME) L"\": " + i64tow(CppStatisticsCounters.NAME) + L",");
+		CPPDOC_STATISTICS_COUNTERS(CPPDOC_COUNTER)
+#undef CPPDOC_COUNTER
+
+		writer.WriteString(indentation + L"\t\"tsysNodes\": {");
+		for (vint i = 0; i < TsysTypeCount; i++)
+		{
+			writer.WriteString(WString(i == 0 ? L" \"" : L", \"") + tsysTypeNames[i] + L"\": " + i64tow(CppStatisticsCounters.tsysNodes[i]));
+		}
+		writer.WriteLine(L" },");
+
+		List<CppRewindSite*> sites;
+		GetRewindSites(sites);
+		writer.WriteString(indentation + L"\t\"rewinds\": {");
+		for (vint i = 0; i < sites.Count(); i++)
+		{
+			writer.WriteString(WString(i == 0 ? L" \"" : L", \"") + GetRewindSiteName(sites[i]) + L"\": " + i64tow(sites[i]->count));
+		}
+		writer.WriteLine(L" }");
+		writer.WriteString(indentation + L"}");
+	});
+}
\ No newline at end of file
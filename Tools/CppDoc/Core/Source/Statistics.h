@@ -0,0 +1,63 @@
+#ifndef VCZH_DOCUMENT_CPPDOC_STATISTICS
+#define VCZH_DOCUMENT_CPPDOC_STATISTICS
+
+#include "TypeSystem.h"
+
+/***********************************************************************
+Statistics
+	Counters of parser internals, only collected when CPPDOC_STATISTICS is defined for every project
+	Otherwise CPPDOC_COUNT* macros compile to nothing and all counters stay 0
+	Counters are not synchronized, they are only exact when one thread is parsing
+***********************************************************************/
+
+#define CPPDOC_STATISTICS_COUNTERS(F)\
+	F(tokensLexed,			L"tokens lexed, including spaces and comments")\
+	F(cursorAllocations,	L"CppTokenCursor allocations")\
+	F(stopParsingThrows,	L"StopParsingException thrown")\
+	F(resolveSymbolCalls,	L"ResolveSymbol and ResolveChildSymbol calls")\
+	F(resolveSymbolScopes,	L"scopes visited by ResolveSymbol")\
+	F(testConvertCalls,		L"TestConvert calls")\
+	F(overloadResolutions,	L"overload resolutions")\
+	F(overloadCandidates,	L"overload candidates examined")\
+
+struct CppStatistics
+{
+#define CPPDOC_COUNTER(NAME, DESCRIPTION) vint64_t NAME = 0;
+	CPPDOC_STATISTICS_COUNTERS(CPPDOC_COUNTER)
+#undef CPPDOC_COUNTER
+
+#define CPPDOC_TSYS_TYPE(NAME) +1
+	vint64_t						tsysNodes[0 TSYS_TYPE_LIST(CPPDOC_TSYS_TYPE)] = { 0 };	// nodes created by ITsys_Allocator, by TsysType
+#undef CPPDOC_TSYS_TYPE
+};
+
+// A place that catches StopParsingException and rewinds the cursor, registered when it is reached for the first time
+struct CppRewindSite
+{
+	const char*						file;
+	vint							line;
+	vint64_t						count = 0;
+	CppRewindSite*					next = nullptr;
+
+	CppRewindSite(const char* _file, vint _line);
+};
+
+extern CppStatistics				CppStatisticsCounters;
+extern bool							IsStatisticsEnabled();
+extern void							ResetStatistics();
+extern void							WriteStatisticsTable(stream::TextWriter& writer);
+extern WString						GetStatisticsJson(const WString& indentation);	// a JSON object, every line except the first one begins with indentation
+
+#ifdef CPPDOC_STATISTICS
+#define CPPDOC_COUNT(NAME) (CppStatisticsCounters.NAME++)
+#define CPPDOC_COUNT_ADD(NAME, VALUE) (CppStatisticsCounters.NAME += (VALUE))
+#define CPPDOC_COUNT_TSYS(TYPE) (CppStatisticsCounters.tsysNodes[(vint)(TYPE)]++)
+#define CPPDOC_COUNT_REWIND() { static CppRewindSite cppdocRewindSite(__FILE__, __LINE__); cppdocRewindSite.count++; }
+#else
+#define CPPDOC_COUNT(NAME)
+#define CPPDOC_COUNT_ADD(NAME, VALUE)
+#define CPPDOC_COUNT_TSYS(TYPE)
+#define CPPDOC_COUNT_REWIND()
+#endif
+
+#endif
\ No newline at end of file
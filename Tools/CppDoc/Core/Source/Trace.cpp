@@ -0,0 +1,114 @@
+#include "Trace.h"
+
+using namespace vl::stream;
+
+/***********************************************************************
+Events
+***********************************************************************/
+
+struct CppTraceEvent
+{
+	const wchar_t*					name = nullptr;
+	WString							detail;
+	vint							lane = 0;
+	vint64_t						start = 0;
+	vint64_t						duration = 0;
+};
+
+static SpinLock						traceLock;
+static volatile bool				traceRecording = false;
+static vint64_t						traceStart = 0;
+static vint							traceLaneCount = 0;
+static List<CppTraceEvent>			traceEvents;
+static thread_local vint			traceLane = -1;		// -1 if this thread has not recorded any event
+
+/***********************************************************************
+CppTraceScope
+***********************************************************************/
+
+CppTraceScope::CppTraceScope(const wchar_t* _name)
+	:name(_name)
+{
+	if (traceRecording)
+	{
+		start = GetMicroseconds();
+	}
+}
+
+CppTraceScope::~CppTraceScope()
+{
+	if (start == -1) return;
+
+	CppTraceEvent e;
+	e.name = name;
+	e.detail = detail;
+	e.start = start;
+	e.duration = GetMicroseconds() - start;
+	SPIN_LOCK(traceLock)
+	{
+		if (traceLane == -1)
+		{
+			traceLane = traceLaneCount++;
+		}
+		e.lane = traceLane;
+		traceEvents.Add(e);
+	}
+}
+
+/***********************************************************************
+Trace
+***********************************************************************/
+
+bool IsTraceEnabled()
+{
+#ifdef CPPDOC_TRACE
+	return true;
+#else
+	return false;
+#endif
+}
+
+void StartTrace()
+{
+	SPIN_LOCK(traceLock)
+	{
+		traceEvents.Clear();
+		traceStart = GetMicroseconds();
+		traceRecording = true;
+	}
+}
+
+void StopTrace()
+{
+	traceRecording = false;
+}
+
+void WriteTraceJson(TextWriter& writer)
+{
+	// lanes are numbered in the order of threads recording their first event, they are not reused by the next trace
+	List<WString> lines;
+	SPIN_LOCK(traceLock)
+	{
+		for (vint i = 0; i < traceLaneCount; i++)
+		{
+			lines.Add(L"{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" + itow(i) + L",\"args\":{\"name\":\"thread " + itow(i) + L"\"}}");
+		}
+		for (vint i = 0; i < traceEvents.Count(); i++)
+		{
+			auto& e = traceEvents[i];
+			lines.Add(
+				WString(L"{\"name\":\"") + e.name +
+				L"\",\"ph\":\"X\",\"pid\":0,\"tid\":" + itow(e.lane) +
+				L",\"ts\":" + i64tow(e.start - traceStart) +
+				L",\"dur\":" + i64tow(e.duration) +
+				L",\"args\":{\"detail\":" + ToJsonString(e.detail) + L"}}");
+		}
+	}
+
+	writer.WriteLine(L"{\"traceEvents\":[");
+	for (vint i = 0; i < lines.Count(); i++)
+	{
+		writer.WriteLine(i == lines.Count() - 1 ? lines[i] : lines[i] + L",");
+	}
+	writer.WriteLine(L"]}");
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#ifndef VCZH_DOCUMENT_CPPDOC_TRACE
+#define VCZH_DOCUMENT_CPPDOC_TRACE
+
+#include "Utility.h"
+
+/***********************************************************************
+Trace
+	Scoped events in Chrome trace-event format, only compiled when CPPDOC_TRACE is defined for every project
+	Otherwise CPPDOC_TRACE_* macros compile to nothing
+	Events are only recorded between StartTrace and StopTrace, each thread has its own lane
+***********************************************************************/
+
+class CppTraceScope
+{
+protected:
+	const wchar_t*					name;
+	WString							detail;
+	vint64_t						start = -1;		// -1 if the trace is not recording
+
+public:
+	CppTraceScope(const wchar_t* _name);
+	~CppTraceScope();
+
+	bool							IsRecording()const { return start != -1; }
+	void							SetDetail(const WString& _detail) { detail = _detail; }
+};
+
+extern bool							IsTraceEnabled();
+extern void							StartTrace();
+extern void							StopTrace();
+extern void							WriteTraceJson(stream::TextWriter& writer);		// events recorded by the last StartTrace
+
+#ifdef CPPDOC_TRACE
+#define CPPDOC_TRACE_SCOPE(NAME) CppTraceScope cppdocTraceScope(NAME)
+#define CPPDOC_TRACE_DETAIL(DETAIL) if (cppdocTraceScope.IsRecording()) cppdocTraceScope.SetDetail(DETAIL)
+#else
+#define CPPDOC_TRACE_SCOPE(NAME)
+#define CPPDOC_TRACE_DETAIL(DETAIL)
+#endif
+
+#endif
\ No newline at end of file
@@ -1,4 +1,6 @@
 #include "TypeSystem.h"
+#include "Statistics.h"
+#include "Allocations.h"
 
 class TsysAlloc;
 
@@ -105,6 +107,11 @@ public:
 		refType = TsysRefType::None;
 		return GetEntityInternal(cv, refType);
 	}
+
+	// Remove this type from the type it is created by, called before this type is released
+	virtual void Unregister()
+	{
+	}
 };
 
 template<TsysType Type>
@@ -237,6 +244,11 @@ class ITSYS_CLASS(LRef)
 	{
 		return this;
 	}
+
+	void Unregister()override
+	{
+		element->lrefOf = nullptr;
+	}
 protected:
 	ITsys* GetEntityInternal(TsysCV& cv, TsysRefType& refType)override
 	{
@@ -263,6 +275,11 @@ class ITSYS_CLASS(RRef)
 	{
 		return this;
 	}
+
+	void Unregister()override
+	{
+		element->rrefOf = nullptr;
+	}
 protected:
 	ITsys* GetEntityInternal(TsysCV& cv, TsysRefType& refType)override
 	{
@@ -274,11 +291,21 @@ protected:
 class ITSYS_CLASS(Ptr)
 {
 	ITSYS_MEMBERS_REF(Ptr)
+
+	void Unregister()override
+	{
+		element->ptrOf = nullptr;
+	}
 };
 
 class ITSYS_CLASS(Array)
 {
 	ITSYS_MEMBERS_DECORATE(Array, vint, ParamCount)
+
+	void Unregister()override
+	{
+		element->arrayOf.Remove(data);
+	}
 };
 
 class ITSYS_CLASS(CV)
@@ -291,6 +318,11 @@ class ITSYS_CLASS(CV)
 		cv.isVolatile |= data.isVolatile;
 		return element->CVOf(cv);
 	}
+
+	void Unregister()override
+	{
+		element->cvOf[((data.isGeneralConst ? 1 : 0) << 1) + (data.isVolatile ? 1 : 0) - 1] = nullptr;
+	}
 protected:
 	ITsys* GetEntityInternal(TsysCV& cv, TsysRefType& refType)override
 	{
@@ -302,16 +334,39 @@ protected:
 class ITSYS_CLASS(Member)
 {
 	ITSYS_MEMBERS_DECORATE(Member, ITsys*, Class)
+
+	void Unregister()override
+	{
+		element->memberOf.Remove(data);
+	}
 };
 
 class ITSYS_CLASS(Function)
 {
 	ITSYS_MEMBERS_WITHPARAMS(Function, TsysFunc, Func)
+
+	void Unregister()override
+	{
+		WithParams<ITsys_Function, TsysFunc> key;
+		key.params = &params;
+		key.itsys = this;
+		key.data = data;
+		element->functionOf.Remove(key);
+	}
 };
 
 class ITSYS_CLASS(Generic)
 {
 	ITSYS_MEMBERS_WITHPARAMS(Generic, TsysGeneric, Generic)
+
+	void Unregister()override
+	{
+		WithParams<ITsys_Generic, TsysGeneric> key;
+		key.params = &params;
+		key.itsys = this;
+		key.data = data;
+		element->genericOf.Remove(key);
+	}
 };
 
 
@@ -334,6 +389,19 @@ public:
 ITsys_Allocator
 ***********************************************************************/
 
+#ifdef CPPDOC_ALLOCATIONS
+// Blocks of all ITsys_Allocator of the same ITsys class are accounted together
+template<typename T>
+struct ITsys_Allocations
+{
+	static CppAllocationCategory	category;
+};
+
+#define DEFINE_TSYS_TYPE(NAME) template<> CppAllocationCategory ITsys_Allocations<ITsys_##NAME>::category(L"ITsys", L"ITsys_" L_(#NAME));
+TSYS_TYPE_LIST(DEFINE_TSYS_TYPE)
+#undef DEFINE_TSYS_TYPE
+#endif
+
 template<typename T, vint BlockSize>
 class ITsys_Allocator : public Object
 {
@@ -344,6 +412,11 @@ protected:
 		vint				used = 0;
 		Node*				next = nullptr;
 
+#ifdef CPPDOC_ALLOCATIONS
+		static void* operator new(size_t size) { return ITsys_Allocations<T>::category.Allocate(size); }
+		static void operator delete(void* buffer) { CppAllocationCategory::Free(buffer); }
+#endif
+
 		~Node()
 		{
 			auto itsys = (T*)items;
@@ -356,6 +429,8 @@ protected:
 
 	Node*					firstNode = nullptr;
 	Node*					lastNode = nullptr;
+	vint					count = 0;
+	vint					mark = 0;		// the number of items when Mark() is called
 public:
 
 	~ITsys_Allocator()
@@ -369,6 +444,11 @@ public:
 		}
 	}
 
+	vint Count()
+	{
+		return count;
+	}
+
 	template<typename ...TArgs>
 	T* Alloc(TArgs ...args)
 	{
@@ -384,13 +464,74 @@ public:
 		}
 
 		auto itsys = &((T*)lastNode->items)[lastNode->used++];
+		count++;
 #ifdef VCZH_CHECK_MEMORY_LEAKS_NEW
 #undef new
 #endif
-		return new(itsys)T(args...);
+		auto result = new(itsys)T(args...);
 #ifdef VCZH_CHECK_MEMORY_LEAKS_NEW
 #define new VCZH_CHECK_MEMORY_LEAKS_NEW
 #endif
+		CPPDOC_COUNT_TSYS(result->GetType());
+		return result;
+	}
+
+	void Mark()
+	{
+		mark = count;
+	}
+
+	// Call a function with each item created after the mark
+	template<typename TCallback>
+	void ForEachReleased(const TCallback& callback)
+	{
+		vint index = 0;
+		auto current = firstNode;
+		while (current)
+		{
+			if (index + current->used > mark)
+			{
+				auto itsys = (T*)current->items;
+				for (vint i = (mark > index ? mark - index : 0); i < current->used; i++)
+				{
+					callback(&itsys[i]);
+				}
+			}
+			index += current->used;
+			current = current->next;
+		}
+	}
+
+	// Destroy items created after the mark, all blocks except the last one are full, so the mark is in a known block
+	void Release()
+	{
+		if (count == mark) return;
+
+		vint index = 0;
+		auto current = firstNode;
+		while (index + current->used <= mark)
+		{
+			index += current->used;
+			current = current->next;
+		}
+
+		auto itsys = (T*)current->items;
+		for (vint i = mark - index; i < current->used; i++)
+		{
+			itsys[i].~T();
+		}
+		current->used = mark - index;
+
+		auto next = current->next;
+		current->next = nullptr;
+		lastNode = current;
+		while (next)
+		{
+			auto nextNext = next->next;
+			delete next;
+			next = nextNext;
+		}
+		count = mark;
 	}
 };
 
@@ -406,6 +547,7 @@ protected:
 	ITsys_Primitive*								primitives[(vint)TsysPrimitiveType::_COUNT * (vint)TsysBytes::_COUNT] = { 0 };
 	Dictionary<Symbol*, ITsys_Decl*>				decls;
 	Dictionary<Symbol*, ITsys_GenericArg*>			genericArgs;
+	vint											version = 0;
 
 public:
 	ITsys_Allocator<ITsys_Primitive,	1024>		_primitive;
@@ -487,6 +629,90 @@ public:
 		genericArgs.Add(decl, itsys);
 		return itsys;
 	}
+
+	void RemoveDecl(Symbol* decl)override
+	{
+		decls.Remove(decl);
+		genericArgs.Remove(decl);
+	}
+
+	vint Count()override
+	{
+		return
+			_primitive.Count() + _lref.Count() + _rref.Count() + _ptr.Count() +
+			_array.Count() + _function.Count() + _member.Count() + _cv.Count() +
+			_decl.Count() + _generic.Count() + _genericArg.Count() + _expr.Count();
+	}
+
+	vint GetVersion()override
+	{
+		return version;
+	}
+
+	void Invalidate()override
+	{
+		version++;
+	}
+
+	void Mark()override
+	{
+		_primitive.Mark();
+		_lref.Mark();
+		_rref.Mark();
+		_ptr.Mark();
+		_array.Mark();
+		_function.Mark();
+		_member.Mark();
+		_cv.Mark();
+		_decl.Mark();
+		_generic.Mark();
+		_genericArg.Mark();
+		_expr.Mark();
+	}
+
+	void Release()override
+	{
+		// types after the mark are only referenced by their creators and registries, which are cleaned before anything is destroyed
+		_primitive.ForEachReleased([&](ITsys_Primitive* itsys)
+		{
+			auto primitive = itsys->GetPrimitive();
+			primitives[(vint)TsysBytes::_COUNT * (vint)primitive.type + (vint)primitive.bytes] = nullptr;
+		});
+		_decl.ForEachReleased([&](ITsys_Decl* itsys)
+		{
+			vint index = decls.Keys().IndexOf(itsys->GetDecl());
+			if (index != -1 && decls.Values()[index] == itsys) decls.Remove(itsys->GetDecl());
+		});
+		_genericArg.ForEachReleased([&](ITsys_GenericArg* itsys)
+		{
+			vint index = genericArgs.Keys().IndexOf(itsys->GetDecl());
+			if (index != -1 && genericArgs.Values()[index] == itsys) genericArgs.Remove(itsys->GetDecl());
+		});
+
+		auto unregister = [](TsysBase* itsys) { itsys->Unregister(); };
+		_lref.ForEachReleased(unregister);
+		_rref.ForEachReleased(unregister);
+		_ptr.ForEachReleased(unregister);
+		_array.ForEachReleased(unregister);
+		_function.ForEachReleased(unregister);
+		_member.ForEachReleased(unregister);
+		_cv.ForEachReleased(unregister);
+		_generic.ForEachReleased(unregister);
+
+		_primitive.Release();
+		_lref.Release();
+		_rref.Release();
+		_ptr.Release();
+		_array.Release();
+		_function.Release();
+		_member.Release();
+		_cv.Release();
+		_decl.Release();
+		_generic.Release();
+		_genericArg.Release();
+		_expr.Release();
+		version++;
+	}
 };
 
 Ptr<ITsysAlloc> ITsysAlloc::Create()
@@ -1,7 +1,7 @@
 #ifndef VCZH_DOCUMENT_CPPDOC_TYPESYSTEM
 #define VCZH_DOCUMENT_CPPDOC_TYPESYSTEM
 
-#include <Vlpp.h>
+#include "Utility.h"
 
 using namespace vl;
 using namespace vl::collections;
@@ -171,6 +171,18 @@ public:
 	virtual ITsys*				PrimitiveOf(TsysPrimitive primitive) = 0;
 	virtual ITsys*				DeclOf(Symbol* decl) = 0;
 	virtual ITsys*				GenericArgOf(Symbol* decl) = 0;
+	// Forget types of a symbol that is deleted, types that are already created stay alive
+	virtual void				RemoveDecl(Symbol* decl) = 0;
+	// The number of types created by this allocator
+	virtual vint				Count() = 0;
+	// Results cached with types of this allocator are only valid when the version is not changed
+	virtual vint				GetVersion() = 0;
+	// Make cached results out of date, called when symbols they could refer to are removed
+	virtual void				Invalidate() = 0;
+	// Record the number of types created so far as a high-water mark
+	virtual void				Mark() = 0;
+	// Destroy all types created after the high-water mark and make cached results out of date
+	virtual void				Release() = 0;
 
 	static Ptr<ITsysAlloc>		Create();
 };
@@ -215,6 +227,11 @@ struct ExprTsysItem
 		return 0;
 	}
 
+	vuint64_t GetHash()const
+	{
+		return ((vuint64_t)(vuint)symbol * 31 + (vuint64_t)type) * 31 + (vuint64_t)(vuint)tsys;
+	}
+
 	bool operator==	(const ExprTsysItem& item)const { return Compare(*this, item) == 0; }
 	bool operator!=	(const ExprTsysItem& item)const { return Compare(*this, item) != 0; }
 	bool operator<	(const ExprTsysItem& item)const { return Compare(*this, item) < 0; }
@@ -66,9 +66,9 @@ namespace TestConvert_Helpers
 	template<typename T>
 	Ptr<T> TryGetDeclFromType(ITsys* type)
 	{
-		if (type->GetType() != TsysType::Decl) return false;
+		if (type->GetType() != TsysType::Decl) return nullptr;
 		auto symbol = type->GetDecl();
-		if (symbol->decls.Count() != 1) return false;
+		if (symbol->decls.Count() != 1) return nullptr;
 		return symbol->decls[0].Cast<T>();
 	}
 
@@ -323,6 +323,66 @@ namespace TestConvert_Helpers
 		return false;
 	}
 
+	ClassConversionTable* GetConversionTable(ParsingArguments& pa, Symbol* classSymbol)
+	{
+		auto table = classSymbol->conversionTable;
+		if (table && table->tsys == pa.tsys.Obj() && table->tsysVersion == pa.tsys->GetVersion())
+		{
+			return table.Obj();
+		}
+
+		table = MakePtr<ClassConversionTable>();
+		table->tsys = pa.tsys.Obj();
+		table->tsysVersion = pa.tsys->GetVersion();
+		ParsingArguments newPa(pa, classSymbol);
+
+		vint index = classSymbol->children.Keys().IndexOf(L"$__type");
+		if (index != -1)
+		{
+			const auto& typeOps = classSymbol->children.GetByIndex(index);
+			for (vint i = 0; i < typeOps.Count(); i++)
+			{
+				auto typeOpSymbol = typeOps[i];
+				if (typeOpSymbol->decls.Count() != 1) continue;
+				auto typeOpDecl = typeOpSymbol->decls[0].Cast<ForwardFunctionDeclaration>();
+				if (typeOpDecl->decoratorExplicit) break;
+				auto typeOpType = GetTypeWithoutMemberAndCC(typeOpDecl->type).Cast<FunctionType>();
+				if (!typeOpType) continue;
+				if (typeOpType->parameters.Count() != 0) continue;
+
+				TypeTsysList targetTypes;
+				TypeToTsys(newPa, typeOpType->returnType, targetTypes);
+				for (vint j = 0; j < targetTypes.Count(); j++)
+				{
+					table->typeOps.Add({ typeOpType,targetTypes[j] });
+				}
+			}
+		}
+
+		index = classSymbol->children.Keys().IndexOf(L"$__ctor");
+		if (index != -1)
+		{
+			const auto& ctors = classSymbol->children.GetByIndex(index);
+			for (vint i = 0; i < ctors.Count(); i++)
+			{
+				auto ctorSymbol = ctors[i];
+				if (ctorSymbol->decls.Count() != 1) continue;
+				auto ctorDecl = ctorSymbol->decls[0].Cast<ForwardFunctionDeclaration>();
+				if (ctorDecl->decoratorExplicit) break;
+				auto ctorType = GetTypeWithoutMemberAndCC(ctorDecl->type).Cast<FunctionType>();
+				if (!ctorType) continue;
+				if (ctorType->parameters.Count() != 1) continue;
+
+				TypeTsysList sourceTypes;
+				TypeToTsys(newPa, ctorType->parameters[0]->type, sourceTypes);
+				CopyFrom(table->ctorSources, sourceTypes, true);
+			}
+		}
+
+		classSymbol->conversionTable = table;
+		return table.Obj();
+	}
+
 	bool IsCustomOperatorConversion(ParsingArguments& pa, ITsys* toType, ITsys* fromType)
 	{
 		TsysCV fromCV;
@@ -333,30 +393,16 @@ namespace TestConvert_Helpers
 		if (!fromClass) return false;
 
 		auto fromSymbol = fromClass->symbol;
-		vint index = fromSymbol->children.Keys().IndexOf(L"$__type");
-		if (index == -1) return false;
-		const auto& typeOps = fromSymbol->children.GetByIndex(index);
+		auto table = GetConversionTable(pa, fromSymbol);
 
 		ParsingArguments newPa(pa, fromSymbol);
-		for (vint i = 0; i < typeOps.Count(); i++)
+		for (vint i = 0; i < table->typeOps.Count(); i++)
 		{
-			auto typeOpSymbol = typeOps[i];
-			if (typeOpSymbol->decls.Count() != 1) continue;
-			auto typeOpDecl = typeOpSymbol->decls[0].Cast<ForwardFunctionDeclaration>();
-			if (typeOpDecl->decoratorExplicit) return false;
-			auto typeOpType = GetTypeWithoutMemberAndCC(typeOpDecl->type).Cast<FunctionType>();
-			if (!typeOpType) continue;
-			if (typeOpType->parameters.Count() != 0) continue;
-			if (TestFunctionQualifier(fromCV, fromRef, typeOpType) == TsysConv::Illegal) continue;
-
-			TypeTsysList targetTypes;
-			TypeToTsys(newPa, typeOpType->returnType, targetTypes);
-			for (vint j = 0; j < targetTypes.Count(); j++)
+			auto typeOp = table->typeOps[i];
+			if (TestFunctionQualifier(fromCV, fromRef, typeOp.f0) == TsysConv::Illegal) continue;
+			if (TestConvertInternal(newPa, toType, typeOp.f1->RRefOf()) != TsysConv::Illegal)
 			{
-				if (TestConvertInternal(newPa, toType, targetTypes[j]->RRefOf()) != TsysConv::Illegal)
-				{
-					return true;
-				}
+				return true;
 			}
 		}
 
@@ -375,30 +421,14 @@ namespace TestConvert_Helpers
 
 		auto toSymbol = toClass->symbol;
 		if (TestConvertInternal(pa, toType, pa.tsys->DeclOf(toSymbol)->RRefOf()) == TsysConv::Illegal) return false;
-
-		vint index = toSymbol->children.Keys().IndexOf(L"$__ctor");
-		if (index == -1) return false;
-		const auto& ctors = toSymbol->children.GetByIndex(index);
+		auto table = GetConversionTable(pa, toSymbol);
 
 		ParsingArguments newPa(pa, toSymbol);
-		for (vint i = 0; i < ctors.Count(); i++)
+		for (vint i = 0; i < table->ctorSources.Count(); i++)
 		{
-			auto ctorSymbol = ctors[i];
-			if (ctorSymbol->decls.Count() != 1) continue;
-			auto ctorDecl = ctorSymbol->decls[0].Cast<ForwardFunctionDeclaration>();
-			if (ctorDecl->decoratorExplicit) return false;
-			auto ctorType = GetTypeWithoutMemberAndCC(ctorDecl->type).Cast<FunctionType>();
-			if (!ctorType) continue;
-			if (ctorType->parameters.Count() != 1) continue;
-
-			TypeTsysList sourceTypes;
-			TypeToTsys(newPa, ctorType->parameters[0]->type, sourceTypes);
-			for (vint j = 0; j < sourceTypes.Count(); j++)
+			if (TestConvertInternal(newPa, table->ctorSources[i], fromType) != TsysConv::Illegal)
 			{
-				if (TestConvertInternal(newPa, sourceTypes[j], fromType) != TsysConv::Illegal)
-				{
-					return true;
-				}
+				return true;
 			}
 		}
 
@@ -447,5 +477,6 @@ TsysConv TestConvertInternal(ParsingArguments& pa, ITsys* toType, ITsys* fromTyp
 
 TsysConv TestConvert(ParsingArguments& pa, ITsys* toType, ExprTsysItem fromItem)
 {
+	CPPDOC_COUNT(testConvertCalls);
 	return TestConvertInternal(pa, toType, (fromItem.type == ExprTsysType::LValue ? fromItem.tsys->LRefOf() : fromItem.tsys));
 }
\ No newline at end of file
@@ -1,5 +1,59 @@
 #include "Utility.h"
+
+#if defined VCZH_MSVC
 #include <Windows.h>
+#include <Psapi.h>
+#elif defined VCZH_GCC
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#endif
+
+/***********************************************************************
+Common
+***********************************************************************/
+
+WString ToJsonString(const WString& text)
+{
+	return stream::GenerateToStream([&](stream::StreamWriter& writer)
+	{
+		writer.WriteChar(L'\"');
+		for (vint i = 0; i < text.Length(); i++)
+		{
+			auto c = text[i];
+			switch (c)
+			{
+			case L'\"':	writer.WriteString(L"\\\""); break;
+			case L'\\':	writer.WriteString(L"\\\\"); break;
+			case L'\n':	writer.WriteString(L"\\n"); break;
+			case L'\r':	writer.WriteString(L"\\r"); break;
+			case L'\t':	writer.WriteString(L"\\t"); break;
+			default:
+				if (c < 0x20)
+				{
+					auto hex = L"0123456789ABCDEF";
+					writer.WriteString(L"\\u00");
+					writer.WriteChar(hex[c / 16]);
+					writer.WriteChar(hex[c % 16]);
+				}
+				else
+				{
+					writer.WriteChar(c);
+				}
+			}
+		}
+		writer.WriteChar(L'\"');
+	});
+}
+
+#if defined VCZH_MSVC
+
+/***********************************************************************
+Windows
+***********************************************************************/
 
 wchar_t* ReadBigFile(const FilePath& filePath)
 {
@@ -23,4 +77,151 @@ wchar_t* ReadBigFile(const FilePath& filePath)
 
 	delete[] utf8;
 	return buffer;
-}
\ No newline at end of file
+}
+
+const void* MapBigFile(const FilePath& filePath, vint& size, void*& mapping)
+{
+	size = 0;
+	mapping = nullptr;
+
+	HANDLE handle = CreateFile(filePath.GetFullPath().Buffer(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, NULL, NULL);
+	if (handle == INVALID_HANDLE_VALUE) return nullptr;
+
+	DWORD fileSize = GetFileSize(handle, NULL);
+	if (fileSize == INVALID_FILE_SIZE || fileSize == 0)
+	{
+		CloseHandle(handle);
+		return nullptr;
+	}
+
+	HANDLE fileMapping = CreateFileMapping(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(handle);
+	if (!fileMapping) return nullptr;
+
+	auto buffer = MapViewOfFile(fileMapping, FILE_MAP_READ, 0, 0, 0);
+	if (!buffer)
+	{
+		CloseHandle(fileMapping);
+		return nullptr;
+	}
+
+	size = (vint)fileSize;
+	mapping = fileMapping;
+	return buffer;
+}
+
+void UnmapBigFile(const void* buffer, void* mapping)
+{
+	UnmapViewOfFile(buffer);
+	CloseHandle((HANDLE)mapping);
+}
+
+vint64_t GetMicroseconds()
+{
+	static LARGE_INTEGER frequency = []()
+	{
+		LARGE_INTEGER result;
+		QueryPerformanceFrequency(&result);
+		return result;
+	}();
+
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	return (vint64_t)(counter.QuadPart / frequency.QuadPart * 1000000 + counter.QuadPart % frequency.QuadPart * 1000000 / frequency.QuadPart);
+}
+
+vint64_t GetPeakMemoryUsage()
+{
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+	return (vint64_t)counters.PeakWorkingSetSize;
+}
+
+vint GetProcessIdentifier()
+{
+	return (vint)GetCurrentProcessId();
+}
+
+bool MoveFileOver(const FilePath& source, const FilePath& destination)
+{
+	return MoveFileEx(source.GetFullPath().Buffer(), destination.GetFullPath().Buffer(), MOVEFILE_REPLACE_EXISTING) != 0;
+}
+
+#elif defined VCZH_GCC
+
+/***********************************************************************
+Linux
+***********************************************************************/
+
+using namespace vl::stream;
+
+wchar_t* ReadBigFile(const FilePath& filePath)
+{
+	FileStream fileStream(filePath.GetFullPath(), FileStream::ReadOnly);
+	TEST_ASSERT(fileStream.IsAvailable());
+
+	Utf8Decoder decoder;
+	DecoderStream decoderStream(fileStream, decoder);
+	StreamReader reader(decoderStream);
+	auto text = reader.ReadToEnd();
+
+	auto buffer = new wchar_t[text.Length() + 1];
+	memcpy(buffer, text.Buffer(), sizeof(wchar_t) * (text.Length() + 1));
+	return buffer;
+}
+
+// mapping keeps the size of the view, which munmap needs
+const void* MapBigFile(const FilePath& filePath, vint& size, void*& mapping)
+{
+	size = 0;
+	mapping = nullptr;
+
+	int handle = open(wtoa(filePath.GetFullPath()).Buffer(), O_RDONLY);
+	if (handle == -1) return nullptr;
+
+	struct stat fileStat;
+	if (fstat(handle, &fileStat) != 0 || fileStat.st_size == 0)
+	{
+		close(handle);
+		return nullptr;
+	}
+
+	auto buffer = mmap(nullptr, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, handle, 0);
+	close(handle);
+	if (buffer == MAP_FAILED) return nullptr;
+
+	size = (vint)fileStat.st_size;
+	mapping = (void*)(size_t)fileStat.st_size;
+	return buffer;
+}
+
+void UnmapBigFile(const void* buffer, void* mapping)
+{
+	munmap((void*)buffer, (size_t)mapping);
+}
+
+vint64_t GetMicroseconds()
+{
+	timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return (vint64_t)time.tv_sec * 1000000 + time.tv_nsec / 1000;
+}
+
+vint64_t GetPeakMemoryUsage()
+{
+	rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+	return (vint64_t)usage.ru_maxrss * 1024;
+}
+
+vint GetProcessIdentifier()
+{
+	return (vint)getpid();
+}
+
+bool MoveFileOver(const FilePath& source, const FilePath& destination)
+{
+	return rename(wtoa(source.GetFullPath()).Buffer(), wtoa(destination.GetFullPath()).Buffer()) == 0;
+}
+
+#endif
\ No newline at end of file
@@ -4,8 +4,148 @@
 #include "Vlpp.h"
 
 using namespace vl;
+using namespace vl::collections;
 using namespace vl::filesystem;
 
 extern wchar_t* ReadBigFile(const FilePath& filePath);
+extern const void* MapBigFile(const FilePath& filePath, vint& size, void*& mapping);
+extern void UnmapBigFile(const void* buffer, void* mapping);
+extern vint64_t GetMicroseconds();		// a monotonic clock for measuring time
+extern vint64_t GetPeakMemoryUsage();	// peak resident memory of this process in bytes, 0 if unknown
+extern vint GetProcessIdentifier();		// the identifier of this process
+extern bool MoveFileOver(const FilePath& source, const FilePath& destination);	// rename a file and replace the destination, atomic in the same folder
+extern WString ToJsonString(const WString& text);	// quote and escape a string in JSON
+
+/***********************************************************************
+SmallSet
+***********************************************************************/
+
+// Hash of an item in SmallSet, a type that is not a pointer provides vuint64_t GetHash()const
+template<typename T>
+struct SmallSetHash
+{
+	static vuint64_t Get(const T& item) { return item.GetHash(); }
+};
+
+template<typename T>
+struct SmallSetHash<T*>
+{
+	static vuint64_t Get(T* item) { return (vuint64_t)(vuint)item; }
+};
+
+// A list that ignores duplicated items and keeps the insertion order
+// Items are searched linearly until there are more than IndexThreshold items, after that a hash index is maintained
+template<typename T, vint IndexThreshold = 4>
+class SmallSet : public List<T>
+{
+	using BaseList = List<T>;
+protected:
+	Array<vint>						index;		// open addressing, position of an item plus one in each slot, 0 for an empty slot
+
+	using BaseList::Set;
+	using BaseList::Insert;
+	using BaseList::RemoveRange;
+
+	vint GetSlot(const T& item)const
+	{
+		// Fibonacci hashing, the number of slots is a power of 2
+		vint mask = index.Count() - 1;
+		return (vint)((SmallSetHash<T>::Get(item) * 11400714819323198485ULL) >> 32) & mask;
+	}
+
+	void AddToIndex(vint position)
+	{
+		vint mask = index.Count() - 1;
+		vint slot = GetSlot(BaseList::Get(position));
+		while (index[slot] != 0) slot = (slot + 1) & mask;
+		index[slot] = position + 1;
+	}
+
+	void RebuildIndex()
+	{
+		if (this->Count() <= IndexThreshold)
+		{
+			index.Resize(0);
+			return;
+		}
+
+		// at most half of slots are used
+		vint slots = 16;
+		while (slots < this->Count() * 2) slots *= 2;
+		index.Resize(slots);
+		for (vint i = 0; i < slots; i++) index[i] = 0;
+		for (vint i = 0; i < this->Count(); i++) AddToIndex(i);
+	}
+
+public:
+	const T& operator[](vint i)const
+	{
+		return BaseList::Get(i);
+	}
+
+	bool Contains(const T& item)const
+	{
+		if (index.Count() == 0) return BaseList::Contains(item);
+
+		vint mask = index.Count() - 1;
+		for (vint slot = GetSlot(item); index[slot] != 0; slot = (slot + 1) & mask)
+		{
+			if (BaseList::Get(index[slot] - 1) == item) return true;
+		}
+		return false;
+	}
+
+	// Returns false if the item already exists
+	bool Add(const T& item)
+	{
+		if (Contains(item)) return false;
+		BaseList::Add(item);
+		if (this->Count() * 2 > index.Count())
+		{
+			RebuildIndex();
+		}
+		else
+		{
+			AddToIndex(this->Count() - 1);
+		}
+		return true;
+	}
+
+	bool Remove(const T& item)
+	{
+		if (!BaseList::Remove(item)) return false;
+		RebuildIndex();
+		return true;
+	}
+
+	bool RemoveAt(vint i)
+	{
+		if (!BaseList::RemoveAt(i)) return false;
+		RebuildIndex();
+		return true;
+	}
+
+	bool Clear()
+	{
+		index.Resize(0);
+		return BaseList::Clear();
+	}
+};
+
+namespace vl
+{
+	namespace collections
+	{
+		namespace randomaccess_internal
+		{
+			template<typename T, vint IndexThreshold>
+			struct RandomAccessable<SmallSet<T, IndexThreshold>>
+			{
+				static const bool			CanRead = true;
+				static const bool			CanResize = false;
+			};
+		}
+	}
+}
 
 #endif
\ No newline at end of file
@@ -0,0 +1,162 @@
+#include <Ast_Decl.h>
+#include <Document.h>
+#include "Util.h"
+
+WString LogDocument(List<DocumentEvent>& events)
+{
+	WString log;
+	for (vint i = 0; i < events.Count(); i++)
+	{
+		auto& e = events[i];
+		WString reading(e.reading, e.length);
+		switch (e.kind)
+		{
+		case DocumentEventKind::ElementBegin:	log += L"<" + reading + L">"; break;
+		case DocumentEventKind::Attribute:		log += L"@" + reading + L"=" + WString(e.value, e.valueLength); break;
+		case DocumentEventKind::ElementEnd:		log += L"</" + reading + L">"; break;
+		case DocumentEventKind::ParagraphBegin:	log += L"[p]"; break;
+		case DocumentEventKind::ParagraphEnd:	log += L"[/p]"; break;
+		case DocumentEventKind::ListItemBegin:	log += L"[li]"; break;
+		case DocumentEventKind::ListItemEnd:	log += L"[/li]"; break;
+		case DocumentEventKind::CodeBlockBegin:	log += L"[code:" + WString(e.value, e.valueLength) + L"]"; break;
+		case DocumentEventKind::CodeBlockEnd:	log += L"[/code]"; break;
+		case DocumentEventKind::StrongBegin:	log += L"[b]"; break;
+		case DocumentEventKind::StrongEnd:		log += L"[/b]"; break;
+		case DocumentEventKind::EmphasisBegin:	log += L"[i]"; break;
+		case DocumentEventKind::EmphasisEnd:	log += L"[/i]"; break;
+		case DocumentEventKind::Code:			log += L"`" + reading + L"`"; break;
+		case DocumentEventKind::Text:			log += L"'" + reading + L"'"; break;
+		}
+	}
+	return log;
+}
+
+TEST_CASE(TestDocument_Parse)
+{
+	WString input = LR"(
+/// <summary>The **main** function.</summary>
+/// <remarks>
+/// Call `f` with *x* and <see cref="a::X"/>.
+/// - first
+///   line
+/// - second <c>code</c>
+///
+/// ```cpp
+///   int x;
+/// ```
+/// </remarks>
+/// 1 * 2 </unknown> <broken
+int main();
+)";
+
+	CppTokenReader reader(GlobalCppLexer(), input);
+	auto cursor = reader.GetFirstToken();
+	List<DocumentEvent> events;
+	ParseDocument(reader.GetDocuments(), cursor->document, events);
+
+	auto log = LogDocument(events);
+	TEST_ASSERT(log ==
+		L"<summary>[p]'The '[b]'main'[/b]' function.'[/p]</summary>"
+		L"<remarks>[p]'Call '`f`' with '[i]'x'[/i]' and '<see>@cref=a::X</see>'.'[/p]"
+		L"[li]'first''line'[/li]"
+		L"[li]'second '<c>'code'</c>[/li]"
+		L"[code:cpp]'  int x;'[/code]"
+		L"</remarks>"
+		L"[p]'1 * 2 </unknown> <broken'[/p]"
+		);
+
+	// every event points to the input
+	for (vint i = 0; i < events.Count(); i++)
+	{
+		auto& e = events[i];
+		if (e.reading)
+		{
+			TEST_ASSERT(input.Buffer() + e.start == e.reading);
+		}
+	}
+}
+
+TEST_CASE(TestDocument_Resolve)
+{
+	WString input = LR"(
+namespace a
+{
+	/// <summary>See <see cref="Y"/> and <see cref="b::Z"/></summary>
+	struct X
+	{
+		/// <see cref="X"/> <see cref="Y"/>
+		int x;
+	};
+
+	struct Y {};
+
+	namespace b
+	{
+		/// <see cref="X"/> <see cref="::a::X"/> <see cref="a::Y::x"/> <see cref="int"/>
+		struct Z {};
+	}
+}
+/// <see cref="a::X::x"/> <see cref="a::X"/>
+int f();
+)";
+
+	CppTokenReader reader(GlobalCppLexer(), input);
+	auto cursor = reader.GetFirstToken();
+	ParsingArguments pa(new Symbol, ITsysAlloc::Create(), nullptr);
+	auto program = ParseProgram(pa, cursor);
+	TEST_ASSERT(!cursor);
+
+	List<Ptr<DeclarationDocument>> documents;
+	CollectDocuments(pa, program, documents);
+	ParseDocuments(reader.GetDocuments(), documents, 2);
+
+	DocumentReferenceCache cache;
+	ResolveDocuments(pa, documents, cache);
+
+	auto a = pa.root->children[L"a"][0].Obj();
+	auto x = a->children[L"X"][0].Obj();
+	auto y = a->children[L"Y"][0].Obj();
+	auto z = a->children[L"b"][0]->children[L"Z"][0].Obj();
+	auto xx = x->children[L"x"][0].Obj();
+
+	// names are resolved from the class or the namespace containing the declaration, or the class itself
+	Symbol* expected[][4] =
+	{
+		{ y, z, nullptr, nullptr },
+		{ x, y, nullptr, nullptr },
+		{ x, x, nullptr, nullptr },
+		{ xx, x, nullptr, nullptr },
+	};
+	vint counts[] = { 2, 2, 4, 2 };
+
+	TEST_ASSERT(documents.Count() == 4);
+	TEST_ASSERT(documents[0]->scope == x);
+	TEST_ASSERT(documents[1]->scope == x);
+	TEST_ASSERT(documents[2]->scope == z);
+	TEST_ASSERT(documents[3]->scope == pa.root.Obj());
+	for (vint i = 0; i < documents.Count(); i++)
+	{
+		vint count = 0;
+		auto& events = documents[i]->events;
+		for (vint j = 0; j < events.Count(); j++)
+		{
+			auto& e = events[j];
+			if (e.kind != DocumentEventKind::Attribute) continue;
+			if (expected[i][count])
+			{
+				TEST_ASSERT(e.resolving);
+				TEST_ASSERT(e.resolving->resolvedSymbols.Count() == 1);
+				TEST_ASSERT(e.resolving->resolvedSymbols[0] == expected[i][count]);
+			}
+			else
+			{
+				TEST_ASSERT(!e.resolving);
+			}
+			count++;
+		}
+		TEST_ASSERT(count == counts[i]);
+	}
+
+	// a name is resolved once in each scope, Y is shared by a::X and a::X::x
+	TEST_ASSERT(cache.results.Count() == 9);
+}
\ No newline at end of file
@@ -417,8 +417,6 @@ int main()
 )";
 	const wchar_t* output[] = {
 		L"using", L"namespace", L"std", L";",
-		L"/// <summary>The main function.</summary>",
-		L"/// <returns>This value is not used.</returns>",
 		L"int", L"main", L"(", L")",
 		L"{",
 		L"cout", L"<", L"<", L"\"Hello, world!\"", L"<", L"<", L"endl", L";",
@@ -465,4 +463,34 @@ int main()
 			}
 		}
 	}
+
+	// DOCUMENT tokens are not in the stream, they are attached to the next token
+	const wchar_t* documents[] = {
+		L"/// <summary>The main function.</summary>",
+		L"/// <returns>This value is not used.</returns>",
+	};
+	auto& readDocuments = reader.GetDocuments();
+	TEST_ASSERT(readDocuments.Count() == sizeof(documents) / sizeof(*documents));
+	for (vint i = 0; i < readDocuments.Count(); i++)
+	{
+		TEST_ASSERT(WString(readDocuments[i].reading, readDocuments[i].length) == documents[i]);
+	}
+
+	CppTokenReader documentReader(GlobalCppLexer(), input);
+	auto cursor = documentReader.GetFirstToken();
+	for (vint i = 0; i < TokenCount; i++)
+	{
+		auto& document = cursor->document;
+		if (i == 4)
+		{
+			TEST_ASSERT(document.start == 0);
+			TEST_ASSERT(document.count == 2);
+		}
+		else
+		{
+			TEST_ASSERT(document.start == -1);
+			TEST_ASSERT(document.count == 0);
+		}
+		cursor = cursor->Next();
+	}
 }
\ No newline at end of file
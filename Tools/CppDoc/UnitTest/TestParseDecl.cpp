@@ -1,4 +1,7 @@
 #include <Ast_Decl.h>
+#include <IndexFile.h>
+#include <ParallelParser.h>
+#include <PrefixSnapshot.h>
 #include "Util.h"
 
 TEST_CASE(TestParseDecl_Namespaces)
@@ -240,6 +243,13 @@ namespace a::b
 			TEST_ASSERT(symbol->forwardDeclarations.Count() == 0);
 		}
 	}
+
+	vint defaultParameterCounts[] = { 2,0,0,0,2 };
+	for (vint i = 0; i < 5; i++)
+	{
+		auto decl = symbols[i]->decls[0].Cast<ForwardFunctionDeclaration>();
+		TEST_ASSERT(decl->defaultParameterCount == defaultParameterCounts[i]);
+	}
 }
 
 TEST_CASE(TestParseDecl_Classes)
@@ -545,6 +555,39 @@ namespace a
 	}
 }
 
+TEST_CASE(TestParseDecl_CalibrateForwardDeclarations)
+{
+	auto input = LR"(
+struct A;
+struct A;
+A* p;
+struct A { int x; };
+)";
+
+	Ptr<Resolving> resolving;
+	auto recorder = CreateTestIndexRecorder([&](CppName& name, Ptr<Resolving> _resolving)
+	{
+		TEST_ASSERT(name.name == L"A");
+		resolving = _resolving;
+	});
+	COMPILE_PROGRAM_WITH_RECORDER(program, pa, input, recorder);
+
+	const auto& symbols = pa.root->children[L"A"];
+	TEST_ASSERT(symbols.Count() == 3);
+	TEST_ASSERT(symbols[0]->forwardDeclarationRoot == symbols[2].Obj());
+	TEST_ASSERT(symbols[1]->forwardDeclarationRoot == symbols[2].Obj());
+
+	// both forward declarations are resolved before the definition, and they are replaced by the same definition
+	TEST_ASSERT(resolving);
+	TEST_ASSERT(resolving->resolvedSymbols.Count() == 2);
+	TEST_ASSERT(resolving->resolvedSymbols[0] == symbols[0].Obj());
+	TEST_ASSERT(resolving->resolvedSymbols[1] == symbols[1].Obj());
+
+	resolving->Calibrate();
+	TEST_ASSERT(resolving->resolvedSymbols.Count() == 1);
+	TEST_ASSERT(resolving->resolvedSymbols[0] == symbols[2].Obj());
+}
+
 TEST_CASE(TestParseDecl_ClassMemberScope)
 {
 	auto input = LR"(
@@ -711,4 +754,999 @@ namespace c
 	});
 	AssertProgram(input, output, recorder);
 	TEST_ASSERT(accessed.Count() == 10);
+}
+
+TEST_CASE(TestParseDecl_IndexTable)
+{
+	auto input = LR"(
+namespace a::b
+{
+	struct X {};
+	enum class Y {};
+}
+namespace c
+{
+	using namespace a::b;
+	struct Z : X
+	{
+		a::b::Y y1;
+		Y y2;
+	};
+}
+)";
+
+	List<WString> names;
+	List<vint> rows, columns;
+	List<Symbol*> symbols;
+	auto recorder = CreateTestIndexRecorder([&](CppName& name, Ptr<Resolving> resolving)
+	{
+		TEST_ASSERT(resolving->resolvedSymbols.Count() == 1);
+		names.Add(name.name);
+		rows.Add(name.nameTokens[0].rowStart);
+		columns.Add(name.nameTokens[0].columnStart);
+		symbols.Add(resolving->resolvedSymbols[0]);
+	});
+
+	CppTokenReader reader(GlobalCppLexer(), input);
+	auto cursor = reader.GetFirstToken();
+	ParsingArguments pa(new Symbol, ITsysAlloc::Create(), recorder);
+	pa.index = MakePtr<IndexTable>();
+	auto program = ParseProgram(pa, cursor);
+	TEST_ASSERT(!cursor);
+
+	auto index = pa.index;
+	TEST_ASSERT(names.Count() == 11);
+	TEST_ASSERT(index->Count() == names.Count());
+	TEST_ASSERT(index->symbols.Count() == names.Count());
+	TEST_ASSERT(index->atoms.Count() == 4);
+	for (vint i = 0; i < index->Count(); i++)
+	{
+		TEST_ASSERT(index->atoms[index->nameAtoms[i]] == names[i]);
+		TEST_ASSERT(index->tokenRows[i] == rows[i]);
+		TEST_ASSERT(index->tokenColumns[i] == columns[i]);
+		TEST_ASSERT(index->reasons[i] == IndexReason::Resolved);
+		TEST_ASSERT(index->symbolStarts[i] == i);
+		TEST_ASSERT(index->symbolCounts[i] == 1);
+		TEST_ASSERT(index->symbols[i] == symbols[i]);
+	}
+}
+
+TEST_CASE(TestParseDecl_IndexFile)
+{
+	auto input = LR"(
+namespace a
+{
+	struct X;
+	struct X {};
+	enum class Y { Z };
+}
+namespace b
+{
+	a::X x1;
+	a::Y y1;
+	a::Y y2;
+}
+)";
+
+	CppTokenReader reader(GlobalCppLexer(), input);
+	auto cursor = reader.GetFirstToken();
+	ParsingArguments pa(new Symbol, ITsysAlloc::Create(), nullptr);
+	pa.index = MakePtr<IndexTable>();
+	auto program = ParseProgram(pa, cursor);
+	TEST_ASSERT(!cursor);
+
+	vl::stream::MemoryStream stream;
+	WriteIndexFile(stream, pa.root.Obj(), *pa.index.Obj());
+	auto file = IndexFile::Load(stream.GetInternalBuffer(), (vint)stream.Size());
+	TEST_ASSERT(file);
+	TEST_ASSERT(!IndexFile::Load(stream.GetInternalBuffer(), (vint)stream.Size() - 1));
+
+	auto findChild = [&](vint parent, const wchar_t* name)
+	{
+		auto& symbol = file->GetSymbol(parent);
+		for (vint i = 0; i < symbol.childCount; i++)
+		{
+			vint child = symbol.firstChild + i;
+			if (WString(file->GetString(file->GetSymbol(child).name)) == name)
+			{
+				return child;
+			}
+		}
+		return (vint)-1;
+	};
+
+	TEST_ASSERT(file->GetSymbol(0).kind == IndexSymbolKind::Root);
+	TEST_ASSERT(file->GetSymbol(0).parent == -1);
+
+	vint a = findChild(0, L"a");
+	vint b = findChild(0, L"b");
+	TEST_ASSERT(a != -1 && b != -1);
+	TEST_ASSERT(file->GetSymbol(a).kind == IndexSymbolKind::Namespace);
+	TEST_ASSERT(file->GetSymbol(a).referenceCount == 3);
+
+	vint y = findChild(a, L"Y");
+	TEST_ASSERT(y != -1);
+	TEST_ASSERT(file->GetSymbol(y).parent == a);
+	TEST_ASSERT(file->GetSymbol(y).kind == IndexSymbolKind::Enum);
+	TEST_ASSERT(file->GetSymbol(y).declarationCount == 1);
+	auto& yDecl = file->GetDeclaration(file->GetSymbol(y).firstDeclaration);
+	TEST_ASSERT(yDecl.symbol == y);
+	TEST_ASSERT(yDecl.row == 5);
+	TEST_ASSERT(yDecl.column == 12);
+
+	TEST_ASSERT(findChild(y, L"Z") != -1);
+	TEST_ASSERT(file->GetSymbol(findChild(y, L"Z")).kind == IndexSymbolKind::EnumItem);
+
+	auto& ySymbol = file->GetSymbol(y);
+	TEST_ASSERT(ySymbol.referenceCount == 2);
+	auto& yRef1 = file->GetReference(ySymbol.firstReference);
+	auto& yRef2 = file->GetReference(ySymbol.firstReference + 1);
+	TEST_ASSERT(yRef1.symbol == y && yRef1.row == 10 && yRef1.column == 4);
+	TEST_ASSERT(yRef2.symbol == y && yRef2.row == 11 && yRef2.column == 4);
+
+	vint x = findChild(a, L"X");
+	TEST_ASSERT(x != -1);
+	TEST_ASSERT(file->GetSymbol(x).kind == IndexSymbolKind::Class);
+}
+
+TEST_CASE(TestParseDecl_IndexFileCorrupted)
+{
+	auto input = LR"(
+namespace a
+{
+	struct X;
+	struct X {};
+}
+a::X x;
+)";
+
+	CppTokenReader reader(GlobalCppLexer(), input);
+	auto cursor = reader.GetFirstToken();
+	ParsingArguments pa(new Symbol, ITsysAlloc::Create(), nullptr);
+	pa.index = MakePtr<IndexTable>();
+	auto program = ParseProgram(pa, cursor);
+	TEST_ASSERT(!cursor);
+
+	vl::stream::MemoryStream stream;
+	WriteIndexFile(stream, pa.root.Obj(), *pa.index.Obj(), L"A.i");
+	Array<vuint8_t> buffer((vint)stream.Size());
+	memcpy(&buffer[0], stream.GetInternalBuffer(), buffer.Count());
+	TEST_ASSERT(IndexFile::Load(&buffer[0], buffer.Count()));
+
+	auto header = *reinterpret_cast<IndexFileHeader*>(&buffer[0]);
+	TEST_ASSERT(header.symbols.count > 2);
+	TEST_ASSERT(header.declarations.count > 0);
+	TEST_ASSERT(header.references.count > 0);
+
+	// change one field, check that the file is rejected, and restore the field
+	auto corrupt = [&](const IndexFileSection& section, vint index, vint recordSize, vint fieldOffset, vint32_t value)
+	{
+		auto field = reinterpret_cast<vint32_t*>(&buffer[section.offset + index * recordSize + fieldOffset]);
+		auto original = *field;
+		*field = value;
+		TEST_ASSERT(!IndexFile::Load(&buffer[0], buffer.Count()));
+		*field = original;
+		TEST_ASSERT(IndexFile::Load(&buffer[0], buffer.Count()));
+	};
+
+#define CORRUPT(SECTION, RECORD, INDEX, FIELD, VALUE) corrupt(header.SECTION, INDEX, sizeof(RECORD), offsetof(RECORD, FIELD), VALUE)
+	corrupt(header.files, 0, sizeof(vint32_t), 0, header.strings.count);
+	CORRUPT(symbols, IndexFileSymbol, 0, parent, 0);
+	CORRUPT(symbols, IndexFileSymbol, 1, parent, -1);
+	CORRUPT(symbols, IndexFileSymbol, 1, parent, header.symbols.count);
+	CORRUPT(symbols, IndexFileSymbol, 1, name, header.strings.count);
+	CORRUPT(symbols, IndexFileSymbol, 1, signature, header.strings.count);
+	CORRUPT(symbols, IndexFileSymbol, 1, kind, -1);
+	CORRUPT(symbols, IndexFileSymbol, 1, forwardRoot, header.symbols.count);
+	CORRUPT(symbols, IndexFileSymbol, 0, firstChild, header.symbols.count);
+	CORRUPT(symbols, IndexFileSymbol, 0, childCount, -1);
+	CORRUPT(symbols, IndexFileSymbol, 1, firstDeclaration, header.declarations.count);
+	CORRUPT(symbols, IndexFileSymbol, 1, declarationCount, header.declarations.count + 1);
+	CORRUPT(symbols, IndexFileSymbol, 1, firstReference, -1);
+	CORRUPT(symbols, IndexFileSymbol, 1, referenceCount, header.references.count + 1);
+	CORRUPT(declarations, IndexFileDeclaration, 0, symbol, header.symbols.count);
+	CORRUPT(declarations, IndexFileDeclaration, 0, file, header.files.count);
+	CORRUPT(references, IndexFileReference, 0, symbol, -1);
+	CORRUPT(references, IndexFileReference, 0, file, header.files.count);
+	corrupt(header.positions, 0, sizeof(vint32_t), 0, header.references.count);
+	CORRUPT(strings, IndexFileString, 0, offset, header.chars.count);
+	CORRUPT(strings, IndexFileString, 0, length, header.chars.count);
+#undef CORRUPT
+
+	// strings must be null-terminated
+	auto chars = reinterpret_cast<wchar_t*>(&buffer[header.chars.offset]);
+	auto& string = reinterpret_cast<IndexFileString*>(&buffer[header.strings.offset])[0];
+	chars[string.offset + string.length] = L'?';
+	TEST_ASSERT(!IndexFile::Load(&buffer[0], buffer.Count()));
+}
+
+TEST_CASE(TestParseDecl_IndexFileQuery)
+{
+	auto input = LR"(
+namespace a
+{
+	struct X;
+	struct X {};
+	enum class Y { Z };
+}
+namespace b
+{
+	a::X x1;
+	a::Y y1;
+	a::Y y2;
+}
+)";
+
+	CppTokenReader reader(GlobalCppLexer(), input);
+	auto cursor = reader.GetFirstToken();
+	ParsingArguments pa(new Symbol, ITsysAlloc::Create(), nullptr);
+	pa.index = MakePtr<IndexTable>();
+	auto program = ParseProgram(pa, cursor);
+	TEST_ASSERT(!cursor);
+
+	vl::stream::MemoryStream stream;
+	WriteIndexFile(stream, pa.root.Obj(), *pa.index.Obj());
+	auto file = IndexFile::Load(stream.GetInternalBuffer(), (vint)stream.Size());
+	TEST_ASSERT(file);
+
+	List<vint> symbols;
+	file->FindSymbols(L"a::Y", symbols);
+	TEST_ASSERT(symbols.Count() == 1);
+	TEST_ASSERT(WString(file->GetString(file->GetSymbol(symbols[0]).name)) == L"Y");
+	TEST_ASSERT(file->GetSymbol(symbols[0]).referenceCount == 2);
+
+	file->FindSymbols(L"a::X", symbols);
+	TEST_ASSERT(symbols.Count() == 2);
+
+	file->FindSymbols(L"a::W", symbols);
+	TEST_ASSERT(symbols.Count() == 0);
+
+	file->FindSymbols(L"a::Y", symbols);
+	vint y = symbols[0];
+
+	vint count = 0;
+	file->FindPositions(0, 10, 3, count);
+	TEST_ASSERT(count == 0);
+	file->FindPositions(0, 10, 5, count);
+	TEST_ASSERT(count == 0);
+	vint first = file->FindPositions(0, 10, 4, count);
+	TEST_ASSERT(count == 1);
+	TEST_ASSERT(file->GetReference(file->GetPosition(first)).symbol == y);
+
+	List<vint> declarations;
+	file->FindDefinitions(0, 11, 4, declarations);
+	TEST_ASSERT(declarations.Count() == 1);
+	TEST_ASSERT(file->GetDeclaration(declarations[0]).symbol == y);
+	TEST_ASSERT(file->GetDeclaration(declarations[0]).row == 5);
+
+	file->FindDefinitions(0, 9, 4, declarations);
+	TEST_ASSERT(declarations.Count() == 1);
+	TEST_ASSERT(file->GetDeclaration(declarations[0]).row == 4);
+	TEST_ASSERT(file->GetDeclaration(declarations[0]).column == 8);
+
+	file->FindDefinitions(0, 9, 1, declarations);
+	TEST_ASSERT(declarations.Count() == 1);
+	TEST_ASSERT(file->GetDeclaration(declarations[0]).row == 1);
+}
+
+TEST_CASE(TestParseDecl_IndexFileMerge)
+{
+	const wchar_t* inputs[] =
+	{
+		LR"(
+namespace a
+{
+	enum class Y { Z };
+	void F(int);
+}
+a::Y y1;
+)",
+		LR"(
+namespace a
+{
+	enum class Y { Z };
+	void F(int);
+	void F(double);
+}
+a::Y y2;
+a::Y y3;
+)",
+	};
+
+	IndexFileBuilder builder;
+	List<Ptr<vl::stream::MemoryStream>> streams;
+	for (vint i = 0; i < 2; i++)
+	{
+		CppTokenReader reader(GlobalCppLexer(), inputs[i]);
+		auto cursor = reader.GetFirstToken();
+		ParsingArguments pa(new Symbol, ITsysAlloc::Create(), nullptr);
+		pa.index = MakePtr<IndexTable>();
+		ParseProgram(pa, cursor);
+		TEST_ASSERT(!cursor);
+
+		TEST_ASSERT(builder.AddTranslationUnit(i == 0 ? L"A.i" : L"B.i", pa.root.Obj(), *pa.index.Obj()) == i);
+		auto stream = MakePtr<vl::stream::MemoryStream>();
+		WriteIndexFile(*stream.Obj(), pa.root.Obj(), *pa.index.Obj(), i == 0 ? L"A.i" : L"B.i");
+		streams.Add(stream);
+	}
+
+	auto assertMerged = [](Ptr<IndexFile> file)
+	{
+		TEST_ASSERT(file);
+		TEST_ASSERT(file->GetFileCount() == 2);
+		TEST_ASSERT(file->FindFile(L"A.i") == 0);
+		TEST_ASSERT(file->FindFile(L"B.i") == 1);
+		TEST_ASSERT(file->FindFile(L"C.i") == -1);
+
+		List<vint> symbols;
+		file->FindSymbols(L"a::Y", symbols);
+		TEST_ASSERT(symbols.Count() == 1);
+		auto& y = file->GetSymbol(symbols[0]);
+		TEST_ASSERT(y.declarationCount == 2);
+		TEST_ASSERT(file->GetDeclaration(y.firstDeclaration).file == 0);
+		TEST_ASSERT(file->GetDeclaration(y.firstDeclaration + 1).file == 1);
+		TEST_ASSERT(y.referenceCount == 3);
+		TEST_ASSERT(file->GetReference(y.firstReference).file == 0);
+		TEST_ASSERT(file->GetReference(y.firstReference + 1).file == 1);
+		TEST_ASSERT(file->GetReference(y.firstReference + 2).file == 1);
+
+		file->FindSymbols(L"a::F", symbols);
+		TEST_ASSERT(symbols.Count() == 2);
+		TEST_ASSERT(file->GetSymbol(symbols[0]).declarationCount == 2);
+		TEST_ASSERT(file->GetSymbol(symbols[1]).declarationCount == 1);
+
+		List<vint> declarations;
+		file->FindDefinitions(1, 8, 3, declarations);
+		TEST_ASSERT(declarations.Count() == 2);
+		file->FindDefinitions(0, 8, 3, declarations);
+		TEST_ASSERT(declarations.Count() == 0);
+	};
+
+	{
+		vl::stream::MemoryStream stream;
+		builder.Write(stream);
+		assertMerged(IndexFile::Load(stream.GetInternalBuffer(), (vint)stream.Size()));
+	}
+	{
+		IndexFileBuilder fileBuilder;
+		for (vint i = 0; i < streams.Count(); i++)
+		{
+			auto file = IndexFile::Load(streams[i]->GetInternalBuffer(), (vint)streams[i]->Size());
+			TEST_ASSERT(file);
+			fileBuilder.AddIndexFile(*file.Obj());
+		}
+
+		vl::stream::MemoryStream stream;
+		fileBuilder.Write(stream);
+		assertMerged(IndexFile::Load(stream.GetInternalBuffer(), (vint)stream.Size()));
+	}
+}
+
+TEST_CASE(TestParseDecl_IndexFileOverloads)
+{
+	const wchar_t* inputs[] =
+	{
+		LR"(
+namespace a
+{
+	struct S;
+	void F(int);
+	void F(double);
+	void F(S*);
+}
+)",
+		LR"(
+namespace a
+{
+	struct S;
+	void F(a::S*);
+	void F(double);
+	void F(double) {}
+}
+)",
+	};
+
+	IndexFileBuilder builder;
+	IndexFileBuilder fileBuilder;
+	for (vint i = 0; i < 2; i++)
+	{
+		CppTokenReader reader(GlobalCppLexer(), inputs[i]);
+		auto cursor = reader.GetFirstToken();
+		ParsingArguments pa(new Symbol, ITsysAlloc::Create(), nullptr);
+		pa.index = MakePtr<IndexTable>();
+		ParseProgram(pa, cursor);
+		TEST_ASSERT(!cursor);
+
+		builder.AddTranslationUnit(i == 0 ? L"A.i" : L"B.i", pa.root.Obj(), *pa.index.Obj());
+		vl::stream::MemoryStream stream;
+		WriteIndexFile(stream, pa.root.Obj(), *pa.index.Obj(), i == 0 ? L"A.i" : L"B.i");
+		auto file = IndexFile::Load(stream.GetInternalBuffer(), (vint)stream.Size());
+		TEST_ASSERT(file);
+		fileBuilder.AddIndexFile(*file.Obj());
+	}
+
+	// overloads are matched by signatures even if translation units declare different overloads in different orders
+	auto assertMerged = [](IndexFileBuilder& builder)
+	{
+		vl::stream::MemoryStream stream;
+		builder.Write(stream);
+		auto file = IndexFile::Load(stream.GetInternalBuffer(), (vint)stream.Size());
+		TEST_ASSERT(file);
+
+		List<vint> symbols;
+		file->FindSymbols(L"a::F", symbols);
+		TEST_ASSERT(symbols.Count() == 4);
+
+		List<WString> actual;
+		for (vint i = 0; i < symbols.Count(); i++)
+		{
+			auto& symbol = file->GetSymbol(symbols[i]);
+			TEST_ASSERT(symbol.signature != -1);
+			auto line = WString(file->GetString(symbol.signature)) + L":";
+			for (vint j = 0; j < symbol.declarationCount; j++)
+			{
+				line += L" " + itow(file->GetDeclaration(symbol.firstDeclaration + j).file);
+			}
+			actual.Add(line);
+		}
+
+		const wchar_t* expected[] =
+		{
+			L"(int): 0",
+			L"(double): 0 1",
+			L"(a::S*): 0 1",
+			L"(double): 1",
+		};
+		TEST_ASSERT(actual.Count() == sizeof(expected) / sizeof(*expected));
+		for (vint i = 0; i < actual.Count(); i++)
+		{
+			TEST_ASSERT(actual.Contains(expected[i]));
+		}
+
+		file->FindSymbols(L"a::S", symbols);
+		TEST_ASSERT(symbols.Count() == 1);
+		TEST_ASSERT(file->GetSymbol(symbols[0]).signature == -1);
+	};
+
+	assertMerged(builder);
+	assertMerged(fileBuilder);
+}
+
+TEST_CASE(TestParseDecl_PrefixSnapshot)
+{
+	WString prefix = LR"(
+namespace a
+{
+	struct X;
+	int f(int);
+}
+)";
+	WString inputs[] =
+	{
+		prefix + LR"(
+namespace a
+{
+	struct X { int y; };
+	int f(double);
+}
+using namespace a;
+X x;
+int g() { return f(1); }
+)",
+		prefix + LR"(
+a::X* p;
+namespace a
+{
+	int f(int) { return 0; }
+}
+)",
+		LR"(
+int a;
+)",
+	};
+	bool forked[] = { true, true, false };
+
+	auto writeIndex = [](const ParsingArguments& pa, Ptr<CppTokenCursor>& cursor)
+	{
+		ParseProgram(pa, cursor);
+		TEST_ASSERT(!cursor);
+		auto stream = MakePtr<vl::stream::MemoryStream>();
+		WriteIndexFile(*stream.Obj(), pa.root.Obj(), *pa.index.Obj(), L"A.i");
+		return stream;
+	};
+
+	// parsing from the snapshot produces the same index as parsing from scratch, every time
+	PrefixSnapshot snapshot(GlobalCppLexer(), prefix);
+	for (vint round = 0; round < 2; round++)
+	{
+		for (vint i = 0; i < sizeof(inputs) / sizeof(*inputs); i++)
+		{
+			Ptr<vl::stream::MemoryStream> expected;
+			{
+				CppTokenReader reader(GlobalCppLexer(), inputs[i]);
+				auto cursor = reader.GetFirstToken();
+				ParsingArguments pa(new Symbol, ITsysAlloc::Create(), nullptr);
+				pa.index = MakePtr<IndexTable>();
+				expected = writeIndex(pa, cursor);
+			}
+
+			CppTokenReader reader(GlobalCppLexer(), inputs[i]);
+			auto cursor = reader.GetFirstToken();
+			ParsingArguments pa;
+			TEST_ASSERT(snapshot.Fork(cursor, pa) == forked[i]);
+			if (forked[i])
+			{
+				auto actual = writeIndex(pa, cursor);
+				snapshot.Restore();
+				TEST_ASSERT(actual->Size() == expected->Size());
+				TEST_ASSERT(memcmp(actual->GetInternalBuffer(), expected->GetInternalBuffer(), (size_t)expected->Size()) == 0);
+			}
+		}
+	}
+
+	// nothing from inputs stays in the snapshot
+	CppTokenReader reader(GlobalCppLexer(), prefix);
+	auto cursor = reader.GetFirstToken();
+	ParsingArguments pa;
+	TEST_ASSERT(snapshot.Fork(cursor, pa));
+	TEST_ASSERT(!cursor);
+	TEST_ASSERT(pa.root->children.Count() == 1);
+	TEST_ASSERT(pa.root->usingNss.Count() == 0);
+
+	auto a = pa.root->children[L"a"][0];
+	TEST_ASSERT(a->decls.Count() == 1);
+	TEST_ASSERT(a->children.Count() == 2);
+	TEST_ASSERT(a->children[L"X"].Count() == 1);
+	TEST_ASSERT(a->children[L"X"][0]->forwardDeclarationRoot == nullptr);
+	TEST_ASSERT(a->children[L"f"].Count() == 1);
+	TEST_ASSERT(a->children[L"f"][0]->forwardDeclarationRoot == nullptr);
+	TEST_ASSERT(pa.index->Count() == 0);
+
+	// forking again before Restore() is an error
+	bool thrown = false;
+	try
+	{
+		snapshot.Fork(cursor, pa);
+	}
+	catch (const Error&)
+	{
+		thrown = true;
+	}
+	TEST_ASSERT(thrown);
+	snapshot.Restore();
+}
+
+TEST_CASE(TestParseDecl_PrefixSnapshotCache)
+{
+	WString prefix = LR"(
+namespace a
+{
+	struct X;
+}
+a::X* p;
+auto v = p->y;
+)";
+	WString inputs[] =
+	{
+		prefix + LR"(
+namespace a
+{
+	struct X { int y; };
+}
+)",
+		prefix + LR"(
+int y;
+)",
+		prefix + LR"(
+namespace a
+{
+	struct X { double y; };
+}
+)",
+	};
+	const wchar_t* expectedTypes[] = { L"__int32", nullptr, L"double" };
+
+	// p->y in the prefix is evaluated again in every input, results of the last input refer to removed symbols
+	PrefixSnapshot snapshot(GlobalCppLexer(), prefix);
+	auto y = snapshot.GetProgram()->decls[2].Cast<VariableDeclaration>()->initializer->arguments[0];
+	for (vint round = 0; round < 2; round++)
+	{
+		for (vint i = 0; i < sizeof(inputs) / sizeof(*inputs); i++)
+		{
+			CppTokenReader reader(GlobalCppLexer(), inputs[i]);
+			auto cursor = reader.GetFirstToken();
+			ParsingArguments pa;
+			TEST_ASSERT(snapshot.Fork(cursor, pa));
+			vint tsysCount = pa.tsys->Count();
+			auto tsys = pa.tsys;
+			ParseProgram(pa, cursor);
+			TEST_ASSERT(!cursor);
+
+			for (vint repeat = 0; repeat < 2; repeat++)
+			{
+				ExprTsysList types;
+				try
+				{
+					ExprToTsys(pa, y, types);
+				}
+				catch (const IllegalExprException&)
+				{
+				}
+
+				if (expectedTypes[i])
+				{
+					TEST_ASSERT(types.Count() == 1);
+					TEST_ASSERT(types[0].symbol && types[0].symbol->name == L"y");
+					TEST_ASSERT(GenerateToStream([&](StreamWriter& writer) { Log(types[0].tsys, writer); }) == expectedTypes[i]);
+				}
+				else
+				{
+					TEST_ASSERT(types.Count() == 0);
+				}
+			}
+
+			// types created during the fork are released
+			if (expectedTypes[i])
+			{
+				TEST_ASSERT(tsys->Count() > tsysCount);
+			}
+			snapshot.Restore();
+			TEST_ASSERT(tsys->Count() == tsysCount);
+		}
+	}
+}
+
+TEST_CASE(TestParseDecl_IndexFileCache)
+{
+	WString input = LR"(
+namespace a
+{
+	struct X;
+}
+a::X* x;
+)";
+
+	auto key = IndexFileCache::GetKey(L"A.i", input.Buffer(), input.Length());
+	TEST_ASSERT(key == IndexFileCache::GetKey(L"A.i", input.Buffer(), input.Length()));
+	TEST_ASSERT(key != IndexFileCache::GetKey(L"B.i", input.Buffer(), input.Length()));
+	TEST_ASSERT(key != IndexFileCache::GetKey(L"A.i", input.Buffer(), input.Length() - 1));
+
+	vl::stream::MemoryStream stream;
+	{
+		CppTokenReader reader(GlobalCppLexer(), input);
+		auto cursor = reader.GetFirstToken();
+		ParsingArguments pa(new Symbol, ITsysAlloc::Create(), nullptr);
+		pa.index = MakePtr<IndexTable>();
+		ParseProgram(pa, cursor);
+		WriteIndexFile(stream, pa.root.Obj(), *pa.index.Obj(), L"A.i");
+	}
+
+	FilePath folder = L"../../../.Output/IndexFileCache";
+	IndexFileCache cache(folder);
+	TEST_ASSERT(folder.IsFolder());
+	File(folder / (key + L".idx")).Delete();
+	TEST_ASSERT(!cache.Open(key, L"A.i"));
+
+	TEST_ASSERT(cache.Save(key, stream.GetInternalBuffer(), (vint)stream.Size()));
+	{
+		auto file = cache.Open(key, L"A.i");
+		TEST_ASSERT(file);
+		TEST_ASSERT(file->GetHeader().fileSize == (vint)stream.Size());
+		TEST_ASSERT(memcmp(&file->GetHeader(), stream.GetInternalBuffer(), (size_t)stream.Size()) == 0);
+	}
+
+	// a cached file is only used by the same path
+	TEST_ASSERT(!cache.Open(key, L"B.i"));
+
+	// a broken file is ignored
+	TEST_ASSERT(cache.Save(key, stream.GetInternalBuffer(), (vint)stream.Size() / 2));
+	TEST_ASSERT(!cache.Open(key, L"A.i"));
+	File(folder / (key + L".idx")).Delete();
+
+	// index files are written to temporary files and renamed
+	List<File> files;
+	TEST_ASSERT(Folder(folder).GetFiles(files));
+	for (vint i = 0; i < files.Count(); i++)
+	{
+		auto name = files[i].GetFilePath().GetName();
+		TEST_ASSERT(name.Length() < 4 || name.Right(4) != L".tmp");
+	}
+}
+
+TEST_CASE(TestParseDecl_SkipDeclaration)
+{
+	// each input is skipped to the declaration "int next;"
+	const wchar_t* inputs[] =
+	{
+		L"int a, b = c(1, 2); int next;",
+		L"int a[] = { 1, 2 }; int next;",
+		L"struct A { int f() { return 0; } } a, b; int next;",
+		L"enum class E : int { X = 1, Y }; int next;",
+		L"template<typename T, class U> void f(T t) { if (t) {} } int next;",
+		L"namespace a { namespace b { int c; } } int next;",
+		L"extern \"C\" { int c; } int next;",
+		L"A::A() : a{ 1 }, b(2), c{ 3 } { f(); } int next;",
+		L"auto f(int a) -> int { return a; } int next;",
+		L"bool operator==(A a, A b) { return true; } int next;",
+		L"void f() = delete; int next;",
+		L"} int next;",
+	};
+
+	for (vint i = 0; i < sizeof(inputs) / sizeof(*inputs); i++)
+	{
+		CppTokenReader reader(GlobalCppLexer(), inputs[i]);
+		auto cursor = reader.GetFirstToken();
+		SkipDeclaration(cursor);
+		TEST_ASSERT(cursor);
+		TEST_ASSERT(WString(cursor->token.reading) == L"int next;");
+	}
+
+	// a closing brace of the enclosing scope is not skipped
+	{
+		CppTokenReader reader(GlobalCppLexer(), L"int a } int next;");
+		auto cursor = reader.GetFirstToken();
+		SkipDeclaration(cursor);
+		TEST_ASSERT(cursor);
+		TEST_ASSERT(WString(cursor->token.reading) == L"} int next;");
+	}
+}
+
+TEST_CASE(TestParseDecl_Budgets)
+{
+	auto input = LR"(
+int f(int);
+namespace a
+{
+	int x = 0;
+	void g(int) { f(1); }
+	int y;
+}
+int z;
+)";
+
+	auto parse = [&](vint rewinds, ParsingArguments& pa)
+	{
+		CppTokenReader reader(GlobalCppLexer(), input);
+		auto cursor = reader.GetFirstToken();
+		pa = ParsingArguments(new Symbol, ITsysAlloc::Create(), nullptr);
+		pa.recovery = MakePtr<ParsingRecovery>();
+		pa.recovery->limits[(vint)ParsingBudget::Rewinds] = rewinds;
+		auto program = ParseProgram(pa, cursor);
+		TEST_ASSERT(!cursor);
+		return program;
+	};
+
+	{
+		ParsingArguments pa;
+		auto program = parse(100, pa);
+		TEST_ASSERT(pa.recovery->diagnostics.Count() == 0);
+		TEST_ASSERT(program->decls.Count() == 3);
+		TEST_ASSERT(pa.root->children.Keys().Contains(L"z"));
+	}
+	{
+		// every declaration that rewinds is skipped, parsing continues from the next one
+		ParsingArguments pa;
+		auto program = parse(0, pa);
+		vint rows[] = { 1, 4, 5, 6, 8 };
+		auto& diagnostics = pa.recovery->diagnostics;
+		TEST_ASSERT(diagnostics.Count() == sizeof(rows) / sizeof(*rows));
+		for (vint i = 0; i < diagnostics.Count(); i++)
+		{
+			TEST_ASSERT(diagnostics[i].budget == ParsingBudget::Rewinds);
+			TEST_ASSERT(diagnostics[i].used == 1);
+			TEST_ASSERT(diagnostics[i].row == rows[i]);
+		}
+		TEST_ASSERT(program->decls.Count() == 1);
+		TEST_ASSERT(pa.root->children.Keys().Contains(L"a"));
+		TEST_ASSERT(!pa.root->children.Keys().Contains(L"z"));
+
+		// budgets do not apply after ParseProgram
+		ConsumeBudget(pa, ParsingBudget::Rewinds);
+	}
+}
+
+TEST_CASE(TestParseDecl_SkipSyntaxErrors)
+{
+	auto input = LR"(
+int a;
+class C { int x };
+int b = 1 +;
+namespace n
+{
+	void f() { return return; }
+	int c;
+}
+int d;
+namespace m
+{
+	int e;
+)";
+
+	auto parse = [&](bool skipSyntaxErrors, ParsingArguments& pa)
+	{
+		CppTokenReader reader(GlobalCppLexer(), input);
+		auto cursor = reader.GetFirstToken();
+		pa = ParsingArguments(new Symbol, ITsysAlloc::Create(), nullptr);
+		pa.recovery = MakePtr<ParsingRecovery>();
+		pa.recovery->skipSyntaxErrors = skipSyntaxErrors;
+		auto program = ParseProgram(pa, cursor);
+		TEST_ASSERT(!cursor);
+		return program;
+	};
+
+	{
+		// the first syntax error fails the whole program without skipSyntaxErrors
+		ParsingArguments pa;
+		bool failed = false;
+		try
+		{
+			parse(false, pa);
+		}
+		catch (const StopParsingException&)
+		{
+			failed = true;
+		}
+		TEST_ASSERT(failed);
+	}
+	{
+		// every declaration with a syntax error is skipped, parsing continues from the next one
+		ParsingArguments pa;
+		auto program = parse(true, pa);
+		vint rows[] = { 2, 3, 6, 10 };
+		vint errorRows[] = { 2, 3, 6, -1 };
+		auto& diagnostics = pa.recovery->diagnostics;
+		TEST_ASSERT(diagnostics.Count() == sizeof(rows) / sizeof(*rows));
+		for (vint i = 0; i < diagnostics.Count(); i++)
+		{
+			TEST_ASSERT(diagnostics[i].kind == ParsingDiagnosticKind::SyntaxError);
+			TEST_ASSERT(diagnostics[i].row == rows[i]);
+			TEST_ASSERT(diagnostics[i].errorRow == errorRows[i]);
+		}
+		TEST_ASSERT(pa.root->children.Keys().Contains(L"a"));
+		TEST_ASSERT(pa.root->children.Keys().Contains(L"d"));
+		TEST_ASSERT(pa.root->children[L"n"][0]->children.Keys().Contains(L"c"));
+	}
+}
+
+TEST_CASE(TestParseDecl_ParallelParser)
+{
+	auto input = LR"(
+namespace a
+{
+	struct X;
+	int f(int);
+	namespace b
+	{
+		struct Y {};
+	}
+}
+int g(double);
+namespace a
+{
+	struct X { int x; };
+	int i = f(0);
+}
+namespace c::d
+{
+	struct Z;
+	struct Z;
+	enum E { e };
+}
+using namespace a;
+X* x;
+namespace a::b
+{
+	int z;
+	Y y;
+}
+int g(int);
+int h = g(1);
+)";
+
+	auto parse = [&](vint partitionCount, ParsingArguments& pa, WString& log, vint& mergedPartitions)
+	{
+		CppTokenReader reader(GlobalCppLexer(), input);
+		auto cursor = reader.GetFirstToken();
+		pa = ParsingArguments(new Symbol, ITsysAlloc::Create(), nullptr);
+		pa.index = MakePtr<IndexTable>();
+
+		auto parser = MakePtr<ParallelParser>(partitionCount, 4);
+		auto program = parser->Parse(pa, cursor);
+		TEST_ASSERT(!cursor);
+		mergedPartitions = parser->mergedPartitions;
+		log = GenerateToStream([&](StreamWriter& writer)
+		{
+			Log(program, writer);
+		});
+		return parser;
+	};
+
+	ParsingArguments pa1, pa2;
+	WString log1, log2;
+	vint merged1, merged2;
+	auto parser1 = parse(1, pa1, log1, merged1);
+	auto parser2 = parse(100, pa2, log2, merged2);
+	TEST_ASSERT(parser1->parsedPartitions == 0);
+	TEST_ASSERT(parser2->parsedPartitions > 1);
+
+	// partitions referring to names declared by previous partitions are parsed again
+	TEST_ASSERT(merged2 > 1);
+	TEST_ASSERT(merged2 < parser2->parsedPartitions);
+	TEST_ASSERT(log1 == log2);
+	TEST_ASSERT(pa1.index->Count() == pa2.index->Count());
+
+	auto writeIndex = [](ParsingArguments& pa)
+	{
+		auto stream = MakePtr<vl::stream::MemoryStream>();
+		WriteIndexFile(*stream.Obj(), pa.root.Obj(), *pa.index.Obj(), L"A.i");
+		return stream;
+	};
+	auto index1 = writeIndex(pa1);
+	auto index2 = writeIndex(pa2);
+	TEST_ASSERT(index1->Size() == index2->Size());
+	TEST_ASSERT(memcmp(index1->GetInternalBuffer(), index2->GetInternalBuffer(), (size_t)index1->Size()) == 0);
+
+	// namespaces are merged and forward declarations are connected across partitions
+	auto a = pa2.root->children[L"a"][0];
+	TEST_ASSERT(pa2.root->children[L"a"].Count() == 1);
+	TEST_ASSERT(a->decls.Count() == 3);
+	TEST_ASSERT(a->children[L"X"].Count() == 2);
+	TEST_ASSERT(a->children[L"X"][0]->forwardDeclarationRoot == a->children[L"X"][1].Obj());
+	TEST_ASSERT(a->children[L"b"][0]->children.Keys().Contains(L"z"));
+	TEST_ASSERT(pa2.root->children[L"c"][0]->children[L"d"][0]->children[L"Z"].Count() == 2);
+}
+
+TEST_CASE(TestParseDecl_Documents)
+{
+	auto input = LR"(
+/// namespace a
+namespace a
+{
+	/// class X
+	/// second line
+	class X
+	{
+		/// field x
+		int x;
+		int y;
+	};
+
+	/// variables
+	int b, c;
+
+	/// not attached
+	// separated by a comment
+	int d;
+}
+/// end of the input
+)";
+
+	CppTokenReader reader(GlobalCppLexer(), input);
+	auto cursor = reader.GetFirstToken();
+	ParsingArguments pa(new Symbol, ITsysAlloc::Create(), nullptr);
+	auto program = ParseProgram(pa, cursor);
+	TEST_ASSERT(!cursor);
+
+	auto& documents = reader.GetDocuments();
+	TEST_ASSERT(documents.Count() == 7);
+	auto getDocument = [&](Ptr<Declaration> decl)
+	{
+		WString text;
+		for (vint i = 0; i < decl->document.count; i++)
+		{
+			auto& token = documents[decl->document.start + i];
+			text += (i == 0 ? L"" : L"|") + WString(token.reading, token.length);
+		}
+		return text;
+	};
+
+	auto a = program->decls[0].Cast<NamespaceDeclaration>();
+	TEST_ASSERT(getDocument(a) == L"/// namespace a");
+	auto x = a->decls[0].Cast<ClassDeclaration>();
+	TEST_ASSERT(getDocument(x) == L"/// class X|/// second line");
+	TEST_ASSERT(getDocument(x->decls[0].f1) == L"/// field x");
+	TEST_ASSERT(x->decls[1].f1->document.start == -1);
+	TEST_ASSERT(getDocument(a->decls[1]) == L"/// variables");
+	TEST_ASSERT(getDocument(a->decls[2]) == L"/// variables");
+	TEST_ASSERT(a->decls[3]->document.start == -1);
 }
\ No newline at end of file
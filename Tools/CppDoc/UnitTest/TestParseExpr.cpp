@@ -661,6 +661,15 @@ volatile A* pva;
 	AssertExpr(L"pva->*&A::f",				L"(pva ->* (& A :: f))",	L"double __cdecl(...) (::A ::) * volatile & $L",	pa);
 }
 
+TEST_CASE(TestParseExpr_Binary_Precedence)
+{
+	AssertExpr(L"1+2*3",						L"(1 + (2 * 3))",						L"__int32 $PR"	);
+	AssertExpr(L"1*2+3",						L"((1 * 2) + 3)",						L"__int32 $PR"	);
+	AssertExpr(L"1-2-3",						L"((1 - 2) - 3)",						L"__int32 $PR"	);
+	AssertExpr(L"1+2*3-4",						L"((1 + (2 * 3)) - 4)",					L"__int32 $PR"	);
+	AssertExpr(L"1<2==3<4",						L"((1 < 2) == (3 < 4))",				L"bool $PR"	);
+}
+
 TEST_CASE(TestParseExpr_Ternary_Comma)
 {
 }
@@ -704,4 +713,166 @@ TEST_CASE(TestParseExpr_Lambda)
 	// TsysType::CapturedLambda
 	// GetElement() returns a function type
 	// GetDecl() returns the scope inside the lambda
+}
+
+TEST_CASE(TestParseExpr_TsysCache)
+{
+	auto input = LR"(
+struct S { int x; double y; };
+int f(int);
+double f(double);
+S s;
+)";
+	COMPILE_PROGRAM(program, pa, input);
+
+	CppTokenReader exprReader(GlobalCppLexer(), L"f(s.x) + f(s.y)");
+	auto exprCursor = exprReader.GetFirstToken();
+	auto expr = ParseExpr(pa, true, exprCursor);
+	TEST_ASSERT(!exprCursor);
+
+	ExprTsysList tsys1, tsys2, tsys3;
+	ExprToTsys(pa, expr, tsys1);
+	TEST_ASSERT(expr->tsysCache);
+	TEST_ASSERT(expr->tsysCache->context == pa.context);
+	auto cache = expr->tsysCache;
+
+	ExprToTsys(pa, expr, tsys2);
+	TEST_ASSERT(expr->tsysCache == cache);
+	TEST_ASSERT(CompareEnumerable(tsys1, tsys2) == 0);
+
+	{
+		ScopedSwitch cacheSwitch(ExprToTsysCacheEnabled, false);
+		ExprToTsys(pa, expr, tsys3);
+	}
+	TEST_ASSERT(expr->tsysCache == cache);
+	TEST_ASSERT(CompareEnumerable(tsys1, tsys3) == 0);
+
+	ParsingArguments newPa(pa, pa.root->children[L"S"][0].Obj());
+	ExprTsysList tsys4;
+	ExprToTsys(newPa, expr, tsys4);
+	TEST_ASSERT(expr->tsysCache != cache);
+	TEST_ASSERT(expr->tsysCache->context == newPa.context);
+	TEST_ASSERT(CompareEnumerable(tsys1, tsys4) == 0);
+}
+
+TEST_CASE(TestParseExpr_TsysCacheForwardDeclaration)
+{
+	COMPILE_PROGRAM(program, pa, L"struct A; A* p;");
+
+	CppTokenReader exprReader(GlobalCppLexer(), L"p");
+	auto exprCursor = exprReader.GetFirstToken();
+	auto expr = ParseExpr(pa, true, exprCursor);
+	TEST_ASSERT(!exprCursor);
+
+	ExprTsysList tsys1, tsys2;
+	ExprToTsys(pa, expr, tsys1);
+	TEST_ASSERT(tsys1.Count() == 1);
+	TEST_ASSERT(tsys1[0].tsys == pa.tsys->DeclOf(pa.root->children[L"A"][0].Obj())->PtrOf());
+
+	// the cached result is not used after any symbol is added, here the forward declaration is defined
+	CppTokenReader definitionReader(GlobalCppLexer(), L"struct A { int x; };");
+	auto definitionCursor = definitionReader.GetFirstToken();
+	ParseProgram(pa, definitionCursor);
+	TEST_ASSERT(!definitionCursor);
+	auto definition = pa.root->children[L"A"][1].Obj();
+	TEST_ASSERT(pa.root->children[L"A"][0]->forwardDeclarationRoot == definition);
+
+	ExprToTsys(pa, expr, tsys2);
+	TEST_ASSERT(tsys2.Count() == 1);
+	TEST_ASSERT(tsys2[0].tsys == pa.tsys->DeclOf(definition)->PtrOf());
+	TEST_ASSERT(expr->tsysCache->symbolVersion == pa.root->descendantVersion);
+}
+
+TEST_CASE(TestParseExpr_OperatorCache)
+{
+	auto input = LR"(
+struct S {};
+S operator+(S, int);
+S s;
+)";
+	COMPILE_PROGRAM(program, pa, input);
+	TEST_ASSERT(pa.operatorCache);
+
+	// tokens of an expression point to the input kept in its reader
+	List<Ptr<CppTokenReader>> exprReaders;
+	auto parse = [&](const wchar_t* code)
+	{
+		auto exprReader = MakePtr<CppTokenReader>(GlobalCppLexer(), code);
+		exprReaders.Add(exprReader);
+		auto exprCursor = exprReader->GetFirstToken();
+		auto expr = ParseExpr(pa, true, exprCursor);
+		TEST_ASSERT(!exprCursor);
+		return expr;
+	};
+
+	ExprTsysList tsys1, tsys2, tsys3;
+	ExprToTsys(pa, parse(L"s + 1"), tsys1);
+	TEST_ASSERT(tsys1.Count() == 1);
+	TEST_ASSERT(pa.operatorCache->results.Count() == 1);
+
+	ExprToTsys(pa, parse(L"s + 2"), tsys2);
+	TEST_ASSERT(pa.operatorCache->results.Count() == 1);
+	TEST_ASSERT(CompareEnumerable(tsys1, tsys2) == 0);
+
+	auto symbol = MakePtr<Symbol>();
+	symbol->name = L"T";
+	pa.root->Add(symbol);
+	TEST_ASSERT(pa.operatorCache->symbolVersion == pa.root->operatorVersion);
+
+	ExprToTsys(pa, parse(L"s + 3"), tsys3);
+	TEST_ASSERT(pa.operatorCache->results.Count() == 1);
+	TEST_ASSERT(CompareEnumerable(tsys1, tsys3) == 0);
+
+	auto op = MakePtr<Symbol>();
+	op->name = L"operator -";
+	symbol->Add(op);
+	TEST_ASSERT(pa.operatorCache->symbolVersion != pa.root->operatorVersion);
+
+	ExprTsysList tsys4;
+	ExprToTsys(pa, parse(L"s + 4"), tsys4);
+	TEST_ASSERT(pa.operatorCache->symbolVersion == pa.root->operatorVersion);
+	TEST_ASSERT(pa.operatorCache->results.Count() == 1);
+	TEST_ASSERT(CompareEnumerable(tsys1, tsys4) == 0);
+}
+
+TEST_CASE(TestParseExpr_OverloadArityTable)
+{
+	auto input = LR"(
+int f();
+int f(int, int = 0);
+double f(double, double, double);
+char f(const char*, ...);
+bool f(bool, bool, bool, bool = false, bool = false);
+)";
+	COMPILE_PROGRAM(program, pa, input);
+
+	AssertExpr(L"f()",						L"f()",							L"__int32 $PR",		pa);
+	AssertExpr(L"f(1)",						L"f(1)",						L"__int32 $PR",		pa);
+	AssertExpr(L"f(1.0, 2.0, 3.0)",			L"f(1.0, 2.0, 3.0)",			L"double $PR",		pa);
+	AssertExpr(L"f(true, true, true, true)",	L"f(true, true, true, true)",	L"bool $PR",		pa);
+	AssertExpr(L"f(\"a\", 1, 2, 3, 4, 5)",	L"f(\"a\", 1, 2, 3, 4, 5)",	L"char $PR",		pa);
+
+	// functions of f in the root scope are bucketed by the number of parameters
+	TEST_ASSERT(pa.root->overloadArityTable);
+	auto& overloadSets = pa.root->overloadArityTable->overloadSets;
+	TEST_ASSERT(overloadSets.Count() == 1);
+	auto overloadSet = overloadSets[L"f"];
+	TEST_ASSERT(overloadSet->fixedArity.Count() == 4);
+	TEST_ASSERT(overloadSet->fixedArity.Keys()[0] == 0);
+	TEST_ASSERT(overloadSet->fixedArity.Keys()[1] == 2);
+	TEST_ASSERT(overloadSet->fixedArity.Keys()[2] == 3);
+	TEST_ASSERT(overloadSet->fixedArity.Keys()[3] == 5);
+	TEST_ASSERT(overloadSet->maxDefaultParameterCount == 2);
+	TEST_ASSERT(overloadSet->ellipsis.Count() == 1);
+	TEST_ASSERT(overloadSet->others.Count() == 0);
+
+	// adding a symbol of the name removes its overload set
+	auto symbol = MakePtr<Symbol>();
+	symbol->name = L"f";
+	pa.root->Add(symbol);
+	TEST_ASSERT(overloadSets.Count() == 0);
+
+	AssertExpr(L"f(1)",						L"f(1)",						L"__int32 $PR",		pa);
+	TEST_ASSERT(overloadSets.Count() == 1);
+	TEST_ASSERT(overloadSets[L"f"]->others.Count() == 1);
 }
\ No newline at end of file
@@ -1,3 +1,7 @@
+#include <Ast_Decl.h>
+#include <Ast_Expr.h>
+#include <Ast_Stat.h>
+#include <Ast_Range.h>
 #include "Util.h"
 
 TEST_CASE(TestParseStat_Everything)
@@ -100,4 +104,77 @@ __except (0)
 	__finally
 		;
 )");
+}
+
+TEST_CASE(TestParseStat_AstRangeIndex)
+{
+	WString input = L"int x = 0;\nint F(int a)\n{\n\treturn a + x * (a - 1);\n}";
+	COMPILE_PROGRAM(program, pa, input);
+
+	AstRangeIndex index;
+	index.Build(program);
+
+	auto offsetOf = [&](const wchar_t* text)
+	{
+		return (vint)(wcsstr(input.Buffer(), text) - input.Buffer());
+	};
+
+	auto assertRange = [&](vint item, AstRangeKind kind, const wchar_t* text, bool toEnd)
+	{
+		TEST_ASSERT(item != -1);
+		TEST_ASSERT(index.items[item].kind == kind);
+		TEST_ASSERT(index.items[item].start == offsetOf(text));
+		TEST_ASSERT(index.items[item].end == (toEnd ? -1 : offsetOf(text) + (vint)wcslen(text)));
+	};
+
+	for (vint i = 1; i < index.items.Count(); i++)
+	{
+		TEST_ASSERT(index.items[i - 1].start <= index.items[i].start);
+	}
+
+	{
+		vint item = index.FindInnermost(offsetOf(L"0;"));
+		assertRange(item, AstRangeKind::Expr, L"0", false);
+		TEST_ASSERT(dynamic_cast<LiteralExpr*>(index.items[item].node));
+		item = index.items[item].parent;
+		assertRange(item, AstRangeKind::Declaration, L"int x = 0;", false);
+		TEST_ASSERT(dynamic_cast<VariableDeclaration*>(index.items[item].node));
+		TEST_ASSERT(index.items[item].parent == -1);
+	}
+
+	TEST_ASSERT(index.FindInnermost(offsetOf(L"\nint F")) == -1);
+
+	{
+		vint item = index.FindInnermost(offsetOf(L"1)"));
+		assertRange(item, AstRangeKind::Expr, L"1", false);
+		item = index.items[item].parent;
+		assertRange(item, AstRangeKind::Expr, L"a - 1", false);
+		item = index.items[item].parent;
+		assertRange(item, AstRangeKind::Expr, L"(a - 1)", false);
+		TEST_ASSERT(dynamic_cast<ParenthesisExpr*>(index.items[item].node));
+		item = index.items[item].parent;
+		assertRange(item, AstRangeKind::Expr, L"x * (a - 1)", false);
+		item = index.items[item].parent;
+		assertRange(item, AstRangeKind::Expr, L"a + x * (a - 1)", false);
+		item = index.items[item].parent;
+		assertRange(item, AstRangeKind::Stat, L"return a + x * (a - 1);", false);
+		item = index.items[item].parent;
+		// the last token has been consumed, so ranges ending at the last token reach the end of the input
+		assertRange(item, AstRangeKind::Stat, L"{", true);
+		item = index.items[item].parent;
+		assertRange(item, AstRangeKind::Declaration, L"int F", true);
+		TEST_ASSERT(dynamic_cast<FunctionDeclaration*>(index.items[item].node));
+		TEST_ASSERT(index.items[item].parent == -1);
+	}
+
+	{
+		vint item = index.FindInnermost(offsetOf(L"* ("));
+		assertRange(item, AstRangeKind::Expr, L"x * (a - 1)", false);
+		item = index.FindInnermost(offsetOf(L"eturn"));
+		assertRange(item, AstRangeKind::Stat, L"return a + x * (a - 1);", false);
+		item = index.FindInnermost(offsetOf(L"x * ("));
+		TEST_ASSERT(index.items[item].start == offsetOf(L"x * ("));
+		TEST_ASSERT(index.items[item].end == offsetOf(L" * ("));
+		TEST_ASSERT(dynamic_cast<IdExpr*>(index.items[item].node));
+	}
 }
\ No newline at end of file
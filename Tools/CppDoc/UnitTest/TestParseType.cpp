@@ -206,4 +206,181 @@ namespace c::d
 			pa);
 		TEST_ASSERT(accessed.Count() == 5);
 	}
+}
+
+TEST_CASE(TestParseType_TsysCache)
+{
+	auto testCache = [](const WString& input, bool cached)
+	{
+		ParsingArguments pa(new Symbol, ITsysAlloc::Create(), nullptr);
+		CppTokenReader reader(GlobalCppLexer(), input);
+		auto cursor = reader.GetFirstToken();
+		auto type = ParseType(pa, cursor);
+		TEST_ASSERT(!cursor);
+
+		TypeTsysList tsys1, tsys2, tsys3;
+		TypeToTsys(pa, type, tsys1);
+		TEST_ASSERT((type->tsysCache ? type->tsysCache->results.Count() : 0) == (cached ? 1 : 0));
+		TypeToTsys(pa, type, tsys2);
+		TEST_ASSERT(CompareEnumerable(tsys1, tsys2) == 0);
+
+		{
+			ScopedSwitch cacheSwitch(TypeToTsysCacheEnabled, false);
+			TypeToTsys(pa, type, tsys3);
+		}
+		TEST_ASSERT(CompareEnumerable(tsys1, tsys3) == 0);
+	};
+
+	testCache(L"int(__stdcall*)(int const&, char(*)[10])", true);
+	testCache(L"int(__stdcall*)(int const&, decltype(0)*)", false);
+
+	// a type referring to a forward declaration is not cached until the declaration is defined
+	COMPILE_PROGRAM(program, pa, L"struct A; A* p;");
+	auto type = program->decls[1].Cast<VariableDeclaration>()->type;
+
+	TypeTsysList tsys1, tsys2, tsys3;
+	TypeToTsys(pa, type, tsys1);
+	TEST_ASSERT(!type->tsysCache);
+	TEST_ASSERT(tsys1.Count() == 1);
+	TEST_ASSERT(tsys1[0] == pa.tsys->DeclOf(pa.root->children[L"A"][0].Obj())->PtrOf());
+
+	CppTokenReader definitionReader(GlobalCppLexer(), L"struct A { int x; };");
+	auto definitionCursor = definitionReader.GetFirstToken();
+	ParseProgram(pa, definitionCursor);
+	TEST_ASSERT(!definitionCursor);
+	TEST_ASSERT(pa.root->children[L"A"].Count() == 2);
+	auto definition = pa.root->children[L"A"][1].Obj();
+	TEST_ASSERT(pa.root->children[L"A"][0]->forwardDeclarationRoot == definition);
+
+	TypeToTsys(pa, type, tsys2);
+	TEST_ASSERT(type->tsysCache);
+	TEST_ASSERT(tsys2.Count() == 1);
+	TEST_ASSERT(tsys2[0] == pa.tsys->DeclOf(definition)->PtrOf());
+
+	TypeToTsys(pa, type, tsys3);
+	TEST_ASSERT(CompareEnumerable(tsys2, tsys3) == 0);
+}
+
+TEST_CASE(TestParseType_FunctionTypeExpansionLimit)
+{
+	auto input = LR"(
+int f(int);
+int f(double);
+int f(char);
+)";
+	COMPILE_PROGRAM(program, pa, input);
+
+	auto testExpansion = [&](vint limit, vint expectedCount, vint expectedDropped)
+	{
+		CppTokenReader reader(GlobalCppLexer(), L"void(decltype(f)*, decltype(f)*, decltype(f)*, decltype(f)*, decltype(f)*)");
+		auto cursor = reader.GetFirstToken();
+		auto type = ParseType(pa, cursor);
+		TEST_ASSERT(!cursor);
+
+		// function types are only truncated with a limit in ParsingRecovery
+		ParsingArguments limitedPa = pa;
+		if (limit != -1)
+		{
+			limitedPa.recovery = MakePtr<ParsingRecovery>();
+			limitedPa.recovery->functionTypeExpansionLimit = limit;
+		}
+		auto oldStatistics = GetFunctionTypeExpansionStatistics();
+
+		TypeTsysList tsys;
+		TypeToTsys(limitedPa, type, tsys);
+		TEST_ASSERT(tsys.Count() == expectedCount);
+		auto statistics = GetFunctionTypeExpansionStatistics();
+		TEST_ASSERT(statistics.ambiguousFunctions == oldStatistics.ambiguousFunctions + 1);
+		TEST_ASSERT(statistics.createdCombinations == oldStatistics.createdCombinations + expectedCount);
+		TEST_ASSERT(statistics.droppedCombinations == oldStatistics.droppedCombinations + expectedDropped);
+
+		if (limitedPa.recovery)
+		{
+			limitedPa.recovery->Complete(cursor);
+			TEST_ASSERT(limitedPa.recovery->diagnostics.Count() == (expectedDropped == 0 ? 0 : 1));
+			if (expectedDropped != 0)
+			{
+				TEST_ASSERT(limitedPa.recovery->diagnostics[0].kind == ParsingDiagnosticKind::FunctionTypesTruncated);
+				TEST_ASSERT(limitedPa.recovery->diagnostics[0].used == expectedDropped);
+			}
+		}
+	};
+
+	testExpansion(-1, 243, 0);
+	testExpansion(10, 10, 233);
+	testExpansion(243, 243, 0);
+}
+
+TEST_CASE(TestParseType_FunctionTypeExpansionCache)
+{
+	auto input = LR"(
+namespace a { struct X{}; }
+namespace b { struct X{}; }
+using namespace a;
+using namespace b;
+)";
+	COMPILE_PROGRAM(program, pa, input);
+
+	auto testCache = [&](vint limit, vint expectedCount)
+	{
+		CppTokenReader reader(GlobalCppLexer(), L"void(X, X, X)");
+		auto cursor = reader.GetFirstToken();
+		auto type = ParseType(pa, cursor);
+		TEST_ASSERT(!cursor);
+
+		ParsingArguments limitedPa = pa;
+		limitedPa.recovery = MakePtr<ParsingRecovery>();
+		limitedPa.recovery->functionTypeExpansionLimit = limit;
+
+		TypeTsysList tsys;
+		TypeToTsys(limitedPa, type, tsys);
+		TEST_ASSERT(tsys.Count() == expectedCount);
+
+		// a truncated result is not cached, because it depends on the limit
+		TEST_ASSERT(expectedCount == 8 ? (bool)type->tsysCache : !type->tsysCache);
+
+		TypeTsysList tsys2;
+		TypeToTsys(pa, type, tsys2);
+		TEST_ASSERT(tsys2.Count() == 8);
+	};
+
+	testCache(-1, 8);
+	testCache(5, 5);
+}
+
+TEST_CASE(TestParseType_FunctionTypeDeferredCall)
+{
+	auto input = LR"(
+namespace a { struct X{}; }
+namespace b { struct X{}; }
+using namespace a;
+using namespace b;
+char g(X, X);
+bool g(int, int);
+X h(int);
+)";
+	COMPILE_PROGRAM(program, pa, input);
+
+	// calling an ambiguous function does not create function types of all combinations
+	auto testCall = [&](const WString& input, const WString& log, const WString& logTsys)
+	{
+		auto oldStatistics = GetFunctionTypeExpansionStatistics();
+		AssertExpr(input, log, logTsys, pa);
+		auto statistics = GetFunctionTypeExpansionStatistics();
+		TEST_ASSERT(statistics.deferredFunctions == oldStatistics.deferredFunctions + 1);
+		TEST_ASSERT(statistics.createdCombinations == oldStatistics.createdCombinations);
+	};
+
+	testCall(L"g(a::X(), b::X())",		L"g(a :: X(), b :: X())",		L"char $PR");
+	testCall(L"g(1, 1)",				L"g(1, 1)",						L"bool $PR");
+	testCall(L"g(a::X(), 1)",			L"g(a :: X(), 1)",				L"");
+
+	CppTokenReader exprReader(GlobalCppLexer(), L"h(0)");
+	auto exprCursor = exprReader.GetFirstToken();
+	auto expr = ParseExpr(pa, true, exprCursor);
+	TEST_ASSERT(!exprCursor);
+
+	ExprTsysList tsys;
+	ExprToTsys(pa, expr, tsys);
+	TEST_ASSERT(tsys.Count() == 2);
 }
\ No newline at end of file
@@ -0,0 +1,56 @@
+#include <Scheduler.h>
+
+TEST_CASE(TestScheduler_RunAllTasks)
+{
+	for (vint workerCount = 1; workerCount <= 4; workerCount++)
+	{
+		WorkStealingScheduler scheduler(workerCount);
+		TEST_ASSERT(scheduler.GetWorkerCount() == workerCount);
+
+		// all tasks are queued to the first worker, so other workers could only get tasks by stealing
+		Array<vint> results(100);
+		volatile vint finished = 0;
+		for (vint i = 0; i < results.Count(); i++)
+		{
+			results[i] = -1;
+			scheduler.Queue(0, [&, i](vint worker)
+			{
+				TEST_ASSERT(0 <= worker && worker < workerCount);
+				results[i] = i;
+				INCRC(&finished);
+			});
+		}
+		scheduler.Run();
+
+		TEST_ASSERT(finished == results.Count());
+		for (vint i = 0; i < results.Count(); i++)
+		{
+			TEST_ASSERT(results[i] == i);
+		}
+		TEST_ASSERT(scheduler.GetFailedTaskCount() == 0);
+	}
+}
+
+TEST_CASE(TestScheduler_QueueWhileRunning)
+{
+	WorkStealingScheduler scheduler(4);
+	volatile vint finished = 0;
+
+	// every task queues two smaller tasks to the worker that runs it, until the size reaches 0
+	Func<void(vint, vint)> split;
+	split = [&](vint worker, vint size)
+	{
+		INCRC(&finished);
+		if (size > 0)
+		{
+			scheduler.Queue(worker, [&, size](vint worker) { split(worker, size - 1); });
+			scheduler.Queue(worker, [&, size](vint worker) { split(worker, size - 1); });
+		}
+	};
+	scheduler.Queue(0, [&](vint worker) { split(worker, 9); });
+	scheduler.Queue(1, [](vint) { throw 0; });
+	scheduler.Run();
+
+	TEST_ASSERT(finished == 1023);
+	TEST_ASSERT(scheduler.GetFailedTaskCount() == 1);
+}
\ No newline at end of file
@@ -21,6 +21,27 @@ extern void					AssertStat(const WString& input, const WString& log, ParsingArgu
 extern void					AssertProgram(const WString& input, const WString& log, Ptr<IIndexRecorder> recorder = nullptr);
 extern void					AssertProgram(Ptr<Program> program, const WString& log);
 
+// Set a global switch in a scope, the old value is restored even if an assertion fails
+class ScopedSwitch
+{
+protected:
+	bool&					target;
+	bool					oldValue;
+
+public:
+	ScopedSwitch(bool& _target, bool value)
+		:target(_target)
+		, oldValue(_target)
+	{
+		target = value;
+	}
+
+	~ScopedSwitch()
+	{
+		target = oldValue;
+	}
+};
+
 #define TEST_DECL_(SOMETHING, INPUT) SOMETHING auto INPUT = L#SOMETHING
 #define TEST_DECL(SOMETHING) TEST_DECL_(SOMETHING, input)
 